@@ -2,6 +2,7 @@ find_package(concurrentqueue QUIET)
 
 if(concurrentqueue_FOUND)
     message(STATUS "Found concurrentqueue: ${concurrentqueue_CONFIG} (found version \"${concurrentqueue_VERSION}\")")
+    set(LinkLibraries "${LinkLibraries};concurrentqueue::concurrentqueue")
 else()
     ExternalProject_Add(
         concurrentqueue_external
@@ -15,6 +16,7 @@ else()
 
     add_library(concurrentqueue INTERFACE IMPORTED)
     add_dependencies(concurrentqueue concurrentqueue_external)
+    set(LinkLibraries "${LinkLibraries};concurrentqueue")
 endif()
 
 include_directories(${EXTERNAL_INSTALL_LOCATION}/include/concurrentqueue)
\ No newline at end of file
@@ -0,0 +1,91 @@
+/**
+ * @file algo_metrics.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 算法各阶段耗时统计
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 by GDDI
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gddi {
+
+struct LatencyMetric {
+    std::string algo; // 算法名称
+    std::string stage;// 阶段名称 (preprocess/infer_stage1/track/crop/infer_stage2/...)
+    int32_t stream{0};// 视频流ID
+
+    uint64_t count{0}; // 样本数
+    uint64_t sum_us{0};// 累计耗时(us)
+    uint64_t min_us{0};
+    uint64_t max_us{0};
+    uint64_t p50_us{0};
+    uint64_t p90_us{0};
+    uint64_t p99_us{0};
+
+    std::vector<std::pair<uint64_t, uint64_t>> buckets;// 非空桶 (桶上界us, 样本数)
+};
+
+struct SkipMetric {
+    std::string algo;   // 算法名称
+    std::string gate;   // 跳帧原因 (motion/...)
+    int32_t stream{0};  // 视频流ID
+    uint64_t frames{0}; // 经过门控的帧数
+    uint64_t skipped{0};// 跳过推理的帧数
+};
+
+struct BatchMetric {
+    std::string algo; // 算法名称
+    uint32_t model{0};// 模型序号
+
+    uint64_t batches{0};                                   // 提交的批数
+    uint64_t inputs{0};                                    // 提交的输入数, 平均每批输入数为 inputs / batches
+    uint32_t max_batch_size{0};                            // 最大的一批输入数
+    std::vector<std::pair<uint32_t, uint64_t>> batch_sizes;// 每批输入数分布 (输入数, 批数), 只含非零项, 超过 64 计入 64
+
+    LatencyMetric queue_delay;// 请求提交到所在批提交的等待时间
+};
+
+/**
+ * @brief 获取所有算法各阶段耗时快照
+ *
+ * @return std::vector<LatencyMetric>
+ */
+std::vector<LatencyMetric> get_metrics();
+
+/**
+ * @brief 获取各视频流跳帧计数快照, 跳帧率为 skipped / frames
+ *
+ * @return std::vector<SkipMetric>
+ */
+std::vector<SkipMetric> get_skip_metrics();
+
+/**
+ * @brief 获取跨视频流合批统计快照, 只包含开启合批的模型
+ *
+ * @return std::vector<BatchMetric>
+ */
+std::vector<BatchMetric> get_batch_metrics();
+
+/**
+ * @brief 导出 Prometheus 文本格式 (耗时/合批排队 summary, 每批输入数 histogram, 跳帧 counter)
+ *
+ * @return std::string
+ */
+std::string export_prometheus_metrics();
+
+/**
+ * @brief 清空所有耗时统计、跳帧计数和合批统计
+ *
+ */
+void reset_metrics();
+
+}// namespace gddi
@@ -0,0 +1,51 @@
+/**
+ * @file algo_trace.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 帧级时间线追踪 (Chrome trace / Perfetto)
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 by GDDI
+ *
+ * 需要以 -DGDDI_ENABLE_TRACE=ON 编译, 否则以下接口为空实现且热路径无任何追踪代码
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace gddi {
+
+/**
+ * @brief 开始记录, 清空之前的记录
+ *
+ * @param capacity 每个线程环形缓冲区大小 (span 数), 写满后覆盖最旧的记录
+ * @return true
+ * @return false 未开启 GDDI_ENABLE_TRACE
+ */
+bool start_trace(const uint32_t capacity = 16384);
+
+/**
+ * @brief 停止记录, 已记录的数据保留到下一次 start_trace
+ *
+ */
+void stop_trace();
+
+/**
+ * @brief 导出 Chrome trace JSON (chrome://tracing 或 ui.perfetto.dev 打开)
+ *
+ * @return std::string
+ */
+std::string export_chrome_trace();
+
+/**
+ * @brief 导出 Chrome trace JSON 到文件
+ *
+ * @param path 文件路径
+ * @return true
+ * @return false
+ */
+bool dump_chrome_trace(const std::string &path);
+
+}// namespace gddi
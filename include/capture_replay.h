@@ -0,0 +1,72 @@
+/**
+ * @file capture_replay.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 模型原始输出录制 & 无设备回放
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 by GDDI
+ *
+ * 录制: 记录每一帧每个阶段模型的原始输出 (InferResult), 写入内存映射的追加式日志文件.
+ * 回放: 不加载模型、不使用设备, 模型输出从日志读取, 按原流程执行跟踪/重叠合并/时序统计等后处理,
+ *      用于复现现场问题, 以及在没有 BM1684X 的机器上测试后处理性能和回归.
+ *
+ * 回放时按 (算法, 模型序号, stream_id, 帧ID, 帧内调用序号) 查找输出, 需要与录制时相同的算法配置和帧顺序;
+ * 图像内容不参与后处理, 传入与录制时相同尺寸的任意图像即可.
+ * 同一进程内同一算法的多个实例使用同一 stream_id 时无法区分, 录制时请使用不同 stream_id.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gddi {
+
+/**
+ * @brief 开始录制 (进程内所有算法实例), 已在录制时先结束之前的录制
+ *
+ * @param path 日志文件路径
+ * @return true
+ * @return false 文件创建失败
+ */
+bool start_capture(const std::string &path);
+
+/**
+ * @brief 结束录制, 写入索引并关闭文件
+ *
+ */
+void stop_capture();
+
+/**
+ * @brief 开启回放模式, 之后 load_models 加载的模型均为回放模型 (不访问设备), 推理接口跳过图像预处理
+ *
+ * 需要在创建算法实例之前开启, 回放期间不能同时使用真实模型
+ *
+ * @param path 录制的日志文件路径
+ * @return true
+ * @return false 文件不存在或格式错误
+ */
+bool start_replay(const std::string &path);
+
+/**
+ * @brief 关闭回放模式
+ *
+ */
+void stop_replay();
+
+struct CapturedFrame {
+    std::string algo;
+    int32_t stream_id;
+    int64_t frame_id;
+};
+
+/**
+ * @brief 回放日志中的帧 (一阶段模型调用, 按录制顺序), 用于驱动回放
+ *
+ * @return std::vector<CapturedFrame> 未开启回放时为空
+ */
+std::vector<CapturedFrame> replay_frames();
+
+}// namespace gddi
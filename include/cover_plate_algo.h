@@ -53,8 +53,22 @@ public:
      */
     bool sync_infer(const int64_t image_id, const cv::Mat &image, std::vector<AlgoObject> &objects);
 
+    /**
+     * @brief 同步推理接口 (多路视频流), 不同视频流可在多个线程并发调用
+     * 
+     * @param stream_id 视频流ID (0 ~ 16383), 每路视频流独立跟踪和时序统计
+     * @param image_id 
+     * @param image 
+     * @param objects 
+     * @return true 
+     * @return false stream_id 无效或推理失败
+     */
+    bool sync_infer(const int32_t stream_id, const int64_t image_id, const cv::Mat &image,
+                    std::vector<AlgoObject> &objects);
+
 protected:
-    std::vector<AlgoObject> parse_infer_result(const gddeploy::InferResult &infer_result, const float threshold);
+    FrameObjects parse_infer_result(const gddeploy::InferResult &infer_result, const float threshold,
+                                    std::pmr::memory_resource *resource);
 
 private:
     Cover_PlateAlgoConfig config_;
@@ -11,13 +11,21 @@
 
 #pragma once
 
+#include "result_view.h"
 #include "struct_def.h"
 #include <api/infer_api.h>
 #include <core/result_def.h>
 
 namespace gddi {
 
-struct DayNightAlgoConfig {};
+class ResultDelivery;
+
+struct DayNightAlgoConfig {
+    bool scene_cache{false};   // 缓存分类结果, 画面亮度分布变化或超时后才重新分类
+    float scene_threshold{0.1};// 亮度直方图变化阈值 (两直方图不重叠部分的占比, 0 ~ 1)
+    float scene_max_age{60};   // 缓存最长有效时间(秒)
+    int scene_hysteresis{3};   // 新类别连续分类N次后才切换输出, 避免黄昏/清晨结果来回跳变
+};
 
 class DayNightAlgo {
 public:
@@ -42,6 +50,15 @@ public:
      */
     void async_infer(const int64_t image_id, const cv::Mat &image, InferCallback callback);
 
+    /**
+     * @brief 异步推理接口 (视图回调), 结果写入池化缓冲区, 不拷贝为 std::vector<AlgoObject>
+     * 
+     * @param image_id 帧ID
+     * @param image    图像
+     * @param callback 回调, 需要在回调之后使用结果时移走 ResultBuffer
+     */
+    void async_infer_view(const int64_t image_id, const cv::Mat &image, ViewCallback callback);
+
     /**
      * @brief 同步推理接口
      * 
@@ -53,10 +70,25 @@ public:
      */
     bool sync_infer(const int64_t image_id, const cv::Mat &image, std::vector<AlgoObject> &objects);
 
+    /**
+     * @brief 同步推理接口 (多路视频流), 不同视频流可在多个线程并发调用
+     * 
+     * @param stream_id 视频流ID (0 ~ 16383), 每路视频流独立跟踪和时序统计
+     * @param image_id 
+     * @param image 
+     * @param objects 
+     * @return true 
+     * @return false stream_id 无效或推理失败
+     */
+    bool sync_infer(const int32_t stream_id, const int64_t image_id, const cv::Mat &image,
+                    std::vector<AlgoObject> &objects);
+
 protected:
-    std::vector<AlgoObject> parse_infer_result(const gddeploy::InferResult &infer_result);
+    FrameObjects parse_infer_result(const gddeploy::InferResult &infer_result, std::pmr::memory_resource *resource);
 
 private:
+    void async_infer_impl(const int64_t image_id, const cv::Mat &image, const ResultDelivery &infer_callback);
+
     DayNightAlgoConfig config_;
 
     class DayNightAlgoPrivate;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "result_view.h"
 #include "struct_def.h"
 #include <api/infer_api.h>
 #include <core/result_def.h>
@@ -9,6 +10,8 @@
 
 namespace gddi {
 
+class ResultDelivery;
+
 struct HoistingOperationAlgoConfig {
     std::set<std::string> light_labels{"light"};             // 灯的标签
     std::set<std::string> hoisting_labels{"hoisting_object"};// 吊装物的标签
@@ -19,6 +22,9 @@ struct HoistingOperationAlgoConfig {
 
     float statistics_interval{1};   // 每隔N秒统计一次
     float statistics_threshold{0.5};// 统计阈值
+
+    std::map<int32_t, RegionConfig> stream_regions;// 按视频流ID配置检测区域, 未配置的视频流不过滤
+    SpeculationConfig speculation;                 // 一阶段门控模型与二阶段模型的执行方式, 默认顺序执行
 };
 
 class HoistingOperationAlgo {
@@ -29,13 +35,18 @@ public:
     bool load_models(const std::vector<ModelConfig> &models);
 
     void async_infer(const int64_t image_id, const cv::Mat &image, InferCallback infer_callback);
+    void async_infer_view(const int64_t image_id, const cv::Mat &image, ViewCallback view_callback);
     bool sync_infer(const int64_t image_id, const cv::Mat &image, std::vector<AlgoObject> &objects);
+    bool sync_infer(const int32_t stream_id, const int64_t image_id, const cv::Mat &image,
+                    std::vector<AlgoObject> &objects);
 
 protected:
-    std::vector<AlgoObject> filter_infer_result(const gddeploy::InferResult &infer_result,
-                                                const std::set<std::string> &labels);
+    FrameObjects filter_infer_result(const gddeploy::InferResult &infer_result, const std::set<std::string> &labels,
+                                     std::pmr::memory_resource *resource);
 
 private:
+    void async_infer_impl(const int64_t image_id, const cv::Mat &image, const ResultDelivery &infer_callback);
+
     HoistingOperationAlgoConfig config_;
 
     class HoistingOperationAlgoPrivate;
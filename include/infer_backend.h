@@ -0,0 +1,67 @@
+/**
+ * @file infer_backend.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 模型推理后端接口 & 替身后端注册
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 by GDDI
+ *
+ * 默认后端为 gddeploy::InferAPI (设备). 注册替身后端 (如在 CPU 上返回固定检测结果) 后, 之后加载的模型不访问设备,
+ * 合批、全局调度、录制等与设备后端相同, 用于在没有设备的机器上做并发压力测试 (TSan)、合批与调度验证.
+ */
+
+#pragma once
+
+#include <api/infer_api.h>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace gddi {
+
+/**
+ * @brief 接口与 gddeploy::InferAPI 的推理部分一致
+ *
+ * out_package 的数据数与输入数相同, 结果以 InferResult 存入各数据的 MetaData; 异步回调可在任意线程调用, 只调用一次
+ */
+class InferBackend {
+public:
+    virtual ~InferBackend() = default;
+
+    virtual int InferSync(gddeploy::PackagePtr in_package, gddeploy::PackagePtr out_package) = 0;
+
+    virtual void InferAsync(gddeploy::PackagePtr in_package, gddeploy::InferAsyncCallback callback,
+                            gddeploy::any user_data) = 0;
+
+    /**
+     * @brief 等待已提交的异步调用全部回调
+     *
+     */
+    virtual void WaitTaskDone() = 0;
+};
+
+/**
+ * @param algo 算法类名 (如 "SmokeAlgo"), 与 get_metrics 的 algo 相同
+ * @param model_index 模型序号 (load_models 的顺序)
+ * @param model_path ModelConfig::path
+ * @return 为空时模型加载失败
+ */
+using InferBackendFactory = std::function<std::unique_ptr<InferBackend>(
+    const std::string &algo, const uint32_t model_index, const std::string &model_path)>;
+
+/**
+ * @brief 注册替身后端, 之后调用 load_models 的算法实例使用, 已加载的模型不受影响; 回放模式优先
+ *
+ * 替身后端不读取输入图像, 注册期间跳过 cv::Mat 到 BufSurface 的转换 (与回放相同)
+ */
+void set_infer_backend_factory(InferBackendFactory factory);
+
+/**
+ * @brief 取消替身后端, 之后加载的模型使用设备
+ *
+ */
+void reset_infer_backend_factory();
+
+}// namespace gddi
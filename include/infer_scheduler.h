@@ -0,0 +1,124 @@
+/**
+ * @file infer_scheduler.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 跨算法/视频流的推理优先级调度
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 by GDDI
+ *
+ * 开启后所有模型调用先进入调度队列, 同时在设备上执行的调用数不超过 max_inflight:
+ *   - 优先级高的请求先派发; 同一优先级内各流 (算法实例 + 视频流) 按视频流权重加权公平排队 (start-time fair queuing),
+ *     同一个流按提交顺序
+ *   - 等待超过 starvation_ms 的请求每次提升一级, 最高提升到 kNormal
+ *   - 排队超过所属优先级截止时间的请求被丢弃: 同步调用返回失败, 异步调用回调空结果 (不进入后续阶段)
+ * 过载时 kBestEffort 先降级; kCritical 的排队时间只受 max_inflight 与同级请求影响.
+ */
+
+#pragma once
+
+#include "algo_metrics.h"
+#include <array>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace gddi {
+
+enum class InferPriority : uint32_t {
+    kCritical = 0,// 安全关键规则 (如焊接防护罩、安全带)
+    kNormal,      // 默认
+    kBestEffort,  // 过载时先降级
+    kCount
+};
+
+struct SchedulerConfig {
+    uint32_t max_inflight{2};   // 同时提交到设备的调用数 (所有模型共享)
+    uint32_t starvation_ms{200};// 等待超过该时间提升一级优先级, 0 不提升
+
+    std::array<uint32_t, static_cast<size_t>(InferPriority::kCount)> deadline_ms{0, 0, 500};// 排队截止时间, 0 不丢弃
+    std::map<int32_t, uint32_t> stream_weights;// 按视频流ID配置公平排队权重, 未配置为 1
+};
+
+/**
+ * @brief 公平排队的流: 模型调用为所在算法实例的一路视频流, 不同算法实例的同一视频流分开排队
+ *
+ */
+struct InferFlow {
+    const void *id{nullptr};// 流标识 (如算法实例内视频流状态的地址), 与 stream 一起区分流
+    int32_t stream{0};      // 视频流ID, 权重见 stream_weights
+};
+
+struct SchedulerClassStats {
+    uint64_t dispatched{0};   // 派发到设备的调用数
+    uint64_t dropped{0};      // 超过截止时间丢弃的调用数
+    LatencyMetric queue_delay;// 提交到派发的排队时间
+};
+
+struct SchedulerStats {
+    std::array<SchedulerClassStats, static_cast<size_t>(InferPriority::kCount)> classes;// 按提交时的优先级
+};
+
+/**
+ * @brief 调度器, 与设备无关: 派发时调用 Launch 开始推理, 推理完成后调用 Done 释放名额
+ *
+ * 模型调用使用 set_infer_scheduler 开启的全局实例; 也可以单独创建, 用替身后端 (如 CPU 线程 sleep) 验证调度策略
+ */
+class InferScheduler {
+public:
+    using Done = std::function<void()>;
+    using Launch = std::function<void(Done done)>;// 开始推理, 完成后调用 done (任意线程, 只调用一次)
+    using Drop = std::function<void()>;           // 排队超过截止时间, 不会再调用 Launch
+
+    explicit InferScheduler(const SchedulerConfig &config);
+
+    /**
+     * @brief 派发剩余请求 (仍按截止时间丢弃), 等待执行中的调用完成
+     *
+     */
+    ~InferScheduler();
+
+    InferScheduler(const InferScheduler &) = delete;
+    InferScheduler &operator=(const InferScheduler &) = delete;
+
+    /**
+     * @brief 提交请求; Launch 在调度线程中调用, 不能阻塞; Drop 在单独的线程中调用
+     *
+     */
+    void submit(const InferPriority priority, const InferFlow &flow, Launch launch, Drop drop);
+
+    SchedulerStats stats() const;
+
+private:
+    class InferSchedulerPrivate;
+    std::unique_ptr<InferSchedulerPrivate> private_;
+};
+
+/**
+ * @brief 开启全局调度 (进程内所有算法实例的模型调用), 已开启时替换; 旧调度器排队的请求执行完后释放
+ *
+ */
+void set_infer_scheduler(const SchedulerConfig &config);
+
+/**
+ * @brief 关闭全局调度, 之后的模型调用直接提交
+ *
+ */
+void reset_infer_scheduler();
+
+/**
+ * @brief 设置算法的优先级, 未设置为 kNormal
+ *
+ * @param algo 算法类名 (如 "SparksCoverAlgo"), 与 get_metrics 的 algo 相同
+ */
+void set_algo_priority(const std::string &algo, const InferPriority priority);
+
+/**
+ * @brief 全局调度统计
+ *
+ * @return SchedulerStats 未开启时为空
+ */
+SchedulerStats get_scheduler_stats();
+
+}// namespace gddi
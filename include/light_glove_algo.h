@@ -20,6 +20,11 @@ namespace gddi {
 struct LightGloveAlgoConfig {
     float statistics_interval{3};   // 每隔N统计一次
     float statistics_threshold{0.5};// 统计阈值(检测到灯亮并且检测到手套时间占比)
+
+    std::map<int32_t, RegionConfig> stream_regions;         // 按视频流ID配置检测区域, 未配置的视频流不过滤
+    std::map<int32_t, MotionGateConfig> stream_motion_gates;// 按视频流ID配置运动门控, 未配置的视频流每帧推理
+    StateSamplerConfig state_sampler;                       // 一阶段门控模型 (灯光/门状态) 低频采样, 默认每帧推理
+    SpeculationConfig speculation;                          // 一阶段门控模型与二阶段模型的执行方式, 默认顺序执行
 };
 
 class LightGloveAlgo {
@@ -47,9 +52,22 @@ public:
      */
     bool sync_infer(const int64_t image_id, const cv::Mat &image, std::vector<AlgoObject> &objects);
 
+    /**
+     * @brief 同步推理接口 (多路视频流), 不同视频流可在多个线程并发调用
+     * 
+     * @param stream_id 视频流ID (0 ~ 16383), 每路视频流独立跟踪和时序统计
+     * @param image_id 
+     * @param image 
+     * @param objects 
+     * @return true 
+     * @return false stream_id 无效或推理失败
+     */
+    bool sync_infer(const int32_t stream_id, const int64_t image_id, const cv::Mat &image,
+                    std::vector<AlgoObject> &objects);
+
 protected:
-    std::vector<AlgoObject> filter_infer_result(const gddeploy::InferResult &infer_result,
-                                                const std::set<std::string> &labels, const float threshold);
+    FrameObjects filter_infer_result(const gddeploy::InferResult &infer_result, const std::set<std::string> &labels,
+                                     const float threshold, std::pmr::memory_resource *resource);
 
 private:
     LightGloveAlgoConfig config_;
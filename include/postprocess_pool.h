@@ -0,0 +1,63 @@
+/**
+ * @file postprocess_pool.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 异步推理后处理配置 (线程池/帧重排)
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 by GDDI
+ *
+ * async_infer 的推理结果回调 (结果解析/跟踪/二阶段/统计/用户回调) 统一派发到后处理线程池执行,
+ * 推理运行时线程立即返回继续喂数据. 同一算法实例的同一路视频流固定在同一线程, 保证跟踪状态串行更新.
+ * 推理完成顺序可能与提交顺序不同, 进入后处理前按 image_id 顺序重排 (每路视频流一个重排缓冲).
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace gddi {
+
+/**
+ * @brief 设置后处理线程数 (所有算法实例共享), 等待已派发任务执行完后生效
+ *
+ * @param num_threads 0 表示在推理运行时回调线程内直接执行
+ */
+void set_postprocess_threads(const uint32_t num_threads);
+
+/**
+ * @brief 获取后处理线程数
+ *
+ * @return uint32_t
+ */
+uint32_t get_postprocess_threads();
+
+enum class LateFramePolicy {
+    kDeliverEmpty,// 回调空结果, 不进入跟踪和时序统计
+    kDrop,        // 丢弃, 不回调
+};
+
+/**
+ * @brief 设置重排窗口 (每路视频流等待缺失帧时最多缓存的已完成帧数), 默认 8
+ *
+ * @param window 0 表示不等待, 按完成顺序交付, 早于已交付帧的结果按迟到帧处理
+ */
+void set_reorder_window(const uint32_t window);
+
+/**
+ * @brief 设置重排超时 (缺失帧提交后超过该时间仍未完成时不再等待, 如推理出错没有回调), 默认 1000ms
+ *
+ * 超时在同一路视频流的其他帧完成时检查
+ *
+ * @param timeout_ms 0 表示只按重排窗口跳过
+ */
+void set_reorder_timeout(const uint32_t timeout_ms);
+
+/**
+ * @brief 设置迟到帧 (超出重排窗口或超时后才完成的帧) 处理策略, 默认 kDeliverEmpty
+ *
+ * @param policy
+ */
+void set_late_frame_policy(const LateFramePolicy policy);
+
+}// namespace gddi
@@ -0,0 +1,137 @@
+/**
+ * @file result_codec.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 推理结果二进制编码 (可选模块, 用于持久化/传输每帧结果)
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 by GDDI
+ *
+ * 编码格式 (小端, 所有记录 8 字节对齐, 可直接拼接/追加):
+ *   RecordHeader {magic "GDRS", version, type, size (含头和填充), count}  16 字节
+ *   kLabel: {label_id, length, 标签字符串}, 标签ID首次出现时写入, 位于引用它的帧记录之前
+ *   kFrame: {frame_id, timestamp, stream_id, reserved} 24 字节 + count 个 ObjectView (36 字节)
+ * 读取时跳过未知类型的记录, 遇到更高版本的记录停止.
+ */
+
+#pragma once
+
+#include "result_view.h"
+#include "struct_def.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gddi {
+
+constexpr uint16_t kResultCodecVersion = 1;
+
+struct FrameResult {
+    int64_t frame_id;
+    int64_t timestamp;// 由写入方定义 (建议微秒)
+    int32_t stream_id;
+    ObjectSpan objects;// 指向读取缓冲区, 不拷贝
+};
+
+/**
+ * @brief 流式写入, 输出到文件描述符 (带写缓冲) 或内存缓冲区 (直接追加)
+ *
+ * 标签ID为进程内全局标签ID (见 label_id()), 标签表随数据写入, 读取端不依赖写入进程
+ */
+class ResultWriter {
+public:
+    /**
+     * @brief 写入文件描述符, 不接管 fd 的生命周期
+     *
+     * @param fd
+     * @param buffer_size 写缓冲大小, 超出后写入 fd
+     */
+    explicit ResultWriter(const int fd, const size_t buffer_size = 64 * 1024);
+
+    /**
+     * @brief 追加到内存缓冲区, buffer 生命周期须长于 ResultWriter
+     *
+     */
+    explicit ResultWriter(std::vector<uint8_t> &buffer);
+
+    ~ResultWriter();
+
+    ResultWriter(const ResultWriter &) = delete;
+    ResultWriter &operator=(const ResultWriter &) = delete;
+
+    bool write(const int64_t frame_id, const int64_t timestamp, const int32_t stream_id, const ObjectSpan &objects);
+    bool write(const int64_t frame_id, const int64_t timestamp, const int32_t stream_id,
+               const std::vector<AlgoObject> &objects);
+
+    /**
+     * @brief 写缓冲写入 fd (内存缓冲区模式无操作)
+     *
+     * @return false 写入失败, 之后的写入都会失败
+     */
+    bool flush();
+
+private:
+    size_t begin_frame(const int64_t frame_id, const int64_t timestamp, const int32_t stream_id,
+                       const size_t num_objects);
+    void append_object(const ObjectView &object);
+    bool end_frame(const size_t frame_offset);
+
+    int fd_{-1};
+    size_t buffer_size_{0};
+    bool failed_{false};
+
+    std::vector<uint8_t> staging_;
+    std::vector<uint8_t> &output_;
+
+    std::vector<bool> labels_written_;
+    std::vector<int32_t> pending_labels_;// 本帧首次出现的标签ID
+};
+
+/**
+ * @brief 零拷贝读取, 返回的结果直接指向输入缓冲区 (需 4 字节对齐, mmap/std::vector 均满足)
+ *
+ */
+class ResultReader {
+public:
+    ResultReader(const void *data, const size_t size);
+
+    /**
+     * @brief 读取下一帧, 期间遇到的标签记录更新标签表
+     *
+     * @param frame
+     * @return false 读取结束或数据错误 (见 error())
+     */
+    bool next(FrameResult &frame);
+
+    /**
+     * @brief 标签ID -> 标签 (数据中的标签表)
+     *
+     * @return const std::string& 未知ID返回空字符串
+     */
+    const std::string &label(const int32_t label_id) const;
+
+    /**
+     * @brief 错误信息, 正常读取结束时为空
+     *
+     */
+    const std::string &error() const { return error_; }
+
+    /**
+     * @brief 已读取的字节数 (下一条记录的偏移)
+     *
+     */
+    size_t offset() const { return offset_; }
+
+private:
+    bool fail(const std::string &error);
+
+    const uint8_t *data_;
+    size_t size_;
+    size_t offset_{0};
+
+    std::vector<std::string> labels_;
+    std::string error_;
+};
+
+}// namespace gddi
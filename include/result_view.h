@@ -0,0 +1,123 @@
+/**
+ * @file result_view.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 推理结果视图接口 (POD 结果 + 池化结果缓冲区)
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 by GDDI
+ *
+ * 与 InferCallback 相比, ViewCallback 收到的是 POD 结果的只读视图, 标签以全局标签ID表示,
+ * 结果直接写入池化缓冲区, 不为每个目标构造 std::string. 需要在回调之后继续使用结果时 (例如转发到事件总线),
+ * 将 ResultBuffer 移走持有即可, 用完调用 release() 或析构归还缓冲池, 不需要再拷贝结果.
+ */
+
+#pragma once
+
+#include <opencv2/core/mat.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace gddi {
+
+struct ObjectView {
+    int32_t target_id;
+    int32_t class_id;
+    int32_t label_id;// 全局标签ID, 见 label_id()/label_name(), 空标签为 -1
+    float score;
+    int32_t x;
+    int32_t y;
+    int32_t width;
+    int32_t height;
+    int32_t track_id;
+};
+
+/**
+ * @brief 非拥有的只读结果视图
+ *
+ */
+class ObjectSpan {
+public:
+    ObjectSpan() = default;
+    ObjectSpan(const ObjectView *data, const size_t size) : data_(data), size_(size) {}
+
+    const ObjectView *data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    const ObjectView *begin() const { return data_; }
+    const ObjectView *end() const { return data_ + size_; }
+    const ObjectView &operator[](const size_t index) const { return data_[index]; }
+
+private:
+    const ObjectView *data_{nullptr};
+    size_t size_{0};
+};
+
+/**
+ * @brief 池化结果缓冲区句柄, 只能移动不能拷贝
+ *
+ * 释放 (release() 或析构) 后缓冲区归还缓冲池, 之前取得的 ObjectSpan 随之失效.
+ * 可以在任意线程释放.
+ */
+class ResultBuffer {
+public:
+    ResultBuffer() = default;
+    ~ResultBuffer() { release(); }
+
+    ResultBuffer(ResultBuffer &&other) noexcept : block_(other.block_) { other.block_ = nullptr; }
+    ResultBuffer &operator=(ResultBuffer &&other) noexcept;
+
+    ResultBuffer(const ResultBuffer &) = delete;
+    ResultBuffer &operator=(const ResultBuffer &) = delete;
+
+    /**
+     * @brief 结果视图, 缓冲区释放前有效
+     *
+     * @return ObjectSpan 已释放时为空
+     */
+    ObjectSpan objects() const;
+
+    /**
+     * @brief 归还缓冲池, 可重复调用
+     *
+     */
+    void release();
+
+    explicit operator bool() const { return block_ != nullptr; }
+
+private:
+    friend class ResultBufferPool;
+    friend class ResultDelivery;
+
+    struct Block;
+    explicit ResultBuffer(Block *block) : block_(block) {}
+
+    Block *block_{nullptr};
+};
+
+/**
+ * @brief 视图回调, objects 指向 buffer 内的结果
+ *
+ * 回调返回后 buffer 自动归还; 需要继续持有时 std::move(buffer) 移走
+ */
+using ViewCallback =
+    std::function<void(const int64_t, const cv::Mat &, const ObjectSpan &objects, ResultBuffer &buffer)>;
+
+/**
+ * @brief 标签 -> 全局标签ID (进程内唯一, 首次出现时分配, 从 0 开始递增)
+ *
+ * @return int32_t 空字符串返回 -1; 已登记 4096 个标签后, 新标签返回 -1
+ */
+int32_t label_id(const std::string &label);
+
+/**
+ * @brief 全局标签ID -> 标签
+ *
+ * @return const std::string& 无效ID返回空字符串
+ */
+const std::string &label_name(const int32_t label_id);
+
+}// namespace gddi
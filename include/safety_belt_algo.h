@@ -1,5 +1,6 @@
 #pragma once
 
+#include "result_view.h"
 #include "struct_def.h"
 #include <api/infer_api.h>
 #include <core/result_def.h>
@@ -9,6 +10,8 @@
 
 namespace gddi {
 
+class ResultDelivery;
+
 struct SafetyBeltAlgoConfig {
     uint32_t delay_time{3};    // 延迟时间
     float light_threshold{0.3};// 灯光统计阈值
@@ -25,13 +28,18 @@ public:
     bool load_models(const std::vector<ModelConfig> &models);
 
     void async_infer(const int64_t image_id, const cv::Mat &image, InferCallback infer_callback);
+    void async_infer_view(const int64_t image_id, const cv::Mat &image, ViewCallback view_callback);
     bool sync_infer(const int64_t image_id, const cv::Mat &image, std::vector<AlgoObject> &objects);
+    bool sync_infer(const int32_t stream_id, const int64_t image_id, const cv::Mat &image,
+                    std::vector<AlgoObject> &objects);
 
 protected:
-    std::vector<AlgoObject> filter_infer_result(const gddeploy::InferResult &infer_result,
-                                                const std::set<std::string> &labels);
+    FrameObjects filter_infer_result(const gddeploy::InferResult &infer_result, const std::set<std::string> &labels,
+                                     std::pmr::memory_resource *resource);
 
 private:
+    void async_infer_impl(const int64_t image_id, const cv::Mat &image, const ResultDelivery &infer_callback);
+
     SafetyBeltAlgoConfig config_;
 
     class SafetyBeltAlgoPrivate;
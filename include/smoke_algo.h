@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include "result_view.h"
 #include "struct_def.h"
 #include <api/infer_api.h>
 #include <core/result_def.h>
@@ -18,6 +19,8 @@
 
 namespace gddi {
 
+class ResultDelivery;
+
 struct SmokeAlgoConfig {
     std::set<std::string> include_labels{"hand", "smoke"};// 多目标重叠标签
     std::set<std::string> exclude_labels;                 // 多目标重叠排除标签
@@ -26,6 +29,8 @@ struct SmokeAlgoConfig {
 
     float statistics_interval{1};   // 每隔N秒统计一次
     float statistics_threshold{0.5};// 统计阈值(手与香烟重叠时间占比)
+
+    std::map<int32_t, RegionConfig> stream_regions;// 按视频流ID配置检测区域, 未配置的视频流不过滤
 };
 
 class SmokeAlgo {
@@ -51,6 +56,15 @@ public:
      */
     void async_infer(const int64_t image_id, const cv::Mat &image, InferCallback callback);
 
+    /**
+     * @brief 异步推理接口 (视图回调), 结果写入池化缓冲区, 不拷贝为 std::vector<AlgoObject>
+     * 
+     * @param image_id 帧ID
+     * @param image    图像
+     * @param callback 回调, 需要在回调之后使用结果时移走 ResultBuffer
+     */
+    void async_infer_view(const int64_t image_id, const cv::Mat &image, ViewCallback callback);
+
     /**
      * @brief 同步推理接口
      * 
@@ -62,10 +76,25 @@ public:
      */
     bool sync_infer(const int64_t image_id, const cv::Mat &image, std::vector<AlgoObject> &objects);
 
+    /**
+     * @brief 同步推理接口 (多路视频流), 不同视频流可在多个线程并发调用
+     * 
+     * @param stream_id 视频流ID (0 ~ 16383), 每路视频流独立跟踪和时序统计
+     * @param image_id 
+     * @param image 
+     * @param objects 
+     * @return true 
+     * @return false stream_id 无效或推理失败
+     */
+    bool sync_infer(const int32_t stream_id, const int64_t image_id, const cv::Mat &image,
+                    std::vector<AlgoObject> &objects);
+
 protected:
-    std::vector<AlgoObject> parse_infer_result(const gddeploy::InferResult &infer_result);
+    FrameObjects parse_infer_result(const gddeploy::InferResult &infer_result, std::pmr::memory_resource *resource);
 
 private:
+    void async_infer_impl(const int64_t image_id, const cv::Mat &image, const ResultDelivery &infer_callback);
+
     SmokeAlgoConfig config_;
 
     class SmokeAlgoPrivate;
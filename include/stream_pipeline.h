@@ -0,0 +1,98 @@
+/**
+ * @file stream_pipeline.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 解码 → 推理流水线 (每路视频源一个解码线程, 有界无锁帧队列, N 个推理线程)
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 by GDDI
+ *
+ * 解码与推理重叠执行, 推理慢于解码时按配置丢帧或让解码线程等待, 不需要在调用方按帧率 sleep.
+ * 同一路视频源的帧固定由同一个推理线程按解码顺序处理, 跟踪和时序统计的输入顺序不变.
+ */
+
+#pragma once
+
+#include "algo_metrics.h"
+#include <functional>
+#include <memory>
+#include <opencv2/core/mat.hpp>
+#include <string>
+
+namespace gddi {
+
+struct StreamPipelineConfig {
+    uint32_t queue_capacity{8};// 每个推理线程的帧队列容量
+    uint32_t num_workers{2};   // 推理线程数
+    bool drop_when_full{true}; // 队列满时丢弃新解码的帧, false 时解码线程等待
+    bool realtime{false};      // 按视频帧率解码 (视频文件模拟实时相机), 相机/网络流不需要
+};
+
+/**
+ * @brief 推理回调, 在推理线程中调用; 不同视频源的回调可能并发
+ *
+ * @param stream_id add_source 传入的视频流ID
+ * @param image_id 帧ID (每路视频源从 0 开始递增, 丢弃的帧也占用帧ID)
+ * @param image BGR 图像
+ */
+using PipelineHandler = std::function<void(const int32_t stream_id, const int64_t image_id, const cv::Mat &image)>;
+
+struct PipelineStats {
+    uint64_t decoded{0};  // 解码帧数
+    uint64_t dropped{0};  // 队列满丢弃的帧数
+    uint64_t processed{0};// 推理完成的帧数
+
+    LatencyMetric queue_wait;// 解码完成到开始推理
+    LatencyMetric latency;   // 解码完成到推理回调返回
+};
+
+class StreamPipeline {
+public:
+    StreamPipeline(const StreamPipelineConfig &config, PipelineHandler handler);
+
+    /**
+     * @brief 未停止时先 stop
+     *
+     */
+    ~StreamPipeline();
+
+    /**
+     * @brief 添加视频源 (OpenCV VideoCapture 解码), 已启动时立即开始解码
+     *
+     * @param stream_id 视频流ID, 传给推理回调
+     * @param uri 视频文件路径或 rtsp 地址
+     * @return true
+     * @return false 打开失败或已停止
+     */
+    bool add_source(const int32_t stream_id, const std::string &uri);
+
+    /**
+     * @brief 启动推理线程和已添加视频源的解码线程
+     *
+     */
+    void start();
+
+    /**
+     * @brief 停止解码, 已入队的帧推理完后返回; 不能在推理回调中调用
+     *
+     */
+    void stop();
+
+    /**
+     * @brief 等待所有视频源解码结束 (视频文件读完/网络流断开), 已入队的帧推理完后返回
+     *
+     */
+    void wait();
+
+    /**
+     * @brief 计数与耗时快照, 可在任意线程调用
+     *
+     */
+    PipelineStats stats() const;
+
+private:
+    class StreamPipelinePrivate;
+    std::unique_ptr<StreamPipelinePrivate> private_;
+};
+
+}// namespace gddi
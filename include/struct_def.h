@@ -16,6 +16,9 @@
 #include <iostream>
 #include <algorithm>
 #include <functional>
+#include <map>
+#include <memory_resource>
+#include <vector>
 
 
 namespace gddi {
@@ -31,7 +34,53 @@ struct ModelConfig {
     float crop_scale_factor{1.0f};// 输入目标框缩放系数
     uint32_t max_crop_number{8};  // 最多裁剪目标数 (默认按置信度+目标框面积排序)
 
-    float nms_threshold{0.1f};// NMS阈值
+    float nms_threshold{0.1f};     // NMS阈值
+    float crop_nms_threshold{0};   // 多个裁剪结果合并后同标签去重的IoU阈值 (重复目标保留给所在的跟踪目标), 0 不去重
+    float crop_merge_ratio{0};     // 重叠裁剪合并推理阈值 (合并后面积 / 各自面积之和), 0 不合并
+    int atlas_size{0};             // 小裁剪拼图推理的画布边长 (模型输入分辨率), 0 不拼图
+
+    // 以下为多路视频流共用模型时的跨视频流合批参数 (适用于每帧调用一次的一阶段全图模型)
+    uint32_t max_batch_size{1};  // 每批最多输入数, 1 不合批
+    uint32_t batch_wait_us{2000};// 第一个请求等待凑批的最长时间(us)
+
+    // 以下为全图检测的分块推理参数
+    int tile_size{0};                // 分块边长, 0 或不小于图像宽高时不分块
+    float tile_overlap{0.2f};        // 相邻分块重叠比例
+    float tile_merge_threshold{0.6f};// 相邻分块检出的同标签目标合并阈值 (交集 / 较小框面积), 0 不合并
+};
+
+// 检测区域, 多边形顶点为原图像素座标
+struct RegionConfig {
+    std::vector<std::vector<cv::Point>> include_regions;// 检测区域, 为空表示全图
+    std::vector<std::vector<cv::Point>> exclude_regions;// 屏蔽区域, 优先于检测区域
+    bool crop_infer{false};                             // 一阶段只推理检测区域的外接矩形, 结果换算回原图
+};
+
+// 运动门控, 画面静止时跳过推理; 在缩小的亮度图上与上一次推理的帧比较
+struct MotionGateConfig {
+    int thumb_width{64};         // 亮度缩略图宽度, 高度按原图比例
+    int pixel_threshold{20};     // 亮度差超过该值的像素视为变化
+    float area_threshold{0.002f};// 变化像素占比超过该值视为有运动
+    int max_skip_frames{25};     // 连续跳过帧数上限, 达到后强制推理一帧
+    bool reemit_last{true};      // 跳过的帧沿用上一次推理结果, false 时输出空结果 (静止帧)
+};
+
+// 门控模型 (灯光开关、门开关等缓慢变化的状态) 低频采样
+struct StateSamplerConfig {
+    float interval{0};// 门控模型推理间隔(秒), 0 每帧推理
+    int hysteresis{2};// 状态连续采样N次一致后才切换
+};
+
+// 一阶段门控模型与二阶段全图模型的执行方式
+enum class SpeculationMode {
+    kSequential, // 顺序执行, 门控通过后才推理二阶段
+    kSpeculative,// 两个模型同时提交, 门控未通过时丢弃二阶段结果
+    kAdaptive,   // 按视频流统计的门控通过率选择
+};
+
+struct SpeculationConfig {
+    SpeculationMode mode{SpeculationMode::kSequential};
+    float pass_rate{0.6f};// kAdaptive: 门控通过率不低于该值时同时提交
 };
 
 struct AlgoObject {
@@ -43,6 +92,9 @@ struct AlgoObject {
     int track_id;
 };
 
+// 帧内中间结果, 从每路视频流的帧内存池分配
+using FrameObjects = std::pmr::vector<AlgoObject>;
+
 using InferCallback = std::function<void(const int64_t, const cv::Mat &, const std::vector<AlgoObject> &)>;
 
 }// namespace gddi
\ No newline at end of file
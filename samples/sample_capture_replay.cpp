@@ -0,0 +1,90 @@
+#include "algo_metrics.h"
+#include "capture_replay.h"
+#include "smoke_algo.h"
+#include <chrono>
+#include <opencv2/videoio.hpp>
+
+// 录制: sample_capture_replay capture <video> <log>
+// 回放: sample_capture_replay replay <log> [width] [height]   (不需要设备, 只执行后处理)
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        printf("Usage: %s capture <video> <log> | replay <log> [width] [height]\n", argv[0]);
+        return -1;
+    }
+
+    std::string mode = argv[1];
+    std::vector<gddi::ModelConfig> models = {{"person", "../models/person.gdd", "../models/license_person.gdd", 0.3},
+                                             {"smoke", "../models/smoke.gdd", "../models/license_smoke.gdd", 0.3}};
+
+    if (mode == "capture" && argc >= 4) {
+        if (!gddi::start_capture(argv[3])) {
+            printf("Failed to create capture log: %s\n", argv[3]);
+            return -1;
+        }
+
+        auto smoke_algo = std::make_unique<gddi::SmokeAlgo>(gddi::SmokeAlgoConfig{});
+        if (!smoke_algo->load_models(models)) {
+            printf("Failed to load models\n");
+            return -1;
+        }
+
+        auto video = cv::VideoCapture(argv[2]);
+        if (!video.isOpened()) {
+            printf("Failed to open video: %s\n", argv[2]);
+            return -1;
+        }
+
+        int64_t frame_index = 0;
+        cv::Mat frame;
+        while (video.read(frame)) {
+            std::vector<gddi::AlgoObject> objects;
+            smoke_algo->sync_infer(frame_index++, frame, objects);
+        }
+
+        gddi::stop_capture();
+        printf("Captured %ld frames (%dx%d)\n", frame_index, frame.cols, frame.rows);
+        return 0;
+    }
+
+    if (mode == "replay") {
+        if (!gddi::start_replay(argv[2])) {
+            printf("Failed to open capture log: %s\n", argv[2]);
+            return -1;
+        }
+
+        // 回放模型不加载模型文件
+        auto smoke_algo = std::make_unique<gddi::SmokeAlgo>(gddi::SmokeAlgoConfig{});
+        if (!smoke_algo->load_models(models)) {
+            printf("Failed to create replay models\n");
+            return -1;
+        }
+
+        // 图像内容不参与后处理, 尺寸需与录制时一致
+        auto width = argc > 3 ? std::stoi(argv[3]) : 1920;
+        auto height = argc > 4 ? std::stoi(argv[4]) : 1080;
+        cv::Mat image(height, width, CV_8UC3, cv::Scalar(0, 0, 0));
+
+        int64_t num_frames = 0;
+        int64_t num_objects = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (const auto &frame : gddi::replay_frames()) {
+            if (frame.algo != "SmokeAlgo") { continue; }
+
+            std::vector<gddi::AlgoObject> objects;
+            smoke_algo->sync_infer(frame.stream_id, frame.frame_id, image, objects);
+            num_frames++;
+            num_objects += objects.size();
+        }
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        gddi::stop_replay();
+        printf("Replayed %ld frames, %ld events, %.0f frames/s\n", num_frames, num_objects, num_frames / elapsed);
+
+        // 各阶段耗时 (Prometheus 文本格式)
+        printf("%s", gddi::export_prometheus_metrics().c_str());
+        return 0;
+    }
+
+    printf("Unknown mode: %s\n", mode.c_str());
+    return -1;
+}
@@ -0,0 +1,90 @@
+#include "algo_metrics.h"
+#include "smoke_algo.h"
+#include "stand_in_backend.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+// 多线程并发压力测试 (不需要设备): 替身后端返回固定的行人/手/香烟检测结果,
+// 多个线程对同一个抽烟算法实例的不同视频流调用 sync_infer, 同时在视频流 0 上调用 async_infer.
+// 用 -DCMAKE_CXX_FLAGS="-fsanitize=thread" 编译后运行, 检查数据竞争
+// 用法: sample_concurrent_infer [threads] [frames]
+
+int main(int argc, char **argv) {
+    auto num_threads = argc > 1 ? std::atoi(argv[1]) : 8;
+    auto num_frames = argc > 2 ? std::atoi(argv[2]) : 500;
+
+    // 一阶段两个行人, 二阶段每个裁剪内手与香烟重叠
+    auto person = std::make_shared<sample::StandInBackend>(
+        sample::make_detect_result({{0, "person", 0.9f, 200, 200, 300, 600}, {0, "person", 0.8f, 1000, 300, 300, 600}}),
+        200, 2);
+    auto smoke = std::make_shared<sample::StandInBackend>(
+        sample::make_detect_result({{0, "hand", 0.8f, 50, 50, 60, 60}, {1, "smoke", 0.7f, 60, 60, 30, 30}}), 100, 2);
+    gddi::set_infer_backend_factory(
+        [&](const std::string &, const uint32_t model_index, const std::string &) -> std::unique_ptr<gddi::InferBackend> {
+            return std::make_unique<sample::SharedBackend>(model_index == 0 ? person : smoke);
+        });
+
+    std::atomic<int> failures{0};
+    std::mutex mutex;
+    std::vector<int64_t> delivered;
+    {
+        gddi::SmokeAlgo algo(gddi::SmokeAlgoConfig{});
+        std::vector<gddi::ModelConfig> models = {{"person", "person.gdd", "", 0.3}, {"smoke", "smoke.gdd", "", 0.3}};
+        if (!algo.load_models(models)) {
+            printf("Failed to load models\n");
+            return -1;
+        }
+
+        const cv::Mat image(1080, 1920, CV_8UC3, cv::Scalar(0, 0, 0));
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < num_threads; i++) {
+            threads.emplace_back([&, i]() {
+                std::vector<gddi::AlgoObject> objects;
+                for (int64_t frame = 0; frame < num_frames; frame++) {
+                    if (!algo.sync_infer(i + 1, frame, image, objects)) { failures++; }
+                }
+            });
+        }
+
+        gddi::InferCallback callback = [&](const int64_t image_id, const cv::Mat &,
+                                           const std::vector<gddi::AlgoObject> &) {
+            std::lock_guard<std::mutex> lock(mutex);
+            delivered.push_back(image_id);
+        };
+        for (int64_t frame = 0; frame < num_frames; frame++) { algo.async_infer(frame, image, callback); }
+
+        for (auto &thread : threads) { thread.join(); }
+        // 析构时等待异步结果全部回调
+    }
+    gddi::reset_infer_backend_factory();
+
+    bool pass = failures == 0;
+    printf("sync_infer: %d threads x %d frames, failures: %d\n", num_threads, num_frames, failures.load());
+
+    auto in_order = std::is_sorted(delivered.begin(), delivered.end());
+    pass = pass && delivered.size() == static_cast<size_t>(num_frames) && in_order;
+    printf("async_infer: %zu/%d callbacks, %s\n", delivered.size(), num_frames, in_order ? "in order" : "OUT OF ORDER");
+
+    auto expected_calls = static_cast<uint64_t>(num_threads + 1) * num_frames;
+    pass = pass && person->calls() == expected_calls;
+    printf("model calls: person %lu/%lu, smoke %lu\n", person->calls(), expected_calls, smoke->calls());
+
+    // 每路视频流各自计时, 帧数与提交数相同
+    int complete_streams = 0;
+    for (const auto &metric : gddi::get_metrics()) {
+        if (metric.algo == "SmokeAlgo" && metric.stage == "infer_stage1"
+            && metric.count == static_cast<uint64_t>(num_frames)) {
+            complete_streams++;
+        }
+    }
+    pass = pass && complete_streams == num_threads + 1;
+    printf("streams with %d timed frames: %d/%d\n", num_frames, complete_streams, num_threads + 1);
+
+    printf("%s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : -1;
+}
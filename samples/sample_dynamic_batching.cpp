@@ -0,0 +1,92 @@
+#include "algo_metrics.h"
+#include "smoke_algo.h"
+#include "stand_in_backend.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+// 跨视频流动态合批 (不需要设备): 行人模型开启合批, 替身后端每次调用 5ms、同时 1 个调用,
+// 多个线程对同一个抽烟算法实例的不同视频流调用 sync_infer. 检查合批统计与替身后端实际收到的批一致, 平均批大小大于 1
+// 用法: sample_dynamic_batching [threads] [frames] [max_batch_size]
+
+int main(int argc, char **argv) {
+    auto num_threads = argc > 1 ? std::atoi(argv[1]) : 8;
+    auto num_frames = argc > 2 ? std::atoi(argv[2]) : 200;
+    auto max_batch_size = argc > 3 ? static_cast<uint32_t>(std::atoi(argv[3])) : 4u;
+
+    // 一阶段两个行人, 二阶段每个裁剪内手与香烟重叠
+    auto person = std::make_shared<sample::StandInBackend>(
+        sample::make_detect_result({{0, "person", 0.9f, 200, 200, 300, 600}, {0, "person", 0.8f, 1000, 300, 300, 600}}),
+        5000, 1);
+    auto smoke = std::make_shared<sample::StandInBackend>(
+        sample::make_detect_result({{0, "hand", 0.8f, 50, 50, 60, 60}, {1, "smoke", 0.7f, 60, 60, 30, 30}}), 100, 4);
+    gddi::set_infer_backend_factory(
+        [&](const std::string &, const uint32_t model_index, const std::string &) -> std::unique_ptr<gddi::InferBackend> {
+            return std::make_unique<sample::SharedBackend>(model_index == 0 ? person : smoke);
+        });
+
+    std::atomic<int> failures{0};
+    {
+        gddi::SmokeAlgo algo(gddi::SmokeAlgoConfig{});
+        std::vector<gddi::ModelConfig> models = {{"person", "person.gdd", "", 0.3}, {"smoke", "smoke.gdd", "", 0.3}};
+        models[0].max_batch_size = max_batch_size;
+        models[0].batch_wait_us = 2000;
+        if (!algo.load_models(models)) {
+            printf("Failed to load models\n");
+            return -1;
+        }
+
+        const cv::Mat image(1080, 1920, CV_8UC3, cv::Scalar(0, 0, 0));
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < num_threads; i++) {
+            threads.emplace_back([&, i]() {
+                std::vector<gddi::AlgoObject> objects;
+                for (int64_t frame = 0; frame < num_frames; frame++) {
+                    if (!algo.sync_infer(i + 1, frame, image, objects)) { failures++; }
+                }
+            });
+        }
+        for (auto &thread : threads) { thread.join(); }
+    }
+    gddi::reset_infer_backend_factory();
+
+    bool pass = failures == 0;
+    printf("sync_infer: %d threads x %d frames, failures: %d\n", num_threads, num_frames, failures.load());
+
+    const gddi::BatchMetric *metric = nullptr;
+    auto metrics = gddi::get_batch_metrics();
+    for (const auto &item : metrics) {
+        if (item.algo == "SmokeAlgo" && item.model == 0) { metric = &item; }
+    }
+    if (!metric) {
+        printf("no batch metric for SmokeAlgo model 0\nFAIL\n");
+        return -1;
+    }
+
+    // 统计与替身后端收到的调用一致
+    uint64_t counted = 0;
+    printf("batch sizes:");
+    for (const auto &[size, batches] : metric->batch_sizes) {
+        printf(" %u x %lu", size, batches);
+        counted += batches;
+    }
+    printf("\n");
+
+    auto expected_inputs = static_cast<uint64_t>(num_threads) * num_frames;
+    auto average = metric->batches > 0 ? static_cast<double>(metric->inputs) / metric->batches : 0.0;
+    printf("batches: %lu (backend calls %lu), inputs: %lu (backend %lu, expected %lu), average %.2f, max %u (backend "
+           "%u)\n",
+           metric->batches, person->calls(), metric->inputs, person->inputs(), expected_inputs, average,
+           metric->max_batch_size, person->max_batch());
+    printf("batch queue: p50 %lu us, p99 %lu us\n", metric->queue_delay.p50_us, metric->queue_delay.p99_us);
+
+    pass = pass && metric->batches == person->calls() && counted == metric->batches;
+    pass = pass && metric->inputs == person->inputs() && metric->inputs == expected_inputs;
+    pass = pass && metric->max_batch_size == person->max_batch() && metric->max_batch_size <= max_batch_size;
+    pass = pass && (num_threads <= 1 || average > 1.0);
+
+    printf("%s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : -1;
+}
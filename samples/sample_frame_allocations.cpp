@@ -0,0 +1,103 @@
+#include "smoke_algo.h"
+#include "stand_in_backend.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+// 每帧堆分配次数 (不需要设备): 替换全局 operator new 计数, 抽烟算法 sync_infer 预热后统计 kFrames 帧.
+// 只统计调用线程上 SDK 自身的分配, 替身后端内部的分配 (设备 SDK 的分配同样不在此统计) 不计入
+// 用法: sample_frame_allocations [max_allocs_per_frame]
+
+namespace {
+
+constexpr int kWarmupFrames = 200;
+constexpr int kFrames = 1000;
+
+thread_local bool t_counting = false;
+std::atomic<uint64_t> g_allocations{0};
+std::atomic<uint64_t> g_bytes{0};
+
+void *counted_alloc(const size_t size) {
+    if (t_counting) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        g_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    if (auto ptr = std::malloc(size ? size : 1)) { return ptr; }
+    throw std::bad_alloc();
+}
+
+// 替身后端内部暂停计数
+class UncountedBackend : public gddi::InferBackend {
+public:
+    explicit UncountedBackend(gddeploy::InferResult result) : backend_(std::move(result), 0) {}
+
+    int InferSync(gddeploy::PackagePtr in_package, gddeploy::PackagePtr out_package) override {
+        auto counting = t_counting;
+        t_counting = false;
+        auto ret = backend_.InferSync(in_package, out_package);
+        t_counting = counting;
+        return ret;
+    }
+
+    void InferAsync(gddeploy::PackagePtr in_package, gddeploy::InferAsyncCallback callback,
+                    gddeploy::any user_data) override {
+        backend_.InferAsync(in_package, callback, user_data);
+    }
+
+    void WaitTaskDone() override { backend_.WaitTaskDone(); }
+
+private:
+    sample::StandInBackend backend_;
+};
+
+}// namespace
+
+void *operator new(size_t size) { return counted_alloc(size); }
+void *operator new[](size_t size) { return counted_alloc(size); }
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { std::free(ptr); }
+
+int main(int argc, char **argv) {
+    auto max_allocs = argc > 1 ? std::atof(argv[1]) : -1.0;
+
+    // 一阶段两个行人, 二阶段每个裁剪内手与香烟重叠 (每帧 1 次一阶段 + 2 次二阶段推理)
+    gddi::set_infer_backend_factory([](const std::string &, const uint32_t model_index,
+                                       const std::string &) -> std::unique_ptr<gddi::InferBackend> {
+        if (model_index == 0) {
+            return std::make_unique<UncountedBackend>(sample::make_detect_result(
+                {{0, "person", 0.9f, 200, 200, 300, 600}, {0, "person", 0.8f, 1000, 300, 300, 600}}));
+        }
+        return std::make_unique<UncountedBackend>(
+            sample::make_detect_result({{0, "hand", 0.8f, 50, 50, 60, 60}, {1, "smoke", 0.7f, 60, 60, 30, 30}}));
+    });
+
+    gddi::SmokeAlgo algo(gddi::SmokeAlgoConfig{});
+    std::vector<gddi::ModelConfig> models = {{"person", "person.gdd", "", 0.3}, {"smoke", "smoke.gdd", "", 0.3}};
+    if (!algo.load_models(models)) {
+        printf("Failed to load models\n");
+        return -1;
+    }
+
+    const cv::Mat image(1080, 1920, CV_8UC3, cv::Scalar(0, 0, 0));
+    std::vector<gddi::AlgoObject> objects;
+    for (int64_t frame = 0; frame < kWarmupFrames; frame++) { algo.sync_infer(1, frame, image, objects); }
+
+    t_counting = true;
+    for (int64_t frame = kWarmupFrames; frame < kWarmupFrames + kFrames; frame++) {
+        algo.sync_infer(1, frame, image, objects);
+    }
+    t_counting = false;
+    gddi::reset_infer_backend_factory();
+
+    auto allocs = static_cast<double>(g_allocations.load()) / kFrames;
+    auto bytes = static_cast<double>(g_bytes.load()) / kFrames;
+    printf("SmokeAlgo sync_infer: %.1f allocations/frame, %.0f bytes/frame (%d frames)\n", allocs, bytes, kFrames);
+
+    if (max_allocs < 0) { return 0; }
+    auto pass = allocs <= max_allocs;
+    printf("%s: %.1f %s %.1f allocations/frame\n", pass ? "PASS" : "FAIL", allocs, pass ? "<=" : ">", max_allocs);
+    return pass ? 0 : -1;
+}
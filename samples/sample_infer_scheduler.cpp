@@ -0,0 +1,139 @@
+#include "infer_scheduler.h"
+#include "play_phone_algo.h"
+#include "smoke_algo.h"
+#include "stand_in_backend.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+// 推理优先级调度 (不需要设备): 所有模型共用一个替身后端, 每次调用 2ms、同时 2 个调用 (与 max_inflight 相同)
+// 抽烟算法 (kCritical) 1 路、玩手机算法 (kBestEffort) 12 路视频流每 20ms 同步推理一帧, 同时各自的异步接口每 20ms
+// 提交一帧. kCritical 的请求量低于处理能力, 加上 kBestEffort 后超过处理能力. 玩手机算法的行人模型开启合批,
+// 先合批再排队, 每批只占一个调度名额. kBestEffort 排队超过两次饥饿提升 (10ms) 的请求只提升到 kNormal, 不与 kCritical 竞争.
+// 检查 kBestEffort 积压时 kCritical 没有丢弃、排队 p99 不超过 kCriticalQueueBound,
+// 异步结果 (含排队超时的空结果) 在算法实例析构前全部回调
+// 用法: sample_infer_scheduler [seconds]
+
+namespace {
+
+constexpr int32_t kCriticalStreams = 1;
+constexpr int32_t kBestEffortStreams = 12;
+constexpr auto kFrameInterval = std::chrono::milliseconds(20);
+constexpr uint32_t kCallLatencyUs = 2000;
+// 不可抢占: 等待正在执行的调用结束, 再加上同级排在前面的请求
+constexpr uint64_t kCriticalQueueBound = 5 * kCallLatencyUs;
+
+struct StreamLoad {
+    std::atomic<uint64_t> submitted{0};
+    std::atomic<uint64_t> delivered{0};
+};
+
+// 每路视频流 (同步) 与异步接口按帧间隔推理, 直到 end
+template <typename Algo>
+void run_streams(Algo &algo, const int32_t streams, const cv::Mat &image,
+                 const std::chrono::steady_clock::time_point end, StreamLoad &load) {
+    std::vector<std::thread> threads;
+    for (int32_t stream_id = 1; stream_id <= streams; stream_id++) {
+        threads.emplace_back([&, stream_id]() {
+            std::vector<gddi::AlgoObject> objects;
+            auto next = std::chrono::steady_clock::now();
+            for (int64_t frame = 0; next < end; frame++) {
+                algo.sync_infer(stream_id, frame, image, objects);
+                next += kFrameInterval;
+                std::this_thread::sleep_until(next);
+            }
+        });
+    }
+
+    gddi::InferCallback callback = [&load](const int64_t, const cv::Mat &, const std::vector<gddi::AlgoObject> &) {
+        load.delivered.fetch_add(1, std::memory_order_relaxed);
+    };
+    auto next = std::chrono::steady_clock::now();
+    for (int64_t frame = 0; next < end; frame++) {
+        load.submitted.fetch_add(1, std::memory_order_relaxed);
+        algo.async_infer(frame, image, callback);
+        next += kFrameInterval;
+        std::this_thread::sleep_until(next);
+    }
+
+    for (auto &thread : threads) { thread.join(); }
+}
+
+}// namespace
+
+int main(int argc, char **argv) {
+    auto seconds = argc > 1 ? std::atoi(argv[1]) : 5;
+
+    // 替身后端返回两个行人, 与其中一个重叠的手、香烟和手机
+    auto device = std::make_shared<sample::StandInBackend>(
+        sample::make_detect_result({{0, "person", 0.9f, 200, 200, 300, 600},
+                                    {0, "person", 0.8f, 1000, 300, 300, 600},
+                                    {1, "hand", 0.8f, 250, 250, 60, 60},
+                                    {2, "smoke", 0.7f, 260, 260, 30, 30},
+                                    {3, "phone", 0.7f, 260, 260, 40, 40}}),
+        kCallLatencyUs, 2);
+    gddi::set_infer_backend_factory(
+        [&](const std::string &, const uint32_t, const std::string &) -> std::unique_ptr<gddi::InferBackend> {
+            return std::make_unique<sample::SharedBackend>(device);
+        });
+
+    gddi::SchedulerConfig config;
+    config.max_inflight = 2;
+    config.starvation_ms = 5;
+    config.deadline_ms = {0, 1000, 1000};
+    gddi::set_infer_scheduler(config);
+    gddi::set_algo_priority("SmokeAlgo", gddi::InferPriority::kCritical);
+    gddi::set_algo_priority("PlayPhoneAlgo", gddi::InferPriority::kBestEffort);
+
+    StreamLoad smoke_load, phone_load;
+    {
+        gddi::SmokeAlgo smoke(gddi::SmokeAlgoConfig{});
+        gddi::PlayPhoneAlgo phone(gddi::PlayPhoneAlgoConfig{});
+        std::vector<gddi::ModelConfig> models = {{"person", "person.gdd", "", 0.3}, {"smoke", "smoke.gdd", "", 0.3}};
+        if (!smoke.load_models(models)) {
+            printf("Failed to load models\n");
+            return -1;
+        }
+        models[0].max_batch_size = 4;
+        if (!phone.load_models(models)) {
+            printf("Failed to load models\n");
+            return -1;
+        }
+
+        const cv::Mat image(1080, 1920, CV_8UC3, cv::Scalar(0, 0, 0));
+        auto end = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+        std::thread smoke_thread([&]() { run_streams(smoke, kCriticalStreams, image, end, smoke_load); });
+        run_streams(phone, kBestEffortStreams, image, end, phone_load);
+        smoke_thread.join();
+
+        // 析构时等待排队中的调用回调, 之后不再有回调
+    }
+    auto stats = gddi::get_scheduler_stats();
+    gddi::reset_infer_scheduler();
+    gddi::reset_infer_backend_factory();
+
+    const char *names[] = {"critical", "normal", "best_effort"};
+    for (size_t i = 0; i < stats.classes.size(); i++) {
+        const auto &item = stats.classes[i];
+        printf("%-12s dispatched: %6lu, dropped: %6lu, queue p50: %6lu us, p99: %6lu us\n", names[i], item.dispatched,
+               item.dropped, item.queue_delay.p50_us, item.queue_delay.p99_us);
+    }
+    printf("device calls: %lu, inputs: %lu, max batch: %u\n", device->calls(), device->inputs(), device->max_batch());
+
+    const auto &critical = stats.classes[static_cast<size_t>(gddi::InferPriority::kCritical)];
+    const auto &best_effort = stats.classes[static_cast<size_t>(gddi::InferPriority::kBestEffort)];
+    printf("critical queue p99 bound: %lu us\n", kCriticalQueueBound);
+    bool pass = best_effort.queue_delay.p99_us > kCriticalQueueBound;
+    pass = pass && critical.dropped == 0 && critical.queue_delay.p99_us <= kCriticalQueueBound;
+    for (auto [name, load] : {std::make_pair("SmokeAlgo", &smoke_load), std::make_pair("PlayPhoneAlgo", &phone_load)}) {
+        auto submitted = load->submitted.load(), delivered = load->delivered.load();
+        printf("%-13s async_infer: %lu/%lu callbacks\n", name, delivered, submitted);
+        pass = pass && delivered == submitted;
+    }
+
+    printf("%s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : -1;
+}
@@ -0,0 +1,56 @@
+#include "algo_metrics.h"
+#include "light_glove_algo.h"
+#include <opencv2/videoio.hpp>
+
+// 运动门控: 跳帧率与每帧耗时, 视频流 0 不开启, 视频流 1 开启
+// 用法: sample_motion_gate <video> [frames] [pixel_threshold] [area_threshold]
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        printf("Usage: %s <video> [frames] [pixel_threshold] [area_threshold]\n", argv[0]);
+        return -1;
+    }
+
+    auto num_frames = argc > 2 ? std::stoi(argv[2]) : 500;
+
+    gddi::MotionGateConfig gate;
+    if (argc > 3) { gate.pixel_threshold = std::stoi(argv[3]); }
+    if (argc > 4) { gate.area_threshold = std::stof(argv[4]); }
+
+    gddi::LightGloveAlgoConfig config;
+    config.stream_motion_gates[1] = gate;
+    auto algo = std::make_unique<gddi::LightGloveAlgo>(config);
+
+    std::vector<gddi::ModelConfig> models = {
+        {"light", "../models/light.gdd", "../models/license_light.gdd", 0.3, {"light_on"}},
+        {"person", "../models/person.gdd", "../models/license_person.gdd", 0.8, {"person"}},
+        {"glove", "../models/glove.gdd", "../models/license_glove.gdd", 0.3, {"glove"}}};
+    if (!algo->load_models(models)) {
+        printf("Failed to load models\n");
+        return -1;
+    }
+
+    auto video = cv::VideoCapture(argv[1]);
+    cv::Mat frame;
+    int64_t frame_index = 0;
+    while (frame_index < num_frames && video.read(frame)) {
+        for (int32_t stream_id : {0, 1}) {
+            std::vector<gddi::AlgoObject> objects;
+            algo->sync_infer(stream_id, frame_index, frame, objects);
+        }
+        frame_index++;
+    }
+
+    for (const auto &metric : gddi::get_skip_metrics()) {
+        printf("stream %d: %lu frames, %lu skipped (%.1f%%)\n", metric.stream, metric.frames, metric.skipped,
+               metric.frames > 0 ? 100.0 * metric.skipped / metric.frames : 0.0);
+    }
+
+    // 跳过的帧不计入阶段耗时, 总耗时按帧数平均
+    for (const auto &metric : gddi::get_metrics()) {
+        if (metric.stage != "total") { continue; }
+        printf("stream %d: %lu inferred frames, %.2fms per frame\n", metric.stream, metric.count,
+               frame_index > 0 ? metric.sum_us / 1e3 / frame_index : 0.0);
+    }
+
+    return 0;
+}
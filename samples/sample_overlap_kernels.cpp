@@ -0,0 +1,96 @@
+#include "box_iou.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+// 重叠度矩阵各 SIMD 实现与标量参考实现逐位比较 (不需要设备): 随机框 (含相同、包含、相切、零面积的框),
+// 列数覆盖向量宽度的各种余数, 三种 OverlapMetric, offset 为 0 与 1
+// 用法: sample_overlap_kernels [rounds] [seed]
+
+namespace {
+
+constexpr gddi::OverlapMetric kMetrics[] = {gddi::OverlapMetric::kIoU, gddi::OverlapMetric::kIoUCost,
+                                            gddi::OverlapMetric::kCoverMin};
+constexpr const char *kMetricNames[] = {"iou", "iou_cost", "cover_min"};
+
+// 整数坐标容易出现相切与相同的框, 小数坐标覆盖一般情况
+void random_boxes(std::mt19937 &rng, const size_t count, gddi::BoxArray &boxes) {
+    std::uniform_int_distribution<int> kind(0, 9);
+    std::uniform_real_distribution<float> coord(0, 200);
+    std::uniform_real_distribution<float> extent(0, 80);
+    std::uniform_int_distribution<int> grid(0, 20);
+
+    boxes.clear();
+    for (size_t i = 0; i < count; i++) {
+        auto k = kind(rng);
+        if (k == 0 && i > 0) {
+            // 与前一个框相同
+            auto j = i - 1;
+            boxes.push_back(boxes.x1()[j], boxes.y1()[j], boxes.x2()[j], boxes.y2()[j]);
+        } else if (k == 1) {
+            // 零面积
+            auto x = coord(rng), y = coord(rng);
+            boxes.push_back(x, y, x, y + extent(rng));
+        } else if (k <= 4) {
+            auto x = static_cast<float>(grid(rng) * 10), y = static_cast<float>(grid(rng) * 10);
+            boxes.push_back(x, y, x + (grid(rng) + 1) * 10, y + (grid(rng) + 1) * 10);
+        } else {
+            auto x = coord(rng), y = coord(rng);
+            boxes.push_back(x, y, x + extent(rng), y + extent(rng));
+        }
+    }
+}
+
+}// namespace
+
+int main(int argc, char **argv) {
+    auto rounds = argc > 1 ? std::atoi(argv[1]) : 2000;
+    auto seed = argc > 2 ? static_cast<uint32_t>(std::atoi(argv[2])) : 20261018u;
+
+    auto names = gddi::overlap_kernel_names();
+    printf("overlap_matrix kernel: %s, available:", gddi::overlap_kernel_name());
+    for (auto name : names) { printf(" %s", name); }
+    printf("\n");
+
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<size_t> rows(0, 12);
+    std::uniform_int_distribution<size_t> cols(0, 37);
+
+    gddi::BoxArray a, b;
+    std::vector<float> expected, actual;
+    bool pass = true;
+    for (auto name : names) {
+        uint64_t compared = 0, mismatches = 0;
+        std::mt19937 kernel_rng(seed);
+        for (int round = 0; round < rounds; round++) {
+            random_boxes(kernel_rng, rows(kernel_rng), a);
+            random_boxes(kernel_rng, cols(kernel_rng), b);
+            for (size_t m = 0; m < sizeof(kMetrics) / sizeof(kMetrics[0]); m++) {
+                for (auto offset : {0.0f, 1.0f}) {
+                    expected.assign(a.size() * b.size(), -1);
+                    actual.assign(a.size() * b.size(), -2);
+                    gddi::overlap_matrix_reference(a, b, expected.data(), kMetrics[m], offset);
+                    gddi::overlap_matrix_kernel(name, a, b, actual.data(), kMetrics[m], offset);
+                    compared += expected.size();
+
+                    for (size_t i = 0; i < expected.size(); i++) {
+                        if (std::memcmp(&expected[i], &actual[i], sizeof(float)) == 0) { continue; }
+                        if (mismatches++ < 5) {
+                            auto n = i / b.size(), k = i % b.size();
+                            printf("  %s %s offset %.0f: a[%zu] (%g, %g, %g, %g) b[%zu] (%g, %g, %g, %g) "
+                                   "expected %.9g, got %.9g\n",
+                                   name, kMetricNames[m], offset, n, a.x1()[n], a.y1()[n], a.x2()[n], a.y2()[n], k,
+                                   b.x1()[k], b.y1()[k], b.x2()[k], b.y2()[k], expected[i], actual[i]);
+                        }
+                    }
+                }
+            }
+        }
+        printf("%-6s: %lu values, %lu mismatches\n", name, compared, mismatches);
+        pass = pass && mismatches == 0;
+    }
+
+    printf("%s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : -1;
+}
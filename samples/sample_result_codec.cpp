@@ -0,0 +1,90 @@
+#include "result_codec.h"
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+// 结果编码往返校验 + 吞吐测试 (不需要模型)
+int main() {
+    const int kFrames = 200000;
+    const int kObjects = 16;
+    const char *labels[] = {"person", "smoke", "phone", "no_helmet_head"};
+
+    // 模拟回调结果
+    std::vector<std::vector<gddi::AlgoObject>> frames(64);
+    for (size_t i = 0; i < frames.size(); i++) {
+        for (int j = 0; j < kObjects; j++) {
+            frames[i].push_back(gddi::AlgoObject{j, j % 4, labels[j % 4], 0.5f + j * 0.01f,
+                                                 cv::Rect{int(i) * 3 + j, j * 7, 40 + j, 80 + j}, int(i) * 100 + j});
+        }
+    }
+
+    // 编码到内存
+    std::vector<uint8_t> buffer;
+    auto start = std::chrono::steady_clock::now();
+    {
+        gddi::ResultWriter writer(buffer);
+        for (int i = 0; i < kFrames; i++) { writer.write(i, int64_t(i) * 40000, i % 8, frames[i % frames.size()]); }
+    }
+    auto encode_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // 解码并校验
+    start = std::chrono::steady_clock::now();
+    gddi::ResultReader reader(buffer.data(), buffer.size());
+    gddi::FrameResult frame;
+    int64_t num_frames = 0;
+    int64_t checksum = 0;
+    while (reader.next(frame)) {
+        num_frames++;
+        for (const auto &object : frame.objects) { checksum += object.track_id + object.x; }
+    }
+    auto decode_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (!reader.error().empty() || num_frames != kFrames) {
+        printf("Decode failed: %s, frames: %ld\n", reader.error().c_str(), num_frames);
+        return -1;
+    }
+
+    gddi::ResultReader verifier(buffer.data(), buffer.size());
+    for (int i = 0; verifier.next(frame); i++) {
+        const auto &expected = frames[i % frames.size()];
+        bool same = frame.frame_id == i && frame.timestamp == int64_t(i) * 40000 && frame.stream_id == i % 8
+            && frame.objects.size() == expected.size();
+        for (size_t j = 0; same && j < expected.size(); j++) {
+            const auto &object = frame.objects[j];
+            same = object.target_id == expected[j].target_id && object.class_id == expected[j].class_id
+                && verifier.label(object.label_id) == expected[j].label && object.score == expected[j].score
+                && cv::Rect{object.x, object.y, object.width, object.height} == expected[j].rect
+                && object.track_id == expected[j].track_id;
+        }
+        if (!same) {
+            printf("Round trip mismatch at frame %d\n", i);
+            return -1;
+        }
+    }
+
+    double mb = buffer.size() / 1024.0 / 1024.0;
+    printf("Frames: %d, Objects/frame: %d, Size: %.1f MB (%.1f bytes/frame)\n", kFrames, kObjects, mb,
+           double(buffer.size()) / kFrames);
+    printf("Encode: %.0f frames/s, %.0f MB/s\n", kFrames / encode_time, mb / encode_time);
+    printf("Decode: %.0f frames/s, %.0f MB/s (checksum %ld)\n", kFrames / decode_time, mb / decode_time, checksum);
+
+    // 流式写入文件
+    auto fd = open("results.gdrs", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        printf("Failed to open results.gdrs\n");
+        return -1;
+    }
+    start = std::chrono::steady_clock::now();
+    {
+        gddi::ResultWriter writer(fd);
+        for (int i = 0; i < kFrames; i++) { writer.write(i, int64_t(i) * 40000, i % 8, frames[i % frames.size()]); }
+    }
+    close(fd);
+    auto file_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("Write to file: %.0f frames/s, %.0f MB/s\n", kFrames / file_time, mb / file_time);
+
+    printf("Finished\n");
+
+    return 0;
+}
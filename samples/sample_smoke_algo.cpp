@@ -1,3 +1,4 @@
+#include "algo_metrics.h"
 #include "smoke_algo.h"
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
@@ -52,6 +53,9 @@ int main() {
         frame_index++;
     }
 
+    // 各阶段耗时 (Prometheus 文本格式)
+    printf("%s", gddi::export_prometheus_metrics().c_str());
+
     printf("Finished\n");
 
     return 0;
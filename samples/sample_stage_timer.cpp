@@ -0,0 +1,86 @@
+#include "stage_timer.h"
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// 分阶段计时开销: 每帧 1 次 StageTimer 构造 + 7 次 lap + 析构 (与两阶段算法相同), 对比帧耗时 (不需要模型)
+// 用法: sample_stage_timer [frame_ms] [threads]
+
+namespace {
+
+constexpr int kFrames = 1000000;
+
+// 线程 CPU 时间 (ns), 线程数超过核数时不计入等待调度的时间
+double thread_cpu_ns() {
+    timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+// 每个线程计时 kFrames 帧, 返回每帧平均开销 (ns)
+double run(const int num_threads, const bool shared_stream) {
+    std::vector<std::unique_ptr<gddi::StageMetrics>> metrics;
+    for (int i = 0; i < (shared_stream ? 1 : num_threads); i++) {
+        metrics.emplace_back(std::make_unique<gddi::StageMetrics>("StageTimerBench", shared_stream ? 0 : i + 1));
+    }
+
+    std::vector<double> costs(num_threads);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; i++) {
+        threads.emplace_back([&, i]() {
+            const auto &stream_metrics = *metrics[shared_stream ? 0 : i];
+            auto start = thread_cpu_ns();
+            for (int64_t frame = 0; frame < kFrames; frame++) {
+                gddi::StageTimer timer(stream_metrics, frame);
+                timer.lap(gddi::AlgoStage::kPreprocess);
+                timer.lap(gddi::AlgoStage::kInferStage1);
+                timer.lap(gddi::AlgoStage::kTrack);
+                timer.lap(gddi::AlgoStage::kCrop);
+                timer.lap(gddi::AlgoStage::kInferStage2);
+                timer.lap(gddi::AlgoStage::kStatistic);
+                timer.lap(gddi::AlgoStage::kCallback);
+            }
+            costs[i] = (thread_cpu_ns() - start) / kFrames;
+        });
+    }
+    for (auto &thread : threads) { thread.join(); }
+
+    double total = 0;
+    for (auto cost : costs) { total += cost; }
+    return total / num_threads;
+}
+
+}// namespace
+
+int main(int argc, char **argv) {
+    // 帧耗时取 1080p 两阶段算法中较快的情况, 开销占比按此计算
+    auto frame_ms = argc > 1 ? std::atof(argv[1]) : 10.0;
+    auto num_threads = argc > 2 ? std::atoi(argv[2]) : static_cast<int>(std::thread::hardware_concurrency());
+    if (num_threads < 1) { num_threads = 1; }
+
+    struct Case {
+        const char *name;
+        int threads;
+        bool shared_stream;
+    };
+    const Case cases[] = {
+        {"1 thread", 1, false},
+        {"N threads, one stream each", num_threads, false},
+        {"N threads, same stream", num_threads, true},
+    };
+
+    bool pass = true;
+    for (const auto &item : cases) {
+        auto cost_ns = run(item.threads, item.shared_stream);
+        auto ratio = cost_ns / (frame_ms * 1e6) * 100;
+        pass = pass && ratio < 1.0;
+        printf("%-28s threads: %2d, %7.1f ns/frame, %.4f%% of %.1fms frame\n", item.name, item.threads, cost_ns,
+               ratio, frame_ms);
+    }
+
+    printf("%s: instrumentation overhead %s 1%% of frame time\n", pass ? "PASS" : "FAIL", pass ? "<" : ">=");
+    return pass ? 0 : -1;
+}
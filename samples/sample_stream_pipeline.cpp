@@ -0,0 +1,48 @@
+#include "door_hat_algo.h"
+#include "stream_pipeline.h"
+
+// 解码 → 推理流水线: 每个视频一路视频流, 解码与推理重叠执行
+// 用法: sample_stream_pipeline <video> [video ...]
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        printf("Usage: %s <video> [video ...]\n", argv[0]);
+        return -1;
+    }
+
+    gddi::DoorHatAlgoConfig config;
+    auto door_hat_algo = std::make_unique<gddi::DoorHatAlgo>(config);
+
+    std::vector<gddi::ModelConfig> models = {
+        {"door", "/opt/glasssix/edgebox/cpp/ai-sdk/model/gx_pump_paint_room_door_api_model.gdd", "/opt/glasssix/edgebox/cpp/ai-sdk/license/gx_pump_paint_room_door_api_license", 0.3, {"close"}},
+        {"hat", "/opt/glasssix/edgebox/cpp/ai-sdk/model/gx_pump_protective_hat_api_model.gdd", "/opt/glasssix/edgebox/cpp/ai-sdk/license/gx_pump_protective_hat_api_license", 0.3, {"un_hat"}}};
+    if (!door_hat_algo->load_models(models)) {
+        printf("Failed to load models\n");
+        return -1;
+    }
+
+    // 视频文件按帧率解码模拟实时相机, 推理跟不上时丢帧
+    gddi::StreamPipelineConfig pipeline_config;
+    pipeline_config.realtime = true;
+    gddi::StreamPipeline pipeline(pipeline_config,
+                                  [&](const int32_t stream_id, const int64_t image_id, const cv::Mat &image) {
+                                      std::vector<gddi::AlgoObject> objects;
+                                      door_hat_algo->sync_infer(stream_id, image_id, image, objects);
+                                      if (!objects.empty()) {
+                                          printf("stream %d, frame %ld: %ld objects\n", stream_id, image_id,
+                                                 objects.size());
+                                      }
+                                  });
+
+    for (int i = 1; i < argc; i++) {
+        if (!pipeline.add_source(i - 1, argv[i])) { return -1; }
+    }
+    pipeline.start();
+    pipeline.wait();
+
+    auto stats = pipeline.stats();
+    printf("decoded %lu, dropped %lu, processed %lu\n", stats.decoded, stats.dropped, stats.processed);
+    printf("queue wait p50 %.2fms p99 %.2fms, latency p50 %.2fms p99 %.2fms\n", stats.queue_wait.p50_us / 1e3,
+           stats.queue_wait.p99_us / 1e3, stats.latency.p50_us / 1e3, stats.latency.p99_us / 1e3);
+
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include "algo_metrics.h"
+#include "crop_planner.h"
+#include "sparks_cover_algo.h"
+#include <algorithm>
+#include <opencv2/videoio.hpp>
+
+// 分块推理: 不同分块边长下的分块数与一阶段耗时
+// 用法: sample_tiled_infer <video> [frames] [overlap]
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        printf("Usage: %s <video> [frames] [overlap]\n", argv[0]);
+        return -1;
+    }
+
+    auto num_frames = argc > 2 ? std::stoi(argv[2]) : 50;
+    auto overlap = argc > 3 ? std::stof(argv[3]) : 0.2f;
+
+    // 预先解码, 不计入推理耗时
+    std::vector<cv::Mat> frames;
+    auto video = cv::VideoCapture(argv[1]);
+    cv::Mat frame;
+    while (static_cast<int>(frames.size()) < num_frames && video.read(frame)) { frames.push_back(frame.clone()); }
+    if (frames.empty()) {
+        printf("Failed to read video: %s\n", argv[1]);
+        return -1;
+    }
+
+    auto width = frames[0].cols;
+    auto height = frames[0].rows;
+    printf("%dx%d, %zu frames, overlap %.2f\n", width, height, frames.size(), overlap);
+    printf("%10s %6s %14s %14s %14s\n", "tile_size", "tiles", "preprocess_p50", "stage1_p50", "stage1_p99");
+
+    for (auto tile_size : {0, 1280, 960, 640, 480}) {
+        std::vector<gddi::ModelConfig> models = {
+            {"light", "../models/sparks.gdd", "../models/license_sparks.gdd", 0.3, {"sparks"}},
+            {"person", "../models/person.gdd", "../models/license_person.gdd", 0.6, {"person"}, 4.0f},
+            {"cover", "../models/cover.gdd", "../models/license_cover.gdd", 0.3, {"cover"}, 1.5f}};
+        models[0].tile_size = tile_size;
+        models[0].tile_overlap = overlap;
+
+        auto algo = std::make_unique<gddi::SparksCoverAlgo>(gddi::SparksCoverAlgoConfig{});
+        if (!algo->load_models(models)) {
+            printf("Failed to load models\n");
+            return -1;
+        }
+
+        gddi::reset_metrics();
+        for (size_t i = 0; i < frames.size(); i++) {
+            std::vector<gddi::AlgoObject> objects;
+            algo->sync_infer(i, frames[i], objects);
+        }
+
+        uint64_t preprocess_p50 = 0, stage1_p50 = 0, stage1_p99 = 0;
+        for (const auto &metric : gddi::get_metrics()) {
+            if (metric.algo != "SparksCoverAlgo") { continue; }
+            if (metric.stage == "preprocess") { preprocess_p50 = metric.p50_us; }
+            if (metric.stage == "infer_stage1") {
+                stage1_p50 = metric.p50_us;
+                stage1_p99 = metric.p99_us;
+            }
+        }
+
+        auto tiles = std::max<size_t>(gddi::plan_tiles(width, height, tile_size, overlap).size(), 1);
+        printf("%10d %6zu %12luus %12luus %12luus\n", tile_size, tiles, preprocess_p50, stage1_p50, stage1_p99);
+    }
+
+    return 0;
+}
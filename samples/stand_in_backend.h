@@ -0,0 +1,179 @@
+/**
+ * @file stand_in_backend.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 示例用替身推理后端: CPU 线程 sleep 模拟设备耗时, 每个输入返回固定检测结果
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 by GDDI
+ *
+ */
+
+#pragma once
+
+#include "infer_backend.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <core/result_def.h>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sample {
+
+struct StandInBox {
+    int class_id;
+    const char *label;
+    float score;
+    float x, y, w, h;
+};
+
+inline gddeploy::InferResult make_detect_result(const std::vector<StandInBox> &boxes) {
+    gddeploy::InferResult result;
+    using DetectImg = typename decltype(result.detect_result.detect_imgs)::value_type;
+    using DetectObject = typename decltype(DetectImg::detect_objs)::value_type;
+
+    DetectImg img{};
+    for (const auto &box : boxes) {
+        DetectObject obj{};
+        obj.class_id = box.class_id;
+        obj.label = box.label;
+        obj.score = box.score;
+        obj.bbox.x = box.x;
+        obj.bbox.y = box.y;
+        obj.bbox.w = box.w;
+        obj.bbox.h = box.h;
+        img.detect_objs.emplace_back(std::move(obj));
+    }
+    result.result_type.push_back(gddeploy::GDD_RESULT_TYPE_DETECT);
+    result.detect_result.detect_imgs.emplace_back(std::move(img));
+    return result;
+}
+
+/**
+ * @brief 每次调用 (不论输入数) 耗时 latency_us, 最多 num_workers 个异步调用同时执行, 与设备一次推理一批相同
+ *
+ */
+class StandInBackend : public gddi::InferBackend {
+public:
+    StandInBackend(gddeploy::InferResult result, const uint32_t latency_us, const uint32_t num_workers = 1)
+        : result_(std::move(result)), latency_(std::chrono::microseconds(latency_us)) {
+        for (uint32_t i = 0; i < std::max(num_workers, 1u); i++) {
+            workers_.emplace_back([this]() { run(); });
+        }
+    }
+
+    ~StandInBackend() override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        pending_cv_.notify_all();
+        for (auto &worker : workers_) { worker.join(); }
+    }
+
+    int InferSync(gddeploy::PackagePtr in_package, gddeploy::PackagePtr out_package) override {
+        infer(*in_package, *out_package);
+        return 0;
+    }
+
+    void InferAsync(gddeploy::PackagePtr in_package, gddeploy::InferAsyncCallback callback,
+                    gddeploy::any user_data) override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_.emplace_back(Task{std::move(in_package), std::move(callback), std::move(user_data)});
+            tasks_++;
+        }
+        pending_cv_.notify_one();
+    }
+
+    void WaitTaskDone() override {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_cv_.wait(lock, [this]() { return tasks_ == 0; });
+    }
+
+    uint64_t calls() const { return calls_.load(); }
+    uint64_t inputs() const { return inputs_.load(); }
+    uint32_t max_batch() const { return max_batch_.load(); }
+
+private:
+    struct Task {
+        gddeploy::PackagePtr in_package;
+        gddeploy::InferAsyncCallback callback;
+        gddeploy::any user_data;
+    };
+
+    void infer(const gddeploy::Package &in_package, gddeploy::Package &out_package) {
+        auto count = static_cast<uint32_t>(in_package.data.size());
+        calls_++;
+        inputs_ += count;
+        auto batch = max_batch_.load();
+        while (count > batch && !max_batch_.compare_exchange_weak(batch, count)) {}
+
+        std::this_thread::sleep_for(latency_);
+        if (out_package.data.size() != count) { out_package.data = gddeploy::Package::Create(count)->data; }
+        for (auto &data : out_package.data) { data->SetMetaData(result_); }
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            pending_cv_.wait(lock, [this]() { return stop_ || !pending_.empty(); });
+            if (pending_.empty()) { break; }
+            auto task = std::move(pending_.front());
+            pending_.pop_front();
+            lock.unlock();
+
+            auto out_package = gddeploy::Package::Create(task.in_package->data.size());
+            infer(*task.in_package, *out_package);
+            task.callback(gddeploy::Status::SUCCESS, out_package, task.user_data);
+
+            lock.lock();
+            if (--tasks_ == 0) { idle_cv_.notify_all(); }
+        }
+    }
+
+    const gddeploy::InferResult result_;
+    const std::chrono::microseconds latency_;
+
+    std::atomic<uint64_t> calls_{0};
+    std::atomic<uint64_t> inputs_{0};
+    std::atomic<uint32_t> max_batch_{0};
+
+    std::mutex mutex_;
+    std::condition_variable pending_cv_;
+    std::condition_variable idle_cv_;
+    std::deque<Task> pending_;
+    size_t tasks_{0};
+    bool stop_{false};
+    std::vector<std::thread> workers_;
+};
+
+/**
+ * @brief 多个模型会话共用同一个替身后端, 算法实例析构后仍可读取调用计数
+ *
+ */
+class SharedBackend : public gddi::InferBackend {
+public:
+    explicit SharedBackend(std::shared_ptr<StandInBackend> backend) : backend_(std::move(backend)) {}
+
+    int InferSync(gddeploy::PackagePtr in_package, gddeploy::PackagePtr out_package) override {
+        return backend_->InferSync(in_package, out_package);
+    }
+
+    void InferAsync(gddeploy::PackagePtr in_package, gddeploy::InferAsyncCallback callback,
+                    gddeploy::any user_data) override {
+        backend_->InferAsync(in_package, callback, user_data);
+    }
+
+    void WaitTaskDone() override { backend_->WaitTaskDone(); }
+
+private:
+    std::shared_ptr<StandInBackend> backend_;
+};
+
+}// namespace sample
@@ -0,0 +1,265 @@
+#include "algo_metrics.h"
+#include "stage_timer.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <tuple>
+
+namespace gddi {
+
+namespace {
+
+using HistogramKey = std::tuple<std::string, uint32_t, int32_t>;
+using SkipCounterKey = std::tuple<std::string, std::string, int32_t>;
+using BatchKey = std::pair<std::string, uint32_t>;
+
+struct HistogramRegistry {
+    std::mutex mutex;
+    std::map<HistogramKey, std::unique_ptr<LatencyHistogram>> histograms;
+    std::map<SkipCounterKey, std::unique_ptr<SkipCounter>> skip_counters;
+    std::map<BatchKey, std::unique_ptr<BatchHistograms>> batch_histograms;
+};
+
+HistogramRegistry &registry() {
+    static HistogramRegistry instance;
+    return instance;
+}
+
+std::string escape_label(const std::string &value) {
+    std::string escaped;
+    for (auto ch : value) {
+        if (ch == '\\' || ch == '"') {
+            escaped += '\\';
+            escaped += ch;
+        } else if (ch == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped += ch;
+        }
+    }
+    return escaped;
+}
+
+}// namespace
+
+const char *algo_stage_name(AlgoStage stage) {
+    switch (stage) {
+        case AlgoStage::kPreprocess: return "preprocess";
+        case AlgoStage::kInferStage1: return "infer_stage1";
+        case AlgoStage::kTrack: return "track";
+        case AlgoStage::kCrop: return "crop";
+        case AlgoStage::kInferStage2: return "infer_stage2";
+        case AlgoStage::kInferStage3: return "infer_stage3";
+        case AlgoStage::kStatistic: return "statistic";
+        case AlgoStage::kCallback: return "callback";
+        case AlgoStage::kTotal: return "total";
+        default: return "unknown";
+    }
+}
+
+LatencyHistogram *register_latency_histogram(const std::string &algo, AlgoStage stage, int32_t stream) {
+    auto &instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+
+    auto &histogram = instance.histograms[HistogramKey{algo, static_cast<uint32_t>(stage), stream}];
+    if (!histogram) { histogram = std::make_unique<LatencyHistogram>(); }
+    return histogram.get();
+}
+
+SkipCounter *register_skip_counter(const std::string &algo, const std::string &gate, int32_t stream) {
+    auto &instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+
+    auto &counter = instance.skip_counters[SkipCounterKey{algo, gate, stream}];
+    if (!counter) { counter = std::make_unique<SkipCounter>(); }
+    return counter.get();
+}
+
+void fill_latency_metric(const LatencyHistogram &histogram, LatencyMetric &metric) {
+    metric.count = histogram.count();
+    metric.sum_us = histogram.sum();
+    metric.min_us = histogram.min();
+    metric.max_us = histogram.max();
+    metric.p50_us = histogram.percentile(0.5);
+    metric.p90_us = histogram.percentile(0.9);
+    metric.p99_us = histogram.percentile(0.99);
+
+    metric.buckets.clear();
+    for (uint32_t i = 0; i < LatencyHistogram::kBucketCount; i++) {
+        auto count = histogram.bucket_count(i);
+        if (count > 0) { metric.buckets.emplace_back(LatencyHistogram::bucket_upper_bound(i), count); }
+    }
+}
+
+BatchHistograms *register_batch_histograms(const std::string &algo, uint32_t model) {
+    auto &instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+
+    auto &histograms = instance.batch_histograms[BatchKey{algo, model}];
+    if (!histograms) { histograms = std::make_unique<BatchHistograms>(); }
+    return histograms.get();
+}
+
+std::vector<LatencyMetric> get_metrics() {
+    auto &instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+
+    std::vector<LatencyMetric> metrics;
+    for (const auto &[key, histogram] : instance.histograms) {
+        if (histogram->count() == 0) { continue; }
+
+        LatencyMetric metric;
+        metric.algo = std::get<0>(key);
+        metric.stage = algo_stage_name(static_cast<AlgoStage>(std::get<1>(key)));
+        metric.stream = std::get<2>(key);
+        fill_latency_metric(*histogram, metric);
+        metrics.emplace_back(std::move(metric));
+    }
+
+    return metrics;
+}
+
+std::vector<SkipMetric> get_skip_metrics() {
+    auto &instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+
+    std::vector<SkipMetric> metrics;
+    for (const auto &[key, counter] : instance.skip_counters) {
+        SkipMetric metric;
+        metric.algo = std::get<0>(key);
+        metric.gate = std::get<1>(key);
+        metric.stream = std::get<2>(key);
+        metric.frames = counter->frames.load(std::memory_order_relaxed);
+        metric.skipped = counter->skipped.load(std::memory_order_relaxed);
+        metrics.emplace_back(std::move(metric));
+    }
+
+    return metrics;
+}
+
+std::vector<BatchMetric> get_batch_metrics() {
+    auto &instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+
+    std::vector<BatchMetric> metrics;
+    for (const auto &[key, histograms] : instance.batch_histograms) {
+        BatchMetric metric;
+        metric.algo = key.first;
+        metric.model = key.second;
+        const auto &sizes = histograms->batch_size;
+        for (uint32_t size = 0; size < sizes.batches.size(); size++) {
+            auto count = sizes.batches[size].load(std::memory_order_relaxed);
+            if (count == 0) { continue; }
+            metric.batches += count;
+            metric.batch_sizes.emplace_back(size, count);
+        }
+        metric.inputs = sizes.inputs.load(std::memory_order_relaxed);
+        metric.max_batch_size = sizes.max.load(std::memory_order_relaxed);
+
+        metric.queue_delay.algo = key.first;
+        metric.queue_delay.stage = "batch_queue";
+        fill_latency_metric(histograms->queue_delay, metric.queue_delay);
+        metrics.emplace_back(std::move(metric));
+    }
+
+    return metrics;
+}
+
+std::string export_prometheus_metrics() {
+    std::ostringstream stream;
+    stream << "# HELP gddi_algo_stage_latency_seconds Per-stage latency of gddi algorithms.\n";
+    stream << "# TYPE gddi_algo_stage_latency_seconds summary\n";
+
+    for (const auto &metric : get_metrics()) {
+        std::ostringstream labels;
+        labels << "algo=\"" << escape_label(metric.algo) << "\",stage=\"" << metric.stage << "\",stream=\""
+               << metric.stream << "\"";
+
+        for (const auto &[quantile, value] : {std::make_pair("0.5", metric.p50_us), std::make_pair("0.9", metric.p90_us),
+                                              std::make_pair("0.99", metric.p99_us)}) {
+            stream << "gddi_algo_stage_latency_seconds{" << labels.str() << ",quantile=\"" << quantile << "\"} "
+                   << value / 1e6 << "\n";
+        }
+        stream << "gddi_algo_stage_latency_seconds_sum{" << labels.str() << "} " << metric.sum_us / 1e6 << "\n";
+        stream << "gddi_algo_stage_latency_seconds_count{" << labels.str() << "} " << metric.count << "\n";
+    }
+
+    // 同一指标的样本需要连续输出
+    struct SkipFamily {
+        const char *name;
+        const char *help;
+        uint64_t SkipMetric::*value;
+    };
+    auto skip_metrics = get_skip_metrics();
+    for (const auto &family :
+         {SkipFamily{"gddi_algo_gated_frames_total", "Frames checked by inference gates.", &SkipMetric::frames},
+          SkipFamily{"gddi_algo_skipped_frames_total", "Frames skipped by inference gates.", &SkipMetric::skipped}}) {
+        if (skip_metrics.empty()) { break; }
+        stream << "# HELP " << family.name << " " << family.help << "\n";
+        stream << "# TYPE " << family.name << " counter\n";
+        for (const auto &metric : skip_metrics) {
+            stream << family.name << "{algo=\"" << escape_label(metric.algo) << "\",gate=\""
+                   << escape_label(metric.gate) << "\",stream=\"" << metric.stream << "\"} "
+                   << metric.*family.value << "\n";
+        }
+    }
+
+    // 合批: 每批输入数 (histogram, 桶上界为输入数) 与排队时间
+    auto batch_metrics = get_batch_metrics();
+    if (!batch_metrics.empty()) {
+        constexpr const char *kBatchSize = "gddi_algo_batch_size";
+        stream << "# HELP " << kBatchSize << " Inputs per cross-stream batch.\n";
+        stream << "# TYPE " << kBatchSize << " histogram\n";
+        for (const auto &batch : batch_metrics) {
+            std::ostringstream labels;
+            labels << "algo=\"" << escape_label(batch.algo) << "\",model=\"" << batch.model << "\"";
+
+            // 超过 64 的批计入 64, 64 以上只输出 +Inf
+            auto size = batch.batch_sizes.begin();
+            uint64_t accumulated = 0;
+            for (uint32_t le = 1; le <= 32; le *= 2) {
+                for (; size != batch.batch_sizes.end() && size->first <= le; ++size) { accumulated += size->second; }
+                stream << kBatchSize << "_bucket{" << labels.str() << ",le=\"" << le << "\"} " << accumulated << "\n";
+            }
+            stream << kBatchSize << "_bucket{" << labels.str() << ",le=\"+Inf\"} " << batch.batches << "\n";
+            stream << kBatchSize << "_sum{" << labels.str() << "} " << batch.inputs << "\n";
+            stream << kBatchSize << "_count{" << labels.str() << "} " << batch.batches << "\n";
+        }
+
+        constexpr const char *kBatchQueue = "gddi_algo_batch_queue_seconds";
+        stream << "# HELP " << kBatchQueue << " Time a request waited for its batch.\n";
+        stream << "# TYPE " << kBatchQueue << " summary\n";
+        for (const auto &batch : batch_metrics) {
+            const auto &metric = batch.queue_delay;
+            std::ostringstream labels;
+            labels << "algo=\"" << escape_label(batch.algo) << "\",model=\"" << batch.model << "\"";
+            for (const auto &[quantile, value] :
+                 {std::make_pair("0.5", metric.p50_us), std::make_pair("0.9", metric.p90_us),
+                  std::make_pair("0.99", metric.p99_us)}) {
+                stream << kBatchQueue << "{" << labels.str() << ",quantile=\"" << quantile << "\"} " << value / 1e6
+                       << "\n";
+            }
+            stream << kBatchQueue << "_sum{" << labels.str() << "} " << metric.sum_us / 1e6 << "\n";
+            stream << kBatchQueue << "_count{" << labels.str() << "} " << metric.count << "\n";
+        }
+    }
+
+    return stream.str();
+}
+
+void reset_metrics() {
+    auto &instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+    for (auto &[_, histogram] : instance.histograms) { histogram->reset(); }
+    for (auto &[_, counter] : instance.skip_counters) {
+        counter->frames.store(0, std::memory_order_relaxed);
+        counter->skipped.store(0, std::memory_order_relaxed);
+    }
+    for (auto &[_, histograms] : instance.batch_histograms) {
+        histograms->batch_size.reset();
+        histograms->queue_delay.reset();
+    }
+}
+
+}// namespace gddi
@@ -0,0 +1,230 @@
+#include "box_iou.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#define GDDI_OVERLAP_NEON
+#elif defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+#include <immintrin.h>
+#define GDDI_OVERLAP_SSE2
+#if defined(__GNUC__)
+#define GDDI_OVERLAP_AVX
+#endif
+#endif
+
+// 标量与向量实现逐位一致的前提: 运算顺序相同, 且不能被编译器合并为 FMA
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace gddi {
+
+namespace {
+
+// 与原 BYTETracker::ious 运算顺序相同: 宽高为 (min - max) + offset, 并集为 (area_a + area_b) - inter
+inline float overlap_value(const float ax1, const float ay1, const float ax2, const float ay2, const float area_a,
+                           const float bx1, const float by1, const float bx2, const float by2,
+                           const OverlapMetric metric, const float offset) {
+    float value = 0;
+    float iw = std::min(ax2, bx2) - std::max(ax1, bx1) + offset;
+    float ih = std::min(ay2, by2) - std::max(ay1, by1) + offset;
+    if (iw > 0 && ih > 0) {
+        float area_b = (bx2 - bx1 + offset) * (by2 - by1 + offset);
+        float inter = iw * ih;
+        value = metric == OverlapMetric::kCoverMin ? inter / std::min(area_a, area_b)
+                                                   : inter / (area_a + area_b - inter);
+    }
+    return metric == OverlapMetric::kIoUCost ? 1 - value : value;
+}
+
+// 第 n 行, 从第 begin 列开始 (向量实现的尾部)
+inline void overlap_row_scalar(const BoxArray &a, const BoxArray &b, float *row, const size_t n, const size_t begin,
+                               const OverlapMetric metric, const float offset) {
+    auto ax1 = a.x1()[n], ay1 = a.y1()[n], ax2 = a.x2()[n], ay2 = a.y2()[n];
+    auto area_a = (ax2 - ax1 + offset) * (ay2 - ay1 + offset);
+    for (size_t k = begin; k < b.size(); k++) {
+        row[k] = overlap_value(ax1, ay1, ax2, ay2, area_a, b.x1()[k], b.y1()[k], b.x2()[k], b.y2()[k], metric, offset);
+    }
+}
+
+void overlap_scalar(const BoxArray &a, const BoxArray &b, float *out, const OverlapMetric metric,
+                    const float offset) {
+    for (size_t n = 0; n < a.size(); n++) { overlap_row_scalar(a, b, out + n * b.size(), n, 0, metric, offset); }
+}
+
+#if defined(GDDI_OVERLAP_NEON)
+void overlap_neon(const BoxArray &a, const BoxArray &b, float *out, const OverlapMetric metric, const float offset) {
+    const auto voffset = vdupq_n_f32(offset);
+    const auto vzero = vdupq_n_f32(0);
+    const auto vone = vdupq_n_f32(1);
+    const auto cols = b.size() & ~size_t(3);
+
+    for (size_t n = 0; n < a.size(); n++) {
+        auto *row = out + n * b.size();
+        auto ax1 = vdupq_n_f32(a.x1()[n]), ay1 = vdupq_n_f32(a.y1()[n]);
+        auto ax2 = vdupq_n_f32(a.x2()[n]), ay2 = vdupq_n_f32(a.y2()[n]);
+        auto area_a = vmulq_f32(vaddq_f32(vsubq_f32(ax2, ax1), voffset), vaddq_f32(vsubq_f32(ay2, ay1), voffset));
+
+        for (size_t k = 0; k < cols; k += 4) {
+            auto bx1 = vld1q_f32(b.x1() + k), by1 = vld1q_f32(b.y1() + k);
+            auto bx2 = vld1q_f32(b.x2() + k), by2 = vld1q_f32(b.y2() + k);
+
+            auto iw = vaddq_f32(vsubq_f32(vminq_f32(ax2, bx2), vmaxq_f32(ax1, bx1)), voffset);
+            auto ih = vaddq_f32(vsubq_f32(vminq_f32(ay2, by2), vmaxq_f32(ay1, by1)), voffset);
+            auto mask = vandq_u32(vcgtq_f32(iw, vzero), vcgtq_f32(ih, vzero));
+
+            auto area_b = vmulq_f32(vaddq_f32(vsubq_f32(bx2, bx1), voffset), vaddq_f32(vsubq_f32(by2, by1), voffset));
+            auto inter = vmulq_f32(iw, ih);
+            auto denom = metric == OverlapMetric::kCoverMin ? vminq_f32(area_a, area_b)
+                                                            : vsubq_f32(vaddq_f32(area_a, area_b), inter);
+            auto value = vreinterpretq_f32_u32(vandq_u32(mask, vreinterpretq_u32_f32(vdivq_f32(inter, denom))));
+            if (metric == OverlapMetric::kIoUCost) { value = vsubq_f32(vone, value); }
+            vst1q_f32(row + k, value);
+        }
+
+        overlap_row_scalar(a, b, row, n, cols, metric, offset);
+    }
+}
+#endif
+
+#if defined(GDDI_OVERLAP_SSE2)
+void overlap_sse2(const BoxArray &a, const BoxArray &b, float *out, const OverlapMetric metric, const float offset) {
+    const auto voffset = _mm_set1_ps(offset);
+    const auto vzero = _mm_setzero_ps();
+    const auto vone = _mm_set1_ps(1);
+    const auto cols = b.size() & ~size_t(3);
+
+    for (size_t n = 0; n < a.size(); n++) {
+        auto *row = out + n * b.size();
+        auto ax1 = _mm_set1_ps(a.x1()[n]), ay1 = _mm_set1_ps(a.y1()[n]);
+        auto ax2 = _mm_set1_ps(a.x2()[n]), ay2 = _mm_set1_ps(a.y2()[n]);
+        auto area_a = _mm_mul_ps(_mm_add_ps(_mm_sub_ps(ax2, ax1), voffset), _mm_add_ps(_mm_sub_ps(ay2, ay1), voffset));
+
+        for (size_t k = 0; k < cols; k += 4) {
+            auto bx1 = _mm_loadu_ps(b.x1() + k), by1 = _mm_loadu_ps(b.y1() + k);
+            auto bx2 = _mm_loadu_ps(b.x2() + k), by2 = _mm_loadu_ps(b.y2() + k);
+
+            auto iw = _mm_add_ps(_mm_sub_ps(_mm_min_ps(ax2, bx2), _mm_max_ps(ax1, bx1)), voffset);
+            auto ih = _mm_add_ps(_mm_sub_ps(_mm_min_ps(ay2, by2), _mm_max_ps(ay1, by1)), voffset);
+            auto mask = _mm_and_ps(_mm_cmpgt_ps(iw, vzero), _mm_cmpgt_ps(ih, vzero));
+
+            auto area_b =
+                _mm_mul_ps(_mm_add_ps(_mm_sub_ps(bx2, bx1), voffset), _mm_add_ps(_mm_sub_ps(by2, by1), voffset));
+            auto inter = _mm_mul_ps(iw, ih);
+            auto denom = metric == OverlapMetric::kCoverMin ? _mm_min_ps(area_a, area_b)
+                                                            : _mm_sub_ps(_mm_add_ps(area_a, area_b), inter);
+            auto value = _mm_and_ps(mask, _mm_div_ps(inter, denom));
+            if (metric == OverlapMetric::kIoUCost) { value = _mm_sub_ps(vone, value); }
+            _mm_storeu_ps(row + k, value);
+        }
+
+        overlap_row_scalar(a, b, row, n, cols, metric, offset);
+    }
+}
+#endif
+
+#if defined(GDDI_OVERLAP_AVX)
+// 只用到浮点运算, AVX 即可, 不要求 AVX2
+__attribute__((target("avx"))) void overlap_avx(const BoxArray &a, const BoxArray &b, float *out,
+                                                const OverlapMetric metric, const float offset) {
+    const auto voffset = _mm256_set1_ps(offset);
+    const auto vzero = _mm256_setzero_ps();
+    const auto vone = _mm256_set1_ps(1);
+    const auto cols = b.size() & ~size_t(7);
+
+    for (size_t n = 0; n < a.size(); n++) {
+        auto *row = out + n * b.size();
+        auto ax1 = _mm256_set1_ps(a.x1()[n]), ay1 = _mm256_set1_ps(a.y1()[n]);
+        auto ax2 = _mm256_set1_ps(a.x2()[n]), ay2 = _mm256_set1_ps(a.y2()[n]);
+        auto area_a = _mm256_mul_ps(_mm256_add_ps(_mm256_sub_ps(ax2, ax1), voffset),
+                                    _mm256_add_ps(_mm256_sub_ps(ay2, ay1), voffset));
+
+        for (size_t k = 0; k < cols; k += 8) {
+            auto bx1 = _mm256_loadu_ps(b.x1() + k), by1 = _mm256_loadu_ps(b.y1() + k);
+            auto bx2 = _mm256_loadu_ps(b.x2() + k), by2 = _mm256_loadu_ps(b.y2() + k);
+
+            auto iw = _mm256_add_ps(_mm256_sub_ps(_mm256_min_ps(ax2, bx2), _mm256_max_ps(ax1, bx1)), voffset);
+            auto ih = _mm256_add_ps(_mm256_sub_ps(_mm256_min_ps(ay2, by2), _mm256_max_ps(ay1, by1)), voffset);
+            auto mask = _mm256_and_ps(_mm256_cmp_ps(iw, vzero, _CMP_GT_OQ), _mm256_cmp_ps(ih, vzero, _CMP_GT_OQ));
+
+            auto area_b = _mm256_mul_ps(_mm256_add_ps(_mm256_sub_ps(bx2, bx1), voffset),
+                                        _mm256_add_ps(_mm256_sub_ps(by2, by1), voffset));
+            auto inter = _mm256_mul_ps(iw, ih);
+            auto denom = metric == OverlapMetric::kCoverMin ? _mm256_min_ps(area_a, area_b)
+                                                            : _mm256_sub_ps(_mm256_add_ps(area_a, area_b), inter);
+            auto value = _mm256_and_ps(mask, _mm256_div_ps(inter, denom));
+            if (metric == OverlapMetric::kIoUCost) { value = _mm256_sub_ps(vone, value); }
+            _mm256_storeu_ps(row + k, value);
+        }
+
+        overlap_row_scalar(a, b, row, n, cols, metric, offset);
+    }
+}
+#endif
+
+struct OverlapKernel {
+    const char *name;
+    void (*func)(const BoxArray &, const BoxArray &, float *, const OverlapMetric, const float);
+};
+
+// 本机可用的实现, 按优先级排列, 标量实现在最后
+std::vector<OverlapKernel> available_kernels() {
+    std::vector<OverlapKernel> kernels;
+#if defined(GDDI_OVERLAP_NEON)
+    kernels.push_back({"neon", overlap_neon});
+#endif
+#if defined(GDDI_OVERLAP_AVX)
+    if (__builtin_cpu_supports("avx")) { kernels.push_back({"avx", overlap_avx}); }
+#endif
+#if defined(GDDI_OVERLAP_SSE2)
+    kernels.push_back({"sse2", overlap_sse2});
+#endif
+    kernels.push_back({"scalar", overlap_scalar});
+    return kernels;
+}
+
+const std::vector<OverlapKernel> &kernels() {
+    static const std::vector<OverlapKernel> instance = available_kernels();
+    return instance;
+}
+
+const OverlapKernel &kernel() {
+    static const OverlapKernel &instance = kernels().front();
+    return instance;
+}
+
+}// namespace
+
+void overlap_matrix(const BoxArray &a, const BoxArray &b, float *out, const OverlapMetric metric,
+                    const float offset) {
+    kernel().func(a, b, out, metric, offset);
+}
+
+void overlap_matrix_reference(const BoxArray &a, const BoxArray &b, float *out, const OverlapMetric metric,
+                              const float offset) {
+    overlap_scalar(a, b, out, metric, offset);
+}
+
+const char *overlap_kernel_name() { return kernel().name; }
+
+std::vector<const char *> overlap_kernel_names() {
+    std::vector<const char *> names;
+    for (const auto &item : kernels()) { names.push_back(item.name); }
+    return names;
+}
+
+bool overlap_matrix_kernel(const char *kernel_name, const BoxArray &a, const BoxArray &b, float *out,
+                           const OverlapMetric metric, const float offset) {
+    for (const auto &item : kernels()) {
+        if (std::strcmp(item.name, kernel_name) == 0) {
+            item.func(a, b, out, metric, offset);
+            return true;
+        }
+    }
+    return false;
+}
+
+}// namespace gddi
@@ -0,0 +1,111 @@
+/**
+ * @file box_iou.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 框重叠度矩阵 (IoU / 跟踪代价 / 覆盖率), SIMD 实现
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 by GDDI
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <opencv2/core/mat.hpp>
+#include <vector>
+
+namespace gddi {
+
+/**
+ * @brief 框数组, 按坐标分量分别存储 (SoA), 坐标为左上角 (x1, y1) 与右下角 (x2, y2)
+ *
+ */
+class BoxArray {
+public:
+    void reserve(const size_t size) {
+        x1_.reserve(size);
+        y1_.reserve(size);
+        x2_.reserve(size);
+        y2_.reserve(size);
+    }
+
+    void clear() {
+        x1_.clear();
+        y1_.clear();
+        x2_.clear();
+        y2_.clear();
+    }
+
+    size_t size() const { return x1_.size(); }
+
+    void push_back(const float x1, const float y1, const float x2, const float y2) {
+        x1_.push_back(x1);
+        y1_.push_back(y1);
+        x2_.push_back(x2);
+        y2_.push_back(y2);
+    }
+
+    void push_back(const cv::Rect &rect) {
+        push_back(rect.x, rect.y, rect.x + rect.width, rect.y + rect.height);
+    }
+
+    const float *x1() const { return x1_.data(); }
+    const float *y1() const { return y1_.data(); }
+    const float *x2() const { return x2_.data(); }
+    const float *y2() const { return y2_.data(); }
+
+private:
+    std::vector<float> x1_, y1_, x2_, y2_;
+};
+
+enum class OverlapMetric {
+    kIoU,     // 交并比
+    kIoUCost, // 1 - 交并比 (跟踪匹配代价)
+    kCoverMin,// 交集 / 较小框面积 (同 area_cover_rate)
+};
+
+/**
+ * @brief 计算 a.size() x b.size() 的重叠度矩阵, 行优先写入 out
+ *
+ * 运行时按 CPU 选择实现 (aarch64: NEON, x86: AVX / SSE2, 其他: 标量), 各实现结果逐位一致
+ *
+ * @param offset 宽高补偿, 像素包含式坐标 (ByteTrack tlbr) 为 1, cv::Rect 为 0
+ */
+void overlap_matrix(const BoxArray &a, const BoxArray &b, float *out, const OverlapMetric metric,
+                    const float offset = 0);
+
+inline void overlap_matrix(const BoxArray &a, const BoxArray &b, std::vector<float> &out,
+                           const OverlapMetric metric, const float offset = 0) {
+    out.resize(a.size() * b.size());
+    overlap_matrix(a, b, out.data(), metric, offset);
+}
+
+/**
+ * @brief 标量实现, 用于校验 SIMD 实现
+ *
+ */
+void overlap_matrix_reference(const BoxArray &a, const BoxArray &b, float *out, const OverlapMetric metric,
+                              const float offset = 0);
+
+/**
+ * @brief 当前使用的实现名称 ("neon", "avx", "sse2", "scalar")
+ *
+ */
+const char *overlap_kernel_name();
+
+/**
+ * @brief 本机可用的全部实现名称, 按优先级排列 (第一个为 overlap_matrix 使用的实现), 用于逐一校验
+ *
+ */
+std::vector<const char *> overlap_kernel_names();
+
+/**
+ * @brief 用指定实现计算重叠度矩阵, 参数同 overlap_matrix
+ *
+ * @return bool 本机没有该实现时返回 false
+ */
+bool overlap_matrix_kernel(const char *kernel_name, const BoxArray &a, const BoxArray &b, float *out,
+                           const OverlapMetric metric, const float offset = 0);
+
+}// namespace gddi
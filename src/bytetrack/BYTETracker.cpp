@@ -1,4 +1,5 @@
 #include "BYTETracker.h"
+#include "../frame_trace.h"
 #include <fstream>
 
 BYTETracker::BYTETracker(const float track_thres, const float high_thresh, const float match_thresh,
@@ -8,6 +9,7 @@ BYTETracker::BYTETracker(const float track_thres, const float high_thresh, const
 	this->match_thresh = match_thresh;
 
 	this->frame_id = 0;
+	this->track_id_count = 0;
 	this->max_time_lost = track_buffer;
 }
 
@@ -17,6 +19,7 @@ BYTETracker::~BYTETracker()
 
 vector<STrack> BYTETracker::update(const vector<Object>& objects)
 {
+	GDDI_TRACE_SCOPE("tracker_update");
 
 	////////////////// Step 1: Get detections //////////////////
 	this->frame_id++;
@@ -41,8 +44,7 @@ vector<STrack> BYTETracker::update(const vector<Object>& objects)
 	{
 		for (int i = 0; i < objects.size(); i++)
 		{
-			vector<float> tlbr_;
-			tlbr_.resize(4);
+			std::array<float, 4> tlbr_;
 			tlbr_[0] = objects[i].rect.x;
 			tlbr_[1] = objects[i].rect.y;
 			tlbr_[2] = objects[i].rect.x + objects[i].rect.width;
@@ -95,7 +97,7 @@ vector<STrack> BYTETracker::update(const vector<Object>& objects)
 		}
 		else
 		{
-			track->re_activate(*det, this->frame_id, false);
+			track->re_activate(*det, this->frame_id);
 			refind_stracks.push_back(*track);
 		}
 	}
@@ -135,7 +137,7 @@ vector<STrack> BYTETracker::update(const vector<Object>& objects)
 		}
 		else
 		{
-			track->re_activate(*det, this->frame_id, false);
+			track->re_activate(*det, this->frame_id);
 			refind_stracks.push_back(*track);
 		}
 	}
@@ -181,7 +183,7 @@ vector<STrack> BYTETracker::update(const vector<Object>& objects)
 		STrack *track = &detections[u_detection[i]];
 		if (track->score < this->high_thresh)
 			continue;
-		track->activate(this->kalman_filter, this->frame_id);
+		track->activate(this->kalman_filter, this->frame_id, ++this->track_id_count);
 		activated_stracks.push_back(*track);
 	}
 
@@ -7,7 +7,7 @@ struct Object {
     int class_id;
     float prob;
     cv::Rect_<float> rect;
-    std::string label_name;
+    gddi::Label label_name;
     std::array<int, 4> color;
 };
 
@@ -42,6 +42,7 @@ private:
     float high_thresh;
     float match_thresh;
     int frame_id;
+    int track_id_count;// 跟踪ID按跟踪器 (单路视频流) 独立递增
     int max_time_lost;
 
     vector<STrack> tracked_stracks;
@@ -1,18 +1,14 @@
 #include "STrack.h"
 #include <thread>
 
-STrack::STrack(vector<float> tlwh_, float score, int class_id, int target_id,  std::string label_name, std::array<int, 4> color)
+STrack::STrack(const std::array<float, 4> &tlwh_, float score, int class_id, int target_id, gddi::Label label_name, std::array<int, 4> color)
 {
-	_tlwh.resize(4);
-	_tlwh.assign(tlwh_.begin(), tlwh_.end());
+	_tlwh = tlwh_;
 
 	is_activated = false;
 	track_id = 0;
 	state = TrackState::New;
 	
-	tlwh.resize(4);
-	tlbr.resize(4);
-
 	static_tlwh();
 	static_tlbr();
 	frame_id = 0;
@@ -29,17 +25,12 @@ STrack::~STrack()
 {
 }
 
-void STrack::activate(byte_kalman::KalmanFilter &kalman_filter, int frame_id)
+void STrack::activate(byte_kalman::KalmanFilter &kalman_filter, int frame_id, int track_id)
 {
 	this->kalman_filter = kalman_filter;
-	this->track_id = this->next_id();
-
-	vector<float> _tlwh_tmp(4);
-	_tlwh_tmp[0] = this->_tlwh[0];
-	_tlwh_tmp[1] = this->_tlwh[1];
-	_tlwh_tmp[2] = this->_tlwh[2];
-	_tlwh_tmp[3] = this->_tlwh[3];
-	vector<float> xyah = tlwh_to_xyah(_tlwh_tmp);
+	this->track_id = track_id;
+
+	std::array<float, 4> xyah = tlwh_to_xyah(this->_tlwh);
 	DETECTBOX xyah_box;
 	xyah_box[0] = xyah[0];
 	xyah_box[1] = xyah[1];
@@ -63,9 +54,9 @@ void STrack::activate(byte_kalman::KalmanFilter &kalman_filter, int frame_id)
 	this->start_frame = frame_id;
 }
 
-void STrack::re_activate(STrack &new_track, int frame_id, bool new_id)
+void STrack::re_activate(STrack &new_track, int frame_id, int new_track_id)
 {
-	vector<float> xyah = tlwh_to_xyah(new_track.tlwh);
+	std::array<float, 4> xyah = tlwh_to_xyah(new_track.tlwh);
 	DETECTBOX xyah_box;
 	xyah_box[0] = xyah[0];
 	xyah_box[1] = xyah[1];
@@ -87,8 +78,8 @@ void STrack::re_activate(STrack &new_track, int frame_id, bool new_id)
 	this->label_name= new_track.label_name;
 	this->color = new_track.color;
 	this->score = new_track.score;
-	if (new_id)
-		this->track_id = next_id();
+	if (new_track_id > 0)
+		this->track_id = new_track_id;
 }
 
 void STrack::update(STrack &new_track, int frame_id)
@@ -96,7 +87,7 @@ void STrack::update(STrack &new_track, int frame_id)
 	this->frame_id = frame_id;
 	this->tracklet_len++;
 
-	vector<float> xyah = tlwh_to_xyah(new_track.tlwh);
+	std::array<float, 4> xyah = tlwh_to_xyah(new_track.tlwh);
 	DETECTBOX xyah_box;
 	xyah_box[0] = xyah[0];
 	xyah_box[1] = xyah[1];
@@ -143,27 +134,26 @@ void STrack::static_tlwh()
 
 void STrack::static_tlbr()
 {
-	tlbr.clear();
-	tlbr.assign(tlwh.begin(), tlwh.end());
+	tlbr = tlwh;
 	tlbr[2] += tlbr[0];
 	tlbr[3] += tlbr[1];
 }
 
-vector<float> STrack::tlwh_to_xyah(vector<float> tlwh_tmp)
+std::array<float, 4> STrack::tlwh_to_xyah(std::array<float, 4> tlwh_tmp)
 {
-	vector<float> tlwh_output = tlwh_tmp;
+	std::array<float, 4> tlwh_output = tlwh_tmp;
 	tlwh_output[0] += tlwh_output[2] / 2;
 	tlwh_output[1] += tlwh_output[3] / 2;
 	tlwh_output[2] /= tlwh_output[3];
 	return tlwh_output;
 }
 
-vector<float> STrack::to_xyah()
+std::array<float, 4> STrack::to_xyah()
 {
 	return tlwh_to_xyah(tlwh);
 }
 
-vector<float> STrack::tlbr_to_tlwh(vector<float> &tlbr)
+std::array<float, 4> STrack::tlbr_to_tlwh(std::array<float, 4> &tlbr)
 {
 	tlbr[2] -= tlbr[0];
 	tlbr[3] -= tlbr[1];
@@ -180,13 +170,6 @@ void STrack::mark_removed()
 	state = TrackState::Removed;
 }
 
-int STrack::next_id()
-{
-	static thread_local int _count = 0;
-	_count++;
-	return _count;
-}
-
 int STrack::end_frame()
 {
 	return this->frame_id;
@@ -1,54 +1,56 @@
-#pragma once
-
-#include <opencv2/opencv.hpp>
-#include "kalmanFilter.h"
-
-using namespace cv;
-using namespace std;
-
-enum TrackState { New = 0, Tracked, Lost, Removed };
-
-class STrack
-{
-public:
-	STrack(vector<float> tlwh_, float score, int class_id, int target_id, std::string label_name, std::array<int, 4> color);
-	~STrack();
-
-	vector<float> static tlbr_to_tlwh(vector<float> &tlbr);
-	void static multi_predict(vector<STrack*> &stracks, byte_kalman::KalmanFilter &kalman_filter);
-	void static_tlwh();
-	void static_tlbr();
-	vector<float> tlwh_to_xyah(vector<float> tlwh_tmp);
-	vector<float> to_xyah();
-	void mark_lost();
-	void mark_removed();
-	int next_id();
-	int end_frame();
-	
-	void activate(byte_kalman::KalmanFilter &kalman_filter, int frame_id);
-	void re_activate(STrack &new_track, int frame_id, bool new_id = false);
-	void update(STrack &new_track, int frame_id);
-
-public:
-	bool is_activated;
-	int track_id;
-	int target_id;
-	int class_id;
-	std::string label_name;
-	std::array<int, 4> color;
-	int state;
-
-	vector<float> _tlwh;
-	vector<float> tlwh;
-	vector<float> tlbr;
-	int frame_id;
-	int tracklet_len;
-	int start_frame;
-
-	KAL_MEAN mean;
-	KAL_COVA covariance;
-	float score;
-
-private:
-	byte_kalman::KalmanFilter kalman_filter;
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include "kalmanFilter.h"
+#include "label_registry.h"
+#include <array>
+
+using namespace cv;
+using namespace std;
+
+enum TrackState { New = 0, Tracked, Lost, Removed };
+
+class STrack
+{
+public:
+	STrack(const std::array<float, 4> &tlwh_, float score, int class_id, int target_id, gddi::Label label_name, std::array<int, 4> color);
+	~STrack();
+
+	std::array<float, 4> static tlbr_to_tlwh(std::array<float, 4> &tlbr);
+	void static multi_predict(vector<STrack*> &stracks, byte_kalman::KalmanFilter &kalman_filter);
+	void static_tlwh();
+	void static_tlbr();
+	std::array<float, 4> tlwh_to_xyah(std::array<float, 4> tlwh_tmp);
+	std::array<float, 4> to_xyah();
+	void mark_lost();
+	void mark_removed();
+	int end_frame();
+	
+	void activate(byte_kalman::KalmanFilter &kalman_filter, int frame_id, int track_id);
+	void re_activate(STrack &new_track, int frame_id, int new_track_id = 0);
+	void update(STrack &new_track, int frame_id);
+
+public:
+	bool is_activated;
+	int track_id;
+	int target_id;
+	int class_id;
+	gddi::Label label_name;
+	std::array<int, 4> color;
+	int state;
+
+	// 定长数组, 复制 STrack 不分配内存
+	std::array<float, 4> _tlwh;
+	std::array<float, 4> tlwh;
+	std::array<float, 4> tlbr;
+	int frame_id;
+	int tracklet_len;
+	int start_frame;
+
+	KAL_MEAN mean;
+	KAL_COVA covariance;
+	float score;
+
+private:
+	byte_kalman::KalmanFilter kalman_filter;
 };
\ No newline at end of file
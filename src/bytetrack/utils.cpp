@@ -1,6 +1,43 @@
 #include "BYTETracker.h"
+#include "../box_iou.h"
 #include "lapjv.h"
 
+static void tlbr_boxes(const vector<STrack> &tracks, gddi::BoxArray &boxes)
+{
+	boxes.reserve(tracks.size());
+	for (auto &track : tracks)
+	{
+		boxes.push_back(track.tlbr[0], track.tlbr[1], track.tlbr[2], track.tlbr[3]);
+	}
+}
+
+static void tlbr_boxes(const vector<STrack*> &tracks, gddi::BoxArray &boxes)
+{
+	boxes.reserve(tracks.size());
+	for (auto *track : tracks)
+	{
+		boxes.push_back(track->tlbr[0], track->tlbr[1], track->tlbr[2], track->tlbr[3]);
+	}
+}
+
+// tlbr 为像素包含式坐标, 宽高 +1; 代价矩阵按行拆分给 lapjv
+static vector<vector<float> > iou_cost_rows(const gddi::BoxArray &aboxes, const gddi::BoxArray &bboxes)
+{
+	vector<vector<float> > cost_matrix;
+	if (aboxes.size() * bboxes.size() == 0)
+		return cost_matrix;
+
+	vector<float> cost;
+	gddi::overlap_matrix(aboxes, bboxes, cost, gddi::OverlapMetric::kIoUCost, 1);
+
+	cost_matrix.resize(aboxes.size());
+	for (int i = 0; i < cost_matrix.size(); i++)
+	{
+		cost_matrix[i].assign(cost.begin() + i * bboxes.size(), cost.begin() + (i + 1) * bboxes.size());
+	}
+	return cost_matrix;
+}
+
 vector<STrack*> BYTETracker::joint_stracks(vector<STrack*> &tlista, vector<STrack> &tlistb)
 {
 	map<int, int> exists;
@@ -71,13 +108,18 @@ vector<STrack> BYTETracker::sub_stracks(vector<STrack> &tlista, vector<STrack> &
 
 void BYTETracker::remove_duplicate_stracks(vector<STrack> &resa, vector<STrack> &resb, vector<STrack> &stracksa, vector<STrack> &stracksb)
 {
-	vector<vector<float> > pdist = iou_distance(stracksa, stracksb);
+	gddi::BoxArray aboxes, bboxes;
+	tlbr_boxes(stracksa, aboxes);
+	tlbr_boxes(stracksb, bboxes);
+
+	vector<float> pdist;
+	gddi::overlap_matrix(aboxes, bboxes, pdist, gddi::OverlapMetric::kIoUCost, 1);
 	vector<pair<int, int> > pairs;
-	for (int i = 0; i < pdist.size(); i++)
+	for (int i = 0; i < stracksa.size(); i++)
 	{
-		for (int j = 0; j < pdist[i].size(); j++)
+		for (int j = 0; j < stracksb.size(); j++)
 		{
-			if (pdist[i][j] < 0.15)
+			if (pdist[i * stracksb.size() + j] < 0.15)
 			{
 				pairs.push_back(pair<int, int>(i, j));
 			}
@@ -162,38 +204,26 @@ vector<vector<float> > BYTETracker::ious(vector<vector<float> > &atlbrs, vector<
 	if (atlbrs.size()*btlbrs.size() == 0)
 		return ious;
 
-	ious.resize(atlbrs.size());
-	for (int i = 0; i < ious.size(); i++)
+	gddi::BoxArray aboxes, bboxes;
+	aboxes.reserve(atlbrs.size());
+	for (auto &tlbr : atlbrs)
+	{
+		aboxes.push_back(tlbr[0], tlbr[1], tlbr[2], tlbr[3]);
+	}
+	bboxes.reserve(btlbrs.size());
+	for (auto &tlbr : btlbrs)
 	{
-		ious[i].resize(btlbrs.size());
+		bboxes.push_back(tlbr[0], tlbr[1], tlbr[2], tlbr[3]);
 	}
 
 	//bbox_ious
-	for (int k = 0; k < btlbrs.size(); k++)
+	vector<float> values;
+	gddi::overlap_matrix(aboxes, bboxes, values, gddi::OverlapMetric::kIoU, 1);
+
+	ious.resize(atlbrs.size());
+	for (int i = 0; i < ious.size(); i++)
 	{
-		vector<float> ious_tmp;
-		float box_area = (btlbrs[k][2] - btlbrs[k][0] + 1)*(btlbrs[k][3] - btlbrs[k][1] + 1);
-		for (int n = 0; n < atlbrs.size(); n++)
-		{
-			float iw = min(atlbrs[n][2], btlbrs[k][2]) - max(atlbrs[n][0], btlbrs[k][0]) + 1;
-			if (iw > 0)
-			{
-				float ih = min(atlbrs[n][3], btlbrs[k][3]) - max(atlbrs[n][1], btlbrs[k][1]) + 1;
-				if(ih > 0)
-				{
-					float ua = (atlbrs[n][2] - atlbrs[n][0] + 1)*(atlbrs[n][3] - atlbrs[n][1] + 1) + box_area - iw * ih;
-					ious[n][k] = iw * ih / ua;
-				}
-				else
-				{
-					ious[n][k] = 0.0;
-				}
-			}
-			else
-			{
-				ious[n][k] = 0.0;
-			}
-		}
+		ious[i].assign(values.begin() + i * btlbrs.size(), values.begin() + (i + 1) * btlbrs.size());
 	}
 
 	return ious;
@@ -201,66 +231,21 @@ vector<vector<float> > BYTETracker::ious(vector<vector<float> > &atlbrs, vector<
 
 vector<vector<float> > BYTETracker::iou_distance(vector<STrack*> &atracks, vector<STrack> &btracks, int &dist_size, int &dist_size_size)
 {
-	vector<vector<float> > cost_matrix;
-	if (atracks.size() * btracks.size() == 0)
-	{
-		dist_size = atracks.size();
-		dist_size_size = btracks.size();
-		return cost_matrix;
-	}
-	vector<vector<float> > atlbrs, btlbrs;
-	for (int i = 0; i < atracks.size(); i++)
-	{
-		atlbrs.push_back(atracks[i]->tlbr);
-	}
-	for (int i = 0; i < btracks.size(); i++)
-	{
-		btlbrs.push_back(btracks[i].tlbr);
-	}
-
 	dist_size = atracks.size();
 	dist_size_size = btracks.size();
 
-	vector<vector<float> > _ious = ious(atlbrs, btlbrs);
-	
-	for (int i = 0; i < _ious.size();i++)
-	{
-		vector<float> _iou;
-		for (int j = 0; j < _ious[i].size(); j++)
-		{
-			_iou.push_back(1 - _ious[i][j]);
-		}
-		cost_matrix.push_back(_iou);
-	}
-
-	return cost_matrix;
+	gddi::BoxArray aboxes, bboxes;
+	tlbr_boxes(atracks, aboxes);
+	tlbr_boxes(btracks, bboxes);
+	return iou_cost_rows(aboxes, bboxes);
 }
 
 vector<vector<float> > BYTETracker::iou_distance(vector<STrack> &atracks, vector<STrack> &btracks)
 {
-	vector<vector<float> > atlbrs, btlbrs;
-	for (int i = 0; i < atracks.size(); i++)
-	{
-		atlbrs.push_back(atracks[i].tlbr);
-	}
-	for (int i = 0; i < btracks.size(); i++)
-	{
-		btlbrs.push_back(btracks[i].tlbr);
-	}
-
-	vector<vector<float> > _ious = ious(atlbrs, btlbrs);
-	vector<vector<float> > cost_matrix;
-	for (int i = 0; i < _ious.size(); i++)
-	{
-		vector<float> _iou;
-		for (int j = 0; j < _ious[i].size(); j++)
-		{
-			_iou.push_back(1 - _ious[i][j]);
-		}
-		cost_matrix.push_back(_iou);
-	}
-
-	return cost_matrix;
+	gddi::BoxArray aboxes, bboxes;
+	tlbr_boxes(atracks, aboxes);
+	tlbr_boxes(btracks, bboxes);
+	return iou_cost_rows(aboxes, bboxes);
 }
 
 double BYTETracker::lapjv(const vector<vector<float> > &cost, vector<int> &rowsol, vector<int> &colsol,
@@ -0,0 +1,462 @@
+#include "capture_log.h"
+#include "spdlog/spdlog.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace gddi {
+
+namespace {
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "capture log assumes a little-endian host");
+
+constexpr uint32_t kFileMagic = 0x4c434447;  // "GDCL"
+constexpr uint32_t kRecordMagic = 0x52434447;// "GDCR"
+constexpr uint16_t kCaptureVersion = 1;
+
+// 文件按该粒度扩大, 减少 ftruncate/mremap 次数
+constexpr size_t kGrowSize = 16 * 1024 * 1024;
+
+enum RecordType : uint16_t {
+    kAlgo = 1,
+    kResult = 2,
+    kIndex = 3,
+};
+
+enum RecordFlags : uint16_t {
+    kNoResult = 1,// 模型没有输出
+};
+
+struct FileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint64_t index_offset;
+};
+
+struct RecordHeader {
+    uint32_t magic;
+    uint16_t type;
+    uint16_t flags;
+    uint32_t size;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(FileHeader) == 16, "unexpected FileHeader layout");
+static_assert(sizeof(RecordHeader) == 16, "unexpected RecordHeader layout");
+static_assert(sizeof(CaptureKey) == 24, "unexpected CaptureKey layout");
+
+inline size_t align8(const size_t size) { return (size + 7) & ~size_t(7); }
+
+class ByteWriter {
+public:
+    explicit ByteWriter(std::vector<uint8_t> &buffer) : buffer_(buffer) {}
+
+    template <typename T>
+    void put(const T value) {
+        auto bytes = reinterpret_cast<const uint8_t *>(&value);
+        buffer_.insert(buffer_.end(), bytes, bytes + sizeof(T));
+    }
+
+    void put(const std::string &value) {
+        put(static_cast<uint32_t>(value.size()));
+        buffer_.insert(buffer_.end(), value.begin(), value.end());
+    }
+
+private:
+    std::vector<uint8_t> &buffer_;
+};
+
+class ByteReader {
+public:
+    ByteReader(const uint8_t *data, const size_t size) : data_(data), size_(size) {}
+
+    template <typename T>
+    bool get(T &value) {
+        if (size_ - offset_ < sizeof(T)) { return false; }
+        std::memcpy(&value, data_ + offset_, sizeof(T));
+        offset_ += sizeof(T);
+        return true;
+    }
+
+    bool get(std::string &value) {
+        uint32_t length;
+        if (!get(length) || size_ - offset_ < length) { return false; }
+        value.assign(reinterpret_cast<const char *>(data_ + offset_), length);
+        offset_ += length;
+        return true;
+    }
+
+    // 元素个数上限为剩余字节数, 防止损坏数据导致超大分配
+    bool get_count(uint32_t &count) { return get(count) && count <= size_ - offset_; }
+
+private:
+    const uint8_t *data_;
+    size_t size_;
+    size_t offset_{0};
+};
+
+// 只序列化 SDK 后处理用到的字段
+void serialize(const gddeploy::InferResult &result, std::vector<uint8_t> &buffer) {
+    ByteWriter writer(buffer);
+
+    writer.put(static_cast<uint32_t>(result.result_type.size()));
+    for (auto type : result.result_type) { writer.put(static_cast<int32_t>(type)); }
+
+    writer.put(static_cast<uint32_t>(result.detect_result.detect_imgs.size()));
+    for (const auto &img : result.detect_result.detect_imgs) {
+        writer.put(static_cast<uint32_t>(img.detect_objs.size()));
+        for (const auto &obj : img.detect_objs) {
+            writer.put(static_cast<int32_t>(obj.class_id));
+            writer.put(static_cast<float>(obj.score));
+            writer.put(static_cast<float>(obj.bbox.x));
+            writer.put(static_cast<float>(obj.bbox.y));
+            writer.put(static_cast<float>(obj.bbox.w));
+            writer.put(static_cast<float>(obj.bbox.h));
+            writer.put(obj.label);
+        }
+    }
+
+    writer.put(static_cast<uint32_t>(result.classify_result.detect_imgs.size()));
+    for (const auto &img : result.classify_result.detect_imgs) {
+        writer.put(static_cast<uint32_t>(img.detect_objs.size()));
+        for (const auto &obj : img.detect_objs) {
+            writer.put(static_cast<int32_t>(obj.class_id));
+            writer.put(static_cast<float>(obj.score));
+            writer.put(obj.label);
+        }
+    }
+}
+
+bool deserialize(const uint8_t *data, const size_t size, gddeploy::InferResult &result) {
+    using ResultType = typename decltype(result.result_type)::value_type;
+    using DetectImg = typename decltype(result.detect_result.detect_imgs)::value_type;
+    using DetectObject = typename decltype(DetectImg::detect_objs)::value_type;
+    using ClassifyImg = typename decltype(result.classify_result.detect_imgs)::value_type;
+    using ClassifyObject = typename decltype(ClassifyImg::detect_objs)::value_type;
+
+    ByteReader reader(data, size);
+    uint32_t count;
+    int32_t value;
+
+    if (!reader.get_count(count)) { return false; }
+    for (uint32_t i = 0; i < count; i++) {
+        if (!reader.get(value)) { return false; }
+        result.result_type.push_back(static_cast<ResultType>(value));
+    }
+
+    if (!reader.get_count(count)) { return false; }
+    for (uint32_t i = 0; i < count; i++) {
+        DetectImg img{};
+        uint32_t num_objs;
+        if (!reader.get_count(num_objs)) { return false; }
+        for (uint32_t j = 0; j < num_objs; j++) {
+            DetectObject obj{};
+            float score, x, y, w, h;
+            if (!reader.get(value) || !reader.get(score) || !reader.get(x) || !reader.get(y) || !reader.get(w)
+                || !reader.get(h) || !reader.get(obj.label)) {
+                return false;
+            }
+            obj.class_id = value;
+            obj.score = score;
+            obj.bbox.x = x;
+            obj.bbox.y = y;
+            obj.bbox.w = w;
+            obj.bbox.h = h;
+            img.detect_objs.emplace_back(std::move(obj));
+        }
+        result.detect_result.detect_imgs.emplace_back(std::move(img));
+    }
+
+    if (!reader.get_count(count)) { return false; }
+    for (uint32_t i = 0; i < count; i++) {
+        ClassifyImg img{};
+        uint32_t num_objs;
+        if (!reader.get_count(num_objs)) { return false; }
+        for (uint32_t j = 0; j < num_objs; j++) {
+            ClassifyObject obj{};
+            float score;
+            if (!reader.get(value) || !reader.get(score) || !reader.get(obj.label)) { return false; }
+            obj.class_id = value;
+            obj.score = score;
+            img.detect_objs.emplace_back(std::move(obj));
+        }
+        result.classify_result.detect_imgs.emplace_back(std::move(img));
+    }
+
+    return true;
+}
+
+}// namespace
+
+uint32_t capture_algo_id(const char *algo) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (auto c = algo; *c; ++c) {
+        hash ^= static_cast<uint8_t>(*c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+CaptureWriter::~CaptureWriter() { close(); }
+
+bool CaptureWriter::open(const std::string &path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) {
+        spdlog::error("Failed to open capture log {}: {}", path, std::strerror(errno));
+        return false;
+    }
+
+    size_ = 0;
+    if (!reserve(sizeof(FileHeader))) { return false; }
+
+    FileHeader header{kFileMagic, kCaptureVersion, 0, 0};
+    std::memcpy(data_, &header, sizeof(header));
+    size_ = sizeof(header);
+    return true;
+}
+
+void CaptureWriter::append(const char *algo, const CaptureKey &key, const gddeploy::InferResult *result) {
+    thread_local std::vector<uint8_t> buffer;
+    buffer.clear();
+
+    // 序列化不持锁
+    ByteWriter writer(buffer);
+    writer.put(key);
+    if (result) { serialize(*result, buffer); }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fd_ < 0) { return; }
+
+    auto inserted = algos_.emplace(key.algo_id, algo);
+    if (inserted.second) {
+        std::vector<uint8_t> algo_record;
+        ByteWriter algo_writer(algo_record);
+        algo_writer.put(key.algo_id);
+        algo_writer.put(inserted.first->second);
+        write_record(kAlgo, 0, algo_record.data(), algo_record.size());
+    }
+
+    index_.push_back(IndexEntry{key, size_});
+    write_record(kResult, result ? 0 : kNoResult, buffer.data(), buffer.size());
+}
+
+void CaptureWriter::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fd_ < 0) { return; }
+
+    // 索引: 条目数 + 条目 + 算法表
+    std::vector<uint8_t> buffer;
+    ByteWriter writer(buffer);
+    writer.put(static_cast<uint32_t>(index_.size()));
+    for (const auto &entry : index_) {
+        writer.put(entry.key);
+        writer.put(entry.offset);
+    }
+    writer.put(static_cast<uint32_t>(algos_.size()));
+    for (const auto &algo : algos_) {
+        writer.put(algo.first);
+        writer.put(algo.second);
+    }
+
+    auto index_offset = size_;
+    write_record(kIndex, 0, buffer.data(), buffer.size());
+    if (fd_ < 0) { return; }
+
+    reinterpret_cast<FileHeader *>(data_)->index_offset = index_offset;
+    munmap(data_, mapped_);
+    if (ftruncate(fd_, size_) != 0) { spdlog::error("Failed to truncate capture log: {}", std::strerror(errno)); }
+    ::close(fd_);
+
+    fd_ = -1;
+    data_ = nullptr;
+    mapped_ = 0;
+    index_.clear();
+    algos_.clear();
+}
+
+bool CaptureWriter::reserve(const size_t size) {
+    if (size <= mapped_) { return true; }
+
+    auto mapped = (size + kGrowSize - 1) / kGrowSize * kGrowSize;
+    if (ftruncate(fd_, mapped) != 0) {
+        spdlog::error("Failed to grow capture log: {}", std::strerror(errno));
+        return false;
+    }
+
+    auto data = data_ ? mremap(data_, mapped_, mapped, MREMAP_MAYMOVE)
+                      : mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (data == MAP_FAILED) {
+        spdlog::error("Failed to map capture log: {}", std::strerror(errno));
+        return false;
+    }
+
+    data_ = static_cast<uint8_t *>(data);
+    mapped_ = mapped;
+    return true;
+}
+
+void CaptureWriter::write_record(const uint16_t type, const uint16_t flags, const void *data, const size_t size) {
+    auto record_size = align8(sizeof(RecordHeader) + size);
+    if (!reserve(size_ + record_size)) {
+        // 映射失败后停止录制, 已写入的数据保留
+        if (data_) { munmap(data_, mapped_); }
+        if (ftruncate(fd_, size_) != 0) { spdlog::error("Failed to truncate capture log"); }
+        ::close(fd_);
+        fd_ = -1;
+        data_ = nullptr;
+        mapped_ = 0;
+        return;
+    }
+
+    RecordHeader header{kRecordMagic, type, flags, static_cast<uint32_t>(record_size), 0};
+    std::memcpy(data_ + size_, &header, sizeof(header));
+    std::memcpy(data_ + size_ + sizeof(header), data, size);
+    std::memset(data_ + size_ + sizeof(header) + size, 0, record_size - sizeof(header) - size);
+    size_ += record_size;
+}
+
+CaptureReader::~CaptureReader() {
+    if (data_) { munmap(const_cast<uint8_t *>(data_), size_); }
+    if (fd_ >= 0) { ::close(fd_); }
+}
+
+bool CaptureReader::open(const std::string &path) {
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        spdlog::error("Failed to open capture log {}: {}", path, std::strerror(errno));
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd_, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(FileHeader)) {
+        spdlog::error("Invalid capture log: {}", path);
+        return false;
+    }
+
+    size_ = st.st_size;
+    auto data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (data == MAP_FAILED) {
+        spdlog::error("Failed to map capture log {}: {}", path, std::strerror(errno));
+        data_ = nullptr;
+        return false;
+    }
+    data_ = static_cast<const uint8_t *>(data);
+
+    FileHeader header;
+    std::memcpy(&header, data_, sizeof(header));
+    if (header.magic != kFileMagic || header.version > kCaptureVersion) {
+        spdlog::error("Unsupported capture log: {}", path);
+        return false;
+    }
+
+    if (!load_index(header.index_offset)) {
+        spdlog::warn("Capture log {} has no valid index, scanning records", path);
+        index_.clear();
+        order_.clear();
+        algos_.clear();
+        scan_records();
+    }
+
+    return true;
+}
+
+bool CaptureReader::find(const CaptureKey &key, gddeploy::InferResult &result, bool &has_result) const {
+    auto iter = index_.find(key);
+    if (iter == index_.end()) { return false; }
+
+    RecordHeader header;
+    std::memcpy(&header, data_ + iter->second, sizeof(header));
+    if (header.magic != kRecordMagic || header.type != kResult
+        || header.size < sizeof(RecordHeader) + sizeof(CaptureKey) || header.size > size_ - iter->second) {
+        return false;
+    }
+    has_result = (header.flags & kNoResult) == 0;
+    if (!has_result) { return true; }
+
+    auto payload = data_ + iter->second + sizeof(RecordHeader) + sizeof(CaptureKey);
+    auto payload_size = header.size - sizeof(RecordHeader) - sizeof(CaptureKey);
+    return deserialize(payload, payload_size, result);
+}
+
+std::vector<CapturedFrame> CaptureReader::frames() const {
+    std::vector<CapturedFrame> frames;
+    for (const auto &key : order_) {
+        if (key.model_index != 0 || key.call_index != 0) { continue; }
+
+        auto iter = algos_.find(key.algo_id);
+        frames.emplace_back(CapturedFrame{iter != algos_.end() ? iter->second : "", key.stream_id, key.frame_id});
+    }
+    return frames;
+}
+
+bool CaptureReader::load_index(const uint64_t index_offset) {
+    if (index_offset == 0 || index_offset > size_ - sizeof(RecordHeader)) { return false; }
+
+    RecordHeader header;
+    std::memcpy(&header, data_ + index_offset, sizeof(header));
+    if (header.magic != kRecordMagic || header.type != kIndex || header.size > size_ - index_offset) { return false; }
+
+    ByteReader reader(data_ + index_offset + sizeof(RecordHeader), header.size - sizeof(RecordHeader));
+    uint32_t count;
+    if (!reader.get_count(count)) { return false; }
+
+    index_.reserve(count);
+    order_.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        CaptureKey key;
+        uint64_t offset;
+        if (!reader.get(key) || !reader.get(offset)) { return false; }
+        if (offset < sizeof(FileHeader) || offset > index_offset - sizeof(RecordHeader)) { return false; }
+
+        index_.emplace(key, offset);
+        order_.push_back(key);
+    }
+
+    if (!reader.get_count(count)) { return false; }
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t algo_id;
+        std::string name;
+        if (!reader.get(algo_id) || !reader.get(name)) { return false; }
+        algos_[algo_id] = name;
+    }
+
+    return true;
+}
+
+void CaptureReader::scan_records() {
+    uint64_t offset = sizeof(FileHeader);
+    while (offset + sizeof(RecordHeader) <= size_) {
+        RecordHeader header;
+        std::memcpy(&header, data_ + offset, sizeof(header));
+        if (header.magic != kRecordMagic || header.size < sizeof(RecordHeader) || header.size % 8 != 0
+            || header.size > size_ - offset) {
+            // 进程异常退出时最后一条记录可能不完整
+            break;
+        }
+
+        auto payload = data_ + offset + sizeof(RecordHeader);
+        auto payload_size = header.size - sizeof(RecordHeader);
+        if (header.type == kAlgo) {
+            ByteReader reader(payload, payload_size);
+            uint32_t algo_id;
+            std::string name;
+            if (reader.get(algo_id) && reader.get(name)) { algos_[algo_id] = name; }
+        } else if (header.type == kResult && payload_size >= sizeof(CaptureKey)) {
+            CaptureKey key;
+            std::memcpy(&key, payload, sizeof(key));
+            index_.emplace(key, offset);
+            order_.push_back(key);
+        }
+
+        offset += header.size;
+    }
+}
+
+}// namespace gddi
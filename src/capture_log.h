@@ -0,0 +1,140 @@
+/**
+ * @file capture_log.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 模型原始输出日志 (内存映射, 追加写入, 带索引)
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 by GDDI
+ *
+ * 文件格式 (小端, 记录 8 字节对齐):
+ *   FileHeader {magic "GDCL", version, index_offset}, index_offset 在关闭时写入, 为 0 表示没有索引
+ *   RecordHeader {magic, type, flags, size (含头和填充)} + 记录内容, 依次追加:
+ *     kAlgo:   算法ID -> 算法名, 算法首次出现时写入
+ *     kResult: CaptureKey + InferResult 序列化数据
+ *     kIndex:  关闭时写入, (CaptureKey, 记录偏移) 列表 + 算法表
+ * 没有索引 (进程异常退出) 时顺序扫描记录重建索引和算法表, 截断的最后一条记录被忽略.
+ */
+
+#pragma once
+
+#include "capture_replay.h"
+#include <core/result_def.h>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gddi {
+
+struct CaptureKey {
+    uint32_t algo_id;// 算法名哈希, 见 capture_algo_id()
+    uint16_t model_index;
+    uint16_t call_index;// 帧内 (当前阶段) 第几次模型调用
+    int32_t stream_id;
+    uint32_t reserved;
+    int64_t frame_id;
+
+    bool operator==(const CaptureKey &other) const {
+        return algo_id == other.algo_id && model_index == other.model_index && call_index == other.call_index
+            && stream_id == other.stream_id && frame_id == other.frame_id;
+    }
+};
+
+struct CaptureKeyHash {
+    size_t operator()(const CaptureKey &key) const {
+        auto model = (uint64_t(key.algo_id) << 32) | (uint64_t(key.model_index) << 16) | key.call_index;
+        auto hash = std::hash<int64_t>()(key.frame_id);
+        hash ^= std::hash<uint64_t>()(model) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+        hash ^= std::hash<int32_t>()(key.stream_id) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+        return hash;
+    }
+};
+
+uint32_t capture_algo_id(const char *algo);
+
+/**
+ * @brief 追加写入, 多线程安全
+ *
+ */
+class CaptureWriter {
+public:
+    CaptureWriter() = default;
+    ~CaptureWriter();
+
+    CaptureWriter(const CaptureWriter &) = delete;
+    CaptureWriter &operator=(const CaptureWriter &) = delete;
+
+    bool open(const std::string &path);
+
+    /**
+     * @brief 追加一次模型调用的输出
+     *
+     * @param result 为 nullptr 表示模型没有输出
+     */
+    void append(const char *algo, const CaptureKey &key, const gddeploy::InferResult *result);
+
+    /**
+     * @brief 写入索引, 截断文件到实际大小并关闭, 之后的 append 被忽略
+     *
+     */
+    void close();
+
+private:
+    bool reserve(const size_t size);
+    void write_record(const uint16_t type, const uint16_t flags, const void *data, const size_t size);
+
+    std::mutex mutex_;
+    int fd_{-1};
+    uint8_t *data_{nullptr};
+    size_t mapped_{0};
+    size_t size_{0};
+
+    struct IndexEntry {
+        CaptureKey key;
+        uint64_t offset;
+    };
+    std::vector<IndexEntry> index_;
+    std::unordered_map<uint32_t, std::string> algos_;
+};
+
+/**
+ * @brief 只读映射整个文件, 按 CaptureKey 查找
+ *
+ */
+class CaptureReader {
+public:
+    CaptureReader() = default;
+    ~CaptureReader();
+
+    CaptureReader(const CaptureReader &) = delete;
+    CaptureReader &operator=(const CaptureReader &) = delete;
+
+    bool open(const std::string &path);
+
+    /**
+     * @brief 查找并反序列化
+     *
+     * @param has_result 录制时模型是否有输出
+     * @return false 日志中没有该次调用
+     */
+    bool find(const CaptureKey &key, gddeploy::InferResult &result, bool &has_result) const;
+
+    std::vector<CapturedFrame> frames() const;
+
+private:
+    bool load_index(const uint64_t index_offset);
+    void scan_records();
+
+    int fd_{-1};
+    const uint8_t *data_{nullptr};
+    size_t size_{0};
+
+    std::unordered_map<CaptureKey, uint64_t, CaptureKeyHash> index_;
+    std::vector<CaptureKey> order_;
+    std::unordered_map<uint32_t, std::string> algos_;
+};
+
+}// namespace gddi
@@ -0,0 +1,167 @@
+#include "crop_planner.h"
+#include "frame_arena.h"
+#include "region_mask.h"
+#include "utils.h"
+
+namespace gddi {
+
+std::vector<CropGroup> coalesce_crops(const int img_w, const int img_h, const std::vector<cv::Rect> &crops,
+                                      const float merge_ratio) {
+    std::vector<CropGroup> groups;
+    groups.reserve(crops.size());
+    for (uint32_t i = 0; i < crops.size(); i++) { groups.emplace_back(CropGroup{crops[i], {i}}); }
+    if (merge_ratio <= 0 || groups.size() < 2) { return groups; }
+
+    // 裁剪数不超过 max_crop_number, 逐对比较即可
+    std::vector<cv::Rect> bounds(crops);
+    while (groups.size() > 1) {
+        size_t best_i = 0, best_j = 0;
+        double best_ratio = merge_ratio;
+        for (size_t i = 0; i < groups.size(); i++) {
+            for (size_t j = i + 1; j < groups.size(); j++) {
+                auto ratio = double((bounds[i] | bounds[j]).area()) / (bounds[i].area() + bounds[j].area());
+                if (ratio <= best_ratio) {
+                    best_ratio = ratio;
+                    best_i = i;
+                    best_j = j;
+                }
+            }
+        }
+        if (best_i == best_j) { break; }
+
+        bounds[best_i] |= bounds[best_j];
+        auto &members = groups[best_i].members;
+        members.insert(members.end(), groups[best_j].members.begin(), groups[best_j].members.end());
+        std::sort(members.begin(), members.end());
+        bounds.erase(bounds.begin() + best_j);
+        groups.erase(groups.begin() + best_j);
+    }
+
+    for (size_t i = 0; i < groups.size(); i++) {
+        if (groups[i].members.size() > 1) { groups[i].rect = scale_crop_rect(img_w, img_h, bounds[i]); }
+    }
+
+    // 合并后首成员仍是组内最小序号, 组的相对顺序不变
+    return groups;
+}
+
+std::vector<CropBatch> pack_crops(const std::vector<CropGroup> &groups, const int atlas_size) {
+    std::vector<CropBatch> batches;
+    std::vector<uint32_t> small_groups;
+    for (uint32_t i = 0; i < groups.size(); i++) {
+        auto &rect = groups[i].rect;
+        if (atlas_size > 0 && rect.width <= atlas_size / 2 && rect.height <= atlas_size / 2) {
+            small_groups.push_back(i);
+        } else {
+            batches.emplace_back(CropBatch{cv::Size(), {CropTile{i, cv::Rect(cv::Point(), rect.size())}}});
+        }
+    }
+
+    if (small_groups.size() == 1) {
+        auto index = small_groups[0];
+        auto &rect = groups[index].rect;
+        batches.emplace_back(CropBatch{cv::Size(), {CropTile{index, cv::Rect(cv::Point(), rect.size())}}});
+    }
+    if (small_groups.size() < 2) { return batches; }
+
+    std::stable_sort(small_groups.begin(), small_groups.end(), [&groups](const uint32_t a, const uint32_t b) {
+        return groups[a].rect.height > groups[b].rect.height;
+    });
+
+    // 每张画布只保留当前 shelf: 高度降序放置, 之前的 shelf 不会再放得下
+    struct Shelf {
+        int x{0}, y{0}, height{0};
+    };
+    auto first_atlas = batches.size();
+    std::vector<Shelf> shelves;
+    for (auto index : small_groups) {
+        auto size = groups[index].rect.size();
+
+        size_t atlas = first_atlas;
+        for (; atlas < batches.size(); atlas++) {
+            auto &shelf = shelves[atlas - first_atlas];
+            if (shelf.x + size.width > atlas_size) {
+                if (shelf.y + shelf.height + size.height > atlas_size) { continue; }
+                shelf = Shelf{0, shelf.y + shelf.height, size.height};
+            }
+            break;
+        }
+        if (atlas == batches.size()) {
+            batches.emplace_back(CropBatch{cv::Size(atlas_size, atlas_size), {}});
+            shelves.emplace_back(Shelf{0, 0, size.height});
+        }
+
+        auto &shelf = shelves[atlas - first_atlas];
+        batches[atlas].tiles.emplace_back(CropTile{index, cv::Rect(shelf.x, shelf.y, size.width, size.height)});
+        shelf.x += size.width;
+    }
+
+    // 只放了一个裁剪的画布退回单独推理
+    for (size_t i = first_atlas; i < batches.size(); i++) {
+        if (batches[i].tiles.size() == 1) {
+            batches[i].canvas = cv::Size();
+            batches[i].tiles[0].rect.x = 0;
+            batches[i].tiles[0].rect.y = 0;
+        }
+    }
+
+    return batches;
+}
+
+cv::Mat compose_crops(const cv::Mat &image, const std::vector<CropGroup> &groups, const CropBatch &batch) {
+    if (batch.canvas.empty()) { return image(groups[batch.tiles[0].group].rect).clone(); }
+
+    cv::Mat canvas(batch.canvas.height, batch.canvas.width, image.type(), cv::Scalar(0, 0, 0));
+    for (const auto &tile : batch.tiles) {
+        cv::Mat roi = canvas(tile.rect);
+        image(groups[tile.group].rect).copyTo(roi);
+    }
+    return canvas;
+}
+
+FrameObjects split_crop_objects(const FrameObjects &objects, const CropBatch &batch, const CropTile &tile,
+                                const CropGroup &group, const cv::Rect &member_crop,
+                                std::pmr::memory_resource *resource) {
+    FrameObjects member_objects(resource);
+    for (const auto &obj : objects) {
+        if (batch.tiles.size() > 1 && !crop_contains(tile.rect, obj.rect)) { continue; }
+
+        auto rect = obj.rect;
+        rect.x += group.rect.x - tile.rect.x;
+        rect.y += group.rect.y - tile.rect.y;
+        if (group.members.size() > 1 && !crop_contains(member_crop, rect)) { continue; }
+
+        member_objects.emplace_back(obj);
+        member_objects.back().rect = rect;
+    }
+    return member_objects;
+}
+
+std::vector<cv::Rect> plan_tiles(const int img_w, const int img_h, const int tile_size, const float overlap,
+                                 const RegionMask *region) {
+    std::vector<cv::Rect> tiles;
+    if (!tiling_enabled(img_w, img_h, tile_size)) { return tiles; }
+
+    // 一个方向上的分块起点, 步长按重叠比例计算, 最后一块贴齐边缘
+    auto starts = [tile_size, overlap](const int length) {
+        std::vector<int> offsets{0};
+        if (tile_size >= length) { return offsets; }
+        auto stride = std::max(1, static_cast<int>(tile_size * (1 - std::clamp(overlap, 0.0f, 0.9f))));
+        for (auto offset = stride; offset + tile_size < length; offset += stride) { offsets.push_back(offset); }
+        offsets.push_back(length - tile_size);
+        return offsets;
+    };
+
+    auto tile_w = std::min(tile_size, img_w);
+    auto tile_h = std::min(tile_size, img_h);
+    for (auto y : starts(img_h)) {
+        for (auto x : starts(img_w)) {
+            cv::Rect tile(x, y, tile_w, tile_h);
+            if (region && !region->intersects(tile)) { continue; }
+            tiles.emplace_back(tile);
+        }
+    }
+    return tiles;
+}
+
+}// namespace gddi
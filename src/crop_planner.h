@@ -0,0 +1,108 @@
+/**
+ * @file crop_planner.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 多阶段裁剪合并: 重叠的裁剪区域合并为一次推理, 小裁剪拼图 (atlas) 推理
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 by GDDI
+ *
+ */
+
+#pragma once
+
+#include "frame_arena.h"
+#include <cstdint>
+#include <opencv2/core/mat.hpp>
+#include <vector>
+
+namespace gddi {
+
+class RegionMask;
+
+struct CropGroup {
+    cv::Rect rect;                // 推理使用的裁剪区域, 单个成员时即为成员的裁剪区域
+    std::vector<uint32_t> members;// 成员裁剪序号, 升序
+};
+
+/**
+ * @brief 贪心合并裁剪区域
+ *
+ * 每次合并外接矩形面积与两者面积之和比值最小的一对, 比值超过 merge_ratio 时停止.
+ * 合并后的区域按 scale_crop_rect 的规则对齐 (宽 16, 高/座标 2) 并限制在图像内.
+ *
+ * @param crops 各目标的裁剪区域 (scale_crop_rect 的结果)
+ * @param merge_ratio <= 0 不合并, 每个裁剪单独成组, 顺序不变
+ * @return std::vector<CropGroup> 按首个成员序号排序
+ */
+std::vector<CropGroup> coalesce_crops(const int img_w, const int img_h, const std::vector<cv::Rect> &crops,
+                                      const float merge_ratio);
+
+/**
+ * @brief 合并推理的检测结果是否属于某个成员: 目标中心落在成员的裁剪区域内
+ *
+ * 单个成员的组不需要判断, 全部属于该成员 (与单独推理一致)
+ */
+inline bool crop_contains(const cv::Rect &crop, const cv::Rect &object) {
+    return crop.contains(cv::Point(object.x + object.width / 2, object.y + object.height / 2));
+}
+
+struct CropTile {
+    uint32_t group;// 裁剪组序号
+    cv::Rect rect; // 在推理输入图像中的位置
+};
+
+/**
+ * @brief 一次推理的输入: 单个裁剪组, 或多个小裁剪组拼成的画布
+ *
+ */
+struct CropBatch {
+    cv::Size canvas;// 画布大小, 为空时直接使用裁剪图像
+    std::vector<CropTile> tiles;
+};
+
+/**
+ * @brief 规划推理批次, 宽高都不超过 atlas_size / 2 的裁剪组按原尺寸拼入边长 atlas_size 的画布
+ *
+ * 按高度降序做 shelf 装箱, 画布放不下时新开画布; 只有一个小裁剪时不拼图
+ *
+ * @param atlas_size 画布边长 (模型输入分辨率), 0 不拼图, 每个裁剪组单独推理, 顺序不变
+ */
+std::vector<CropBatch> pack_crops(const std::vector<CropGroup> &groups, const int atlas_size);
+
+/**
+ * @brief 生成批次的推理输入图像
+ *
+ */
+cv::Mat compose_crops(const cv::Mat &image, const std::vector<CropGroup> &groups, const CropBatch &batch);
+
+/**
+ * @brief 批次推理结果中属于某个目标裁剪的部分, 换算到原图座标
+ *
+ * 拼图时按目标中心所在的拼块区分裁剪组, 合并的裁剪组内再按 crop_contains 分配给成员
+ *
+ * @param objects 批次推理结果 (推理输入图像座标)
+ * @param member_crop 目标自己的裁剪区域
+ */
+FrameObjects split_crop_objects(const FrameObjects &objects, const CropBatch &batch, const CropTile &tile,
+                                const CropGroup &group, const cv::Rect &member_crop,
+                                std::pmr::memory_resource *resource);
+
+/**
+ * @brief 是否分块推理: 分块边长小于图像宽或高
+ *
+ */
+inline bool tiling_enabled(const int img_w, const int img_h, const int tile_size) {
+    return tile_size > 0 && (tile_size < img_w || tile_size < img_h);
+}
+
+/**
+ * @brief 全图检测的分块区域: 边长 tile_size 的正方形, 相邻分块重叠 overlap, 最后一行/列贴齐图像边缘
+ *
+ * @param region 不为空时跳过不含检测区域的分块
+ * @return std::vector<cv::Rect> 行优先; 未开启分块 (tiling_enabled) 或全部分块都在检测区域外时为空
+ */
+std::vector<cv::Rect> plan_tiles(const int img_w, const int img_h, const int tile_size, const float overlap,
+                                 const RegionMask *region = nullptr);
+
+}// namespace gddi
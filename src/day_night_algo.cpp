@@ -1,6 +1,11 @@
 #include "day_night_algo.h"
 #include "core/result_def.h"
+#include "frame_sequencer.h"
+#include "model_session.h"
+#include "result_delivery.h"
 #include "spdlog/spdlog.h"
+#include "stage_timer.h"
+#include "stream_state.h"
 #include <api/global_config.h>
 #include <common/type_convert.h>
 #include <mutex>
@@ -9,19 +14,38 @@ namespace gddi {
 
 class DayNightAlgo::DayNightAlgoPrivate {
 public:
+    StreamShards<> streams;
+    PostprocessQueue postprocess;
+
     std::mutex model_mutex;
     std::vector<ModelConfig> model_configs;
-    std::vector<std::unique_ptr<gddeploy::InferAPI>> model_impls;
+    std::vector<std::unique_ptr<ModelSession>> model_impls;
 };
 
 DayNightAlgo::DayNightAlgo(const DayNightAlgoConfig &config) : config_(config) {
     gddeploy::gddeploy_init("");
     private_ = std::make_unique<DayNightAlgoPrivate>();
+
+    private_->streams.init([this](const int32_t stream_id) {
+        auto state = std::make_unique<StreamState>("DayNightAlgo", stream_id);
+        state->sequencer = std::make_unique<FrameSequencer>(private_->postprocess);
+        if (config_.scene_cache) {
+            auto max_age = std::chrono::duration_cast<SceneCache::clock::duration>(
+                std::chrono::duration<float>(config_.scene_max_age));
+            state->scene_cache = std::make_unique<SceneCache>(config_.scene_threshold, max_age,
+                                                              config_.scene_hysteresis, "DayNightAlgo", stream_id);
+        }
+        return state;
+    });
 }
 
 DayNightAlgo::~DayNightAlgo() {
     std::lock_guard<std::mutex> lock(private_->model_mutex);
     for (auto &impl : private_->model_impls) { impl->WaitTaskDone(); }
+    private_->streams.for_each([](StreamState &state) {
+        if (state.sequencer) { state.sequencer->flush(); }
+    });
+    private_->postprocess.wait_idle();
 }
 
 bool DayNightAlgo::load_models(const std::vector<ModelConfig> &models) {
@@ -35,11 +59,12 @@ bool DayNightAlgo::load_models(const std::vector<ModelConfig> &models) {
 
     private_->model_configs = models;
     for (const auto &model : models) {
-        auto algo_impl = std::make_unique<gddeploy::InferAPI>();
+        auto algo_impl = std::make_unique<ModelSession>("DayNightAlgo", private_->model_impls.size());
         if (algo_impl->Init("", model.path, model.license, gddeploy::ENUM_API_TYPE::ENUM_API_SESSION_API) != 0) {
             spdlog::error("Failed to load model: {} - {}", model.name, model.path);
             return false;
         }
+        algo_impl->SetBatching(model.max_batch_size, model.batch_wait_us);
         private_->model_impls.emplace_back(std::move(algo_impl));
     }
 
@@ -47,45 +72,114 @@ bool DayNightAlgo::load_models(const std::vector<ModelConfig> &models) {
 }
 
 void DayNightAlgo::async_infer(const int64_t image_id, const cv::Mat &image, InferCallback infer_callback) {
+    async_infer_impl(image_id, image, std::move(infer_callback));
+}
+
+void DayNightAlgo::async_infer_view(const int64_t image_id, const cv::Mat &image, ViewCallback view_callback) {
+    async_infer_impl(image_id, image, std::move(view_callback));
+}
+
+void DayNightAlgo::async_infer_impl(const int64_t image_id, const cv::Mat &image,
+                                    const ResultDelivery &infer_callback) {
+    auto stream = private_->streams.get(0);
+    if (stream->scene_cache && !stream->scene_cache->stale(image)) {
+        // 画面亮度分布没有变化, 不分类; 经 sequencer 排在之前提交的帧之后输出缓存的结果
+        stream->sequencer->wrap(image_id, image, infer_callback, [stream, image_id, image, infer_callback]() {
+            std::lock_guard<std::mutex> lock(stream->mutex);
+            std::vector<AlgoObject> infer_objects;
+            if (auto result = stream->scene_cache->result()) { infer_objects.emplace_back(*result); }
+            if (infer_callback) { infer_callback(image_id, image, infer_objects); }
+        })();
+        return;
+    }
+
+    StageTimer timer(stream->metrics, image_id);
     gddeploy::BufSurfWrapperPtr surface;
-    convertMat2BufSurface(const_cast<cv::Mat &>(image), surface);
+    convert_mat_to_surface(*private_->model_impls[0], const_cast<cv::Mat &>(image), surface);
+    timer.lap(AlgoStage::kPreprocess);
 
     auto package = gddeploy::Package::Create(1);
     package->data[0]->Set(surface);
 
     private_->model_impls[0]->InferAsync(
         package,
-        [this, image_id, image, infer_callback](gddeploy::Status status, gddeploy::PackagePtr data,
-                                                gddeploy::any user_data) {
-            std::vector<AlgoObject> infer_objects;
-            if (!data->data.empty() && data->data[0]->HasMetaValue()) {
-                infer_objects = parse_infer_result(data->data[0]->GetMetaData<gddeploy::InferResult>());
-            }
-
-            if (infer_callback) { infer_callback(image_id, image, infer_objects); }
-        });
+        stream->sequencer->wrap(
+            image_id, image, infer_callback,
+            [this, stream, image_id, image, infer_callback, timer_state = timer.handoff()](
+                gddeploy::Status status, gddeploy::PackagePtr data, gddeploy::any user_data) {
+                std::lock_guard<std::mutex> lock(stream->mutex);
+                auto arena = stream->arena.begin_frame();
+                StageTimer timer(timer_state);
+                timer.lap(AlgoStage::kInferStage1);
+
+                FrameObjects infer_objects(arena);
+                if (!data->data.empty() && data->data[0]->HasMetaValue()) {
+                    infer_objects = parse_infer_result(data->data[0]->GetMetaData<gddeploy::InferResult>(), arena);
+                }
+
+                // 迟滞: 新类别确认之前仍输出原类别
+                if (stream->scene_cache) {
+                    stream->scene_cache->update(infer_objects);
+                    infer_objects.clear();
+                    if (auto result = stream->scene_cache->result()) { infer_objects.emplace_back(*result); }
+                }
+
+                if (infer_callback) { infer_callback(image_id, image, infer_objects); }
+                timer.lap(AlgoStage::kCallback);
+            }));
 }
 
 bool DayNightAlgo::sync_infer(const int64_t image_id, const cv::Mat &image, std::vector<AlgoObject> &infer_objects) {
+    return sync_infer(0, image_id, image, infer_objects);
+}
+
+bool DayNightAlgo::sync_infer(const int32_t stream_id, const int64_t image_id, const cv::Mat &image,
+                              std::vector<AlgoObject> &infer_objects) {
+    auto stream = private_->streams.get(stream_id);
+    if (!stream) {
+        spdlog::error("Invalid stream id: {}", stream_id);
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(stream->mutex);
+    if (stream->scene_cache && !stream->scene_cache->stale(image)) {
+        // 画面亮度分布没有变化, 沿用缓存的分类结果
+        if (auto result = stream->scene_cache->result()) {
+            infer_objects = {*result};
+            infer_objects[0].rect = cv::Rect{0, 0, image.cols, image.rows};
+        }
+        return true;
+    }
+    auto arena = stream->arena.begin_frame();
+
+    StageTimer timer(stream->metrics, image_id);
     gddeploy::BufSurfWrapperPtr surface;
-    convertMat2BufSurface(const_cast<cv::Mat &>(image), surface);
+    convert_mat_to_surface(*private_->model_impls[0], const_cast<cv::Mat &>(image), surface);
+    timer.lap(AlgoStage::kPreprocess);
 
     auto in_package = gddeploy::Package::Create(1);
     in_package->data[0]->Set(surface);
 
     auto out_package = gddeploy::Package::Create(1);
     if (private_->model_impls[0]->InferSync(in_package, out_package) != 0) { return false; }
+    timer.lap(AlgoStage::kInferStage1);
 
     if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
-        infer_objects = parse_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>());
+        infer_objects = to_vector(parse_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
+                                                     arena));
+        // 迟滞: 新类别确认之前仍输出原类别
+        if (stream->scene_cache) {
+            stream->scene_cache->update(infer_objects);
+            if (auto result = stream->scene_cache->result()) { infer_objects = {*result}; }
+        }
         infer_objects[0].rect = cv::Rect{0, 0, image.cols, image.rows};
     }
 
     return true;
 }
 
-std::vector<AlgoObject> DayNightAlgo::parse_infer_result(const gddeploy::InferResult &infer_result) {
-    std::vector<AlgoObject> objects;
+FrameObjects DayNightAlgo::parse_infer_result(const gddeploy::InferResult &infer_result,
+                                              std::pmr::memory_resource *resource) {
+    FrameObjects objects(resource);
 
     for (auto result_type : infer_result.result_type) {
         if (result_type == gddeploy::GDD_RESULT_TYPE_CLASSIFY) {
@@ -1,7 +1,11 @@
 #include "bytetrack/BYTETracker.h"
 #include "door_hat_algo.h"
+#include "model_session.h"
 #include "sequence_statistic.h"
 //#include "spdlog/spdlog.h"
+#include "speculative_infer.h"
+#include "stage_timer.h"
+#include "stream_state.h"
 #include "utils.h"
 #include <api/global_config.h>
 #include <bmcv_api_ext.h>
@@ -12,21 +16,33 @@ namespace gddi {
 
 class DoorHatAlgo::DoorHatAlgoPrivate {
 public:
-    std::unique_ptr<BYTETracker> tracker;
-    std::unique_ptr<SequenceStatistic> sequence_statistic;
+    StreamShards<> streams;
 
     std::mutex model_mutex;
     std::vector<ModelConfig> model_configs;
-    std::vector<std::unique_ptr<gddeploy::InferAPI>> model_impls;
+    std::vector<std::unique_ptr<ModelSession>> model_impls;
 };
 
 DoorHatAlgo::DoorHatAlgo(const DoorHatAlgoConfig &config) : config_(config) {
     gddeploy::gddeploy_init("");
     private_ = std::make_unique<DoorHatAlgoPrivate>();
 
-    private_->tracker = std::make_unique<BYTETracker>(0.3, 0.6, 0.8, 30);
-    private_->sequence_statistic =
-        std::make_unique<SequenceStatistic>(config_.statistics_interval, config_.statistics_threshold);
+    private_->streams.init([this](const int32_t stream_id) {
+        auto state = std::make_unique<StreamState>("DoorHatAlgo", stream_id);
+        state->tracker = std::make_unique<BYTETracker>(0.3, 0.6, 0.8, 30);
+        state->sequence_statistic =
+            std::make_unique<SequenceStatistic>(config_.statistics_interval, config_.statistics_threshold);
+        if (auto gate = config_.stream_motion_gates.find(stream_id); gate != config_.stream_motion_gates.end()) {
+            state->motion_gate = std::make_unique<MotionGate>(gate->second, "DoorHatAlgo", stream_id);
+        }
+        if (config_.state_sampler.interval > 0) {
+            state->state_sampler = std::make_unique<StateSampler>(config_.state_sampler, "DoorHatAlgo", stream_id);
+        }
+        if (config_.speculation.mode != SpeculationMode::kSequential) {
+            state->speculation = std::make_unique<SpeculationPolicy>(config_.speculation);
+        }
+        return state;
+    });
 }
 
 DoorHatAlgo::~DoorHatAlgo() {
@@ -39,32 +55,72 @@ bool DoorHatAlgo::load_models(const std::vector<ModelConfig> &models) {
 
     private_->model_configs = models;
     for (const auto &model : models) {
-        auto algo_impl = std::make_unique<gddeploy::InferAPI>();
+        auto algo_impl = std::make_unique<ModelSession>("DoorHatAlgo", private_->model_impls.size());
         if (algo_impl->Init("", model.path, model.license, gddeploy::ENUM_API_TYPE::ENUM_API_SESSION_API) != 0) {
             //spdlog::error("Failed to load model: {} - {}", model.name, model.path);
             return false;
         }
+        algo_impl->SetBatching(model.max_batch_size, model.batch_wait_us);
         private_->model_impls.emplace_back(std::move(algo_impl));
     }
 
     return true;
 }
 
-bool DoorHatAlgo::sync_infer(const int64_t image_id, const cv::Mat &image,
-                                 std::vector<AlgoObject> &statistic_objects) {
+bool DoorHatAlgo::sync_infer(const int64_t image_id, const cv::Mat &image, std::vector<AlgoObject> &statistic_objects) {
+    return sync_infer(0, image_id, image, statistic_objects);
+}
+
+bool DoorHatAlgo::sync_infer(const int32_t stream_id, const int64_t image_id, const cv::Mat &image,
+                             std::vector<AlgoObject> &statistic_objects) {
+    auto stream = private_->streams.get(stream_id);
+    if (!stream) {
+        printf("Invalid stream id: %d", stream_id);
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(stream->mutex);
+    if (stream->motion_gate && stream->motion_gate->still(image)) {
+        // 画面静止, 不推理, 沿用上一次推理的结果
+        if (auto last = stream->motion_gate->last()) { statistic_objects = *last; }
+        return true;
+    }
+    auto arena = stream->arena.begin_frame();
+
+    StageTimer timer(stream->metrics, image_id);
     gddeploy::BufSurfWrapperPtr surface;
-    convertMat2BufSurface(const_cast<cv::Mat &>(image), surface);
+    convert_mat_to_surface(*private_->model_impls[0], const_cast<cv::Mat &>(image), surface);
+    timer.lap(AlgoStage::kPreprocess);
 
     auto in_package = gddeploy::Package::Create(1);
     in_package->data[0]->Set(surface);
 
+    // 门控模型按采样间隔推理, 其余帧沿用缓存的状态
+    auto sampled = !stream->state_sampler || stream->state_sampler->due();
+    // 门控通过率高时门控模型与二阶段模型同时提交, 门控未通过时丢弃二阶段结果; 未采样的帧没有可并行的门控模型
+    auto speculative = sampled && stream->speculation && stream->speculation->speculate();
     auto out_package = gddeploy::Package::Create(1);
-    if (private_->model_impls[0]->InferSync(in_package, out_package) != 0) { return false; }
+    auto out_package2 = gddeploy::Package::Create(1);
+    if (speculative) {
+        auto in_package2 = gddeploy::Package::Create(1);
+        in_package2->data[0]->Set(surface);
+        if (infer_concurrent(*private_->model_impls[0], in_package, out_package, *private_->model_impls[1], in_package2,
+                             out_package2, timer)
+            != 0) {
+            return false;
+        }
+    } else {
+        if (sampled && private_->model_impls[0]->InferSync(in_package, out_package) != 0) { return false; }
+        timer.lap(AlgoStage::kInferStage1);
+    }
 
-    std::vector<AlgoObject> infer_objects, infer_objects2;
+    FrameObjects infer_objects(arena), infer_objects2(arena);
     if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
         infer_objects = parse_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                           private_->model_configs[0].threshold);
+                                           private_->model_configs[0].threshold, arena);
+    }
+    if (stream->state_sampler) {
+        stream->state_sampler->resolve(infer_objects, sampled,
+                                       [](const AlgoObject &item) { return item.label == "close"; });
     }
     bool flag = false;
     for (auto &item : infer_objects) {
@@ -73,30 +129,31 @@ bool DoorHatAlgo::sync_infer(const int64_t image_id, const cv::Mat &image,
             break;
         }
     }
+    if (sampled && stream->speculation) { stream->speculation->record(flag); }
     if (flag) {
-        auto in_package2 = gddeploy::Package::Create(1);
-        auto out_package2 = gddeploy::Package::Create(1);
-
-        gddeploy::BufSurfWrapperPtr surface_;
-        convertMat2BufSurface(const_cast<cv::Mat &>(image), surface_);
-        in_package2->data[0]->Set(surface_);
-
-        private_->model_impls[1]->InferSync(in_package2, out_package2);
+        if (!speculative) {
+            auto in_package2 = gddeploy::Package::Create(1);
+            in_package2->data[0]->Set(surface);
+            private_->model_impls[1]->InferSync(in_package2, out_package2);
+            timer.lap(AlgoStage::kInferStage2);
+        }
         if (!out_package2->data.empty() && out_package2->data[0]->HasMetaValue()) {
             infer_objects2 = parse_infer_result(out_package2->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                                private_->model_configs[1].threshold);
+                                                private_->model_configs[1].threshold, arena);
         }
         for (auto &val : infer_objects2) {
             if (val.label == "un_hat") { statistic_objects.push_back(val); }
         }
     }
 
+    if (stream->motion_gate) { stream->motion_gate->keep(statistic_objects); }
+
     return true;
 }
 
-std::vector<AlgoObject> DoorHatAlgo::parse_infer_result(const gddeploy::InferResult &infer_result,
-                                                            const float threshold) {
-    std::vector<AlgoObject> objects;
+FrameObjects DoorHatAlgo::parse_infer_result(const gddeploy::InferResult &infer_result, const float threshold,
+                                             std::pmr::memory_resource *resource) {
+    FrameObjects objects(resource);
 
     for (auto result_type : infer_result.result_type) {
         if (result_type == gddeploy::GDD_RESULT_TYPE_DETECT) {
@@ -0,0 +1,127 @@
+#include "dynamic_batcher.h"
+#include <algorithm>
+#include <future>
+
+namespace gddi {
+
+DynamicBatcher::DynamicBatcher(InferBackend &impl, const uint32_t max_batch_size, const uint32_t max_wait_us,
+                               BatchHistograms *histograms)
+    : impl_(impl), max_batch_size_(std::max(max_batch_size, 1u)), max_wait_(std::chrono::microseconds(max_wait_us)),
+      histograms_(histograms), thread_([this]() { run(); }) {}
+
+DynamicBatcher::~DynamicBatcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    pending_cv_.notify_all();
+    thread_.join();
+}
+
+void DynamicBatcher::InferAsync(gddeploy::PackagePtr in_package, gddeploy::InferAsyncCallback callback,
+                                gddeploy::any user_data) {
+    bool full;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_inputs_ += in_package->data.size();
+        pending_.emplace_back(Request{std::move(in_package), std::move(callback), std::move(user_data), clock::now()});
+        full = pending_.size() == 1 || pending_inputs_ >= max_batch_size_;
+    }
+    // 第一个请求唤醒合批线程开始计时, 凑满后唤醒提前提交
+    if (full) { pending_cv_.notify_one(); }
+}
+
+int DynamicBatcher::InferSync(gddeploy::PackagePtr in_package, gddeploy::PackagePtr out_package) {
+    // 回调可能在 future.get() 返回之后才退出, promise 由回调共同持有
+    auto result = std::make_shared<std::promise<gddeploy::PackagePtr>>();
+    auto future = result->get_future();
+    InferAsync(
+        in_package,
+        [result](gddeploy::Status status, gddeploy::PackagePtr data, gddeploy::any) {
+            result->set_value(status == gddeploy::Status::SUCCESS ? data : nullptr);
+        },
+        {});
+
+    auto data = future.get();
+    if (!data) { return -1; }
+    out_package->data = std::move(data->data);
+    return 0;
+}
+
+void DynamicBatcher::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock, [this]() { return pending_.empty() && !dispatching_; });
+}
+
+void DynamicBatcher::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        pending_cv_.wait(lock, [this]() { return stop_ || !pending_.empty(); });
+        if (pending_.empty()) { break; }
+
+        auto deadline = pending_.front().submitted + max_wait_;
+        pending_cv_.wait_until(lock, deadline, [this]() { return stop_ || pending_inputs_ >= max_batch_size_; });
+
+        // 按提交顺序取请求, 至少取一个
+        size_t count = 0, batch_size = 0;
+        while (count < pending_.size()) {
+            auto inputs = pending_[count].in_package->data.size();
+            if (count > 0 && batch_size + inputs > max_batch_size_) { break; }
+            batch_size += inputs;
+            count++;
+        }
+        std::vector<Request> batch(std::make_move_iterator(pending_.begin()),
+                                   std::make_move_iterator(pending_.begin() + count));
+        pending_.erase(pending_.begin(), pending_.begin() + count);
+        pending_inputs_ -= batch_size;
+        dispatching_ = true;
+
+        lock.unlock();
+        dispatch(std::move(batch), batch_size);
+        lock.lock();
+
+        dispatching_ = false;
+        if (pending_.empty()) { idle_cv_.notify_all(); }
+    }
+}
+
+void DynamicBatcher::dispatch(std::vector<Request> batch, const size_t batch_size) {
+    auto now = clock::now();
+    histograms_->batch_size.record(batch_size);
+    for (const auto &request : batch) {
+        histograms_->queue_delay.record(
+            std::chrono::duration_cast<std::chrono::microseconds>(now - request.submitted).count());
+    }
+
+    if (batch.size() == 1) {
+        auto &request = batch.front();
+        impl_.InferAsync(request.in_package, std::move(request.callback), std::move(request.user_data));
+        return;
+    }
+
+    auto package = gddeploy::Package::Create(0);
+    package->data.reserve(batch_size);
+    for (const auto &request : batch) {
+        package->data.insert(package->data.end(), request.in_package->data.begin(), request.in_package->data.end());
+    }
+
+    impl_.InferAsync(
+        package,
+        [batch = std::move(batch)](gddeploy::Status status, gddeploy::PackagePtr data, gddeploy::any) {
+            size_t offset = 0;
+            for (const auto &request : batch) {
+                auto count = request.in_package->data.size();
+                auto out_package = gddeploy::Package::Create(count);
+                if (status == gddeploy::Status::SUCCESS) {
+                    auto begin = std::min(offset, data->data.size());
+                    auto end = std::min(offset + count, data->data.size());
+                    out_package->data.assign(data->data.begin() + begin, data->data.begin() + end);
+                }
+                offset += count;
+                request.callback(status, out_package, request.user_data);
+            }
+        },
+        {});
+}
+
+}// namespace gddi
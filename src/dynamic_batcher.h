@@ -0,0 +1,82 @@
+/**
+ * @file dynamic_batcher.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 跨视频流动态合批: 凑满批大小或等待超时后合并为一个 Package 提交
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 by GDDI
+ *
+ */
+
+#pragma once
+
+#include "infer_backend.h"
+#include "stage_timer.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gddi {
+
+/**
+ * @brief 同一模型会话的请求 (可来自多个视频流/线程) 按提交顺序合批, 结果按输入切分后回调各自的请求
+ *
+ * 合批线程在第一个请求提交后最多等待 max_wait_us; 单个请求的输入数超过批大小时单独成批, 不拆分
+ */
+class DynamicBatcher {
+public:
+    DynamicBatcher(InferBackend &impl, const uint32_t max_batch_size, const uint32_t max_wait_us,
+                   BatchHistograms *histograms);
+
+    /**
+     * @brief 提交剩余请求后退出合批线程
+     *
+     */
+    ~DynamicBatcher();
+
+    DynamicBatcher(const DynamicBatcher &) = delete;
+    DynamicBatcher &operator=(const DynamicBatcher &) = delete;
+
+    void InferAsync(gddeploy::PackagePtr in_package, gddeploy::InferAsyncCallback callback,
+                    gddeploy::any user_data);
+
+    int InferSync(gddeploy::PackagePtr in_package, gddeploy::PackagePtr out_package);
+
+    /**
+     * @brief 等待已提交的请求全部进入模型
+     *
+     */
+    void flush();
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    struct Request {
+        gddeploy::PackagePtr in_package;
+        gddeploy::InferAsyncCallback callback;
+        gddeploy::any user_data;
+        clock::time_point submitted;
+    };
+
+    void run();
+    void dispatch(std::vector<Request> batch, const size_t batch_size);
+
+    InferBackend &impl_;
+    size_t max_batch_size_;
+    clock::duration max_wait_;
+    BatchHistograms *histograms_;
+
+    std::mutex mutex_;
+    std::condition_variable pending_cv_;
+    std::condition_variable idle_cv_;
+    std::vector<Request> pending_;
+    size_t pending_inputs_{0};
+    bool dispatching_{false};
+    bool stop_{false};
+    std::thread thread_;
+};
+
+}// namespace gddi
@@ -0,0 +1,36 @@
+#include "frame_arena.h"
+
+namespace gddi {
+
+namespace {
+
+constexpr size_t kMaxArenaSize = 4 * 1024 * 1024;
+
+}// namespace
+
+FrameArena::FrameArena(const size_t initial_size) { reserve(initial_size); }
+
+std::pmr::memory_resource *FrameArena::begin_frame() {
+    if (resource_.used > size_ && size_ < kMaxArenaSize) {
+        // 上一帧用量超出缓冲区, 按峰值扩大 (2 的幂)
+        auto size = size_;
+        while (size < resource_.used && size < kMaxArenaSize) { size *= 2; }
+        reserve(size);
+    } else {
+        monotonic_->release();
+    }
+
+    resource_.used = 0;
+    return &resource_;
+}
+
+void FrameArena::reserve(const size_t size) {
+    monotonic_.reset();
+
+    size_ = size;
+    buffer_ = std::make_unique<std::byte[]>(size_);
+    monotonic_.emplace(buffer_.get(), size_, std::pmr::new_delete_resource());
+    resource_.upstream = &*monotonic_;
+}
+
+}// namespace gddi
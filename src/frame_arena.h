@@ -0,0 +1,77 @@
+/**
+ * @file frame_arena.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 帧内存池 (std::pmr), 帧内中间结果统一从这里分配
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 by GDDI
+ *
+ */
+
+#pragma once
+
+#include "struct_def.h"
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+namespace gddi {
+
+/**
+ * @brief 单路视频流的帧内存池, 只能由持有该视频流锁的线程使用
+ *
+ * 预分配缓冲区 + monotonic_buffer_resource, 帧内只分配不释放; 下一帧开始时整体回收.
+ * 某一帧用量超出缓冲区时, 回收时按峰值扩大缓冲区, 稳定后每帧不再有堆分配.
+ */
+class FrameArena {
+public:
+    explicit FrameArena(const size_t initial_size = 16 * 1024);
+
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    /**
+     * @brief 开始新的一帧, 回收上一帧的全部分配
+     *
+     * @return std::pmr::memory_resource* 本帧使用的内存资源, 下一次 begin_frame 之前有效
+     */
+    std::pmr::memory_resource *begin_frame();
+
+    size_t capacity() const { return size_; }
+
+private:
+    // 统计本帧用量, 用于调整缓冲区大小
+    class CountingResource : public std::pmr::memory_resource {
+    public:
+        std::pmr::memory_resource *upstream{nullptr};
+        size_t used{0};
+
+    private:
+        void *do_allocate(size_t bytes, size_t alignment) override {
+            used += bytes + alignment;
+            return upstream->allocate(bytes, alignment);
+        }
+        void do_deallocate(void *ptr, size_t bytes, size_t alignment) override {
+            upstream->deallocate(ptr, bytes, alignment);
+        }
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+    };
+
+    void reserve(const size_t size);
+
+    size_t size_{0};
+    std::unique_ptr<std::byte[]> buffer_;
+    std::optional<std::pmr::monotonic_buffer_resource> monotonic_;
+    CountingResource resource_;
+};
+
+/**
+ * @brief 转换为回调/输出参数使用的 std::vector
+ *
+ */
+inline std::vector<AlgoObject> to_vector(const FrameObjects &objects) { return {objects.begin(), objects.end()}; }
+
+}// namespace gddi
@@ -0,0 +1,35 @@
+/**
+ * @file frame_context.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 当前线程正在处理的帧
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 by GDDI
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace gddi {
+
+/**
+ * @brief 由 StageTimer 设置, 供追踪、录制/回放等内部模块使用
+ *
+ */
+struct FrameContext {
+    const char *algo{""};
+    int64_t frame_id{-1};
+    int32_t stream{0};
+    const void *flow{nullptr};// 调度排队的流标识, 为当前视频流的 StageMetrics (每个算法实例每路视频流一个)
+    uint32_t model_calls{0};// 当前阶段已发起的模型调用数, 异步回调中重新计数
+};
+
+inline FrameContext &current_frame_context() {
+    thread_local FrameContext context;
+    return context;
+}
+
+}// namespace gddi
@@ -0,0 +1,106 @@
+#include "frame_sequencer.h"
+#include "postprocess_pool.h"
+#include "spdlog/spdlog.h"
+#include <atomic>
+#include <vector>
+
+namespace gddi {
+
+namespace {
+
+std::atomic<uint32_t> g_reorder_window{8};
+std::atomic<uint32_t> g_reorder_timeout_ms{1000};
+std::atomic<LateFramePolicy> g_late_frame_policy{LateFramePolicy::kDeliverEmpty};
+
+}// namespace
+
+FrameSequencer::FrameKey FrameSequencer::submit(const int64_t image_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto key = FrameKey{image_id, next_sequence_++};
+    frames_.emplace(key, Frame{clock::now(), nullptr});
+    return key;
+}
+
+void FrameSequencer::complete(const FrameKey &key, const cv::Mat &image, const ResultDelivery &infer_callback,
+                              WorkerPool::Task task) {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // 已被跳过的迟到帧, 不再进入跟踪和时序统计
+    auto iter = frames_.find(key);
+    if (iter == frames_.end()) {
+        lock.unlock();
+        auto image_id = key.first;
+        spdlog::warn("Frame {} arrived after the reorder window", image_id);
+        if (g_late_frame_policy.load(std::memory_order_relaxed) == LateFramePolicy::kDeliverEmpty && infer_callback) {
+            queue_.post([image_id, image, infer_callback]() { infer_callback(image_id, image, {}); });
+        }
+        return;
+    }
+
+    iter->second.task = std::move(task);
+    completed_++;
+
+    skip_missing(clock::now(), false);
+    release(lock);
+}
+
+void FrameSequencer::skip_missing(const clock::time_point now, const bool force) {
+    auto window = g_reorder_window.load(std::memory_order_relaxed);
+    auto timeout = std::chrono::milliseconds(g_reorder_timeout_ms.load(std::memory_order_relaxed));
+
+    size_t skipped = 0;
+    auto iter = frames_.begin();
+    while (iter != frames_.end() && !iter->second.task) {
+        auto expired = timeout.count() > 0 && now - iter->second.submitted > timeout;
+        if (!force && completed_ <= window && !expired) { break; }
+        iter = frames_.erase(iter);
+        skipped++;
+    }
+
+    if (skipped > 0 && !force) { spdlog::warn("Reorder window full or timed out, skip {} missing frame(s)", skipped); }
+}
+
+void FrameSequencer::release(std::unique_lock<std::mutex> &lock) {
+    // 同一时间只有一个线程派发, 保证进入后处理队列的顺序
+    if (releasing_) { return; }
+    releasing_ = true;
+
+    while (true) {
+        std::vector<WorkerPool::Task> ready;
+        for (auto iter = frames_.begin(); iter != frames_.end() && iter->second.task; iter = frames_.erase(iter)) {
+            ready.emplace_back(std::move(iter->second.task));
+            completed_--;
+        }
+        if (ready.empty()) { break; }
+
+        // 不持锁派发, 线程数为 0 时任务在当前线程执行, 回调中可以继续 async_infer
+        lock.unlock();
+        for (auto &task : ready) { queue_.post(std::move(task)); }
+        lock.lock();
+    }
+
+    releasing_ = false;
+    released_.notify_all();
+}
+
+void FrameSequencer::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!frames_.empty()) {
+        // 等待正在派发的线程结束, 否则本次 release 直接返回, 已完成的帧留在缓冲区
+        released_.wait(lock, [this]() { return !releasing_; });
+        skip_missing(clock::now(), true);
+        release(lock);
+    }
+}
+
+void set_reorder_window(const uint32_t window) { g_reorder_window.store(window, std::memory_order_relaxed); }
+
+void set_reorder_timeout(const uint32_t timeout_ms) {
+    g_reorder_timeout_ms.store(timeout_ms, std::memory_order_relaxed);
+}
+
+void set_late_frame_policy(const LateFramePolicy policy) {
+    g_late_frame_policy.store(policy, std::memory_order_relaxed);
+}
+
+}// namespace gddi
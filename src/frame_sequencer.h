@@ -0,0 +1,89 @@
+/**
+ * @file frame_sequencer.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 异步推理结果按帧顺序交付 (单路视频流重排缓冲)
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 by GDDI
+ *
+ */
+
+#pragma once
+
+#include "result_delivery.h"
+#include "struct_def.h"
+#include "worker_pool.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace gddi {
+
+/**
+ * @brief 单路视频流的重排缓冲: 提交时登记 image_id, 推理完成后按 image_id 顺序派发到后处理队列
+ *
+ * 已完成的帧等待所有 image_id 更小的已提交帧完成后才派发, image_id 不要求连续 (跳帧/丢帧不影响), 需随帧顺序递增.
+ * 队首缺帧时最多缓存 reorder_window 个已完成帧, 或队首提交后超过 reorder_timeout 仍未完成 (推理出错丢失回调),
+ * 跳过缺失帧; 缺失帧之后到达时按 LateFramePolicy 处理. 超时在本路视频流有帧完成时检查
+ */
+class FrameSequencer {
+public:
+    explicit FrameSequencer(PostprocessQueue &queue) : queue_(queue) {}
+
+    FrameSequencer(const FrameSequencer &) = delete;
+    FrameSequencer &operator=(const FrameSequencer &) = delete;
+
+    /**
+     * @brief 包装推理回调, 必须在提交推理前调用
+     *
+     */
+    template <typename Callback>
+    auto wrap(const int64_t image_id, const cv::Mat &image, ResultDelivery infer_callback, Callback callback) {
+        auto key = submit(image_id);
+        return [this, key, image, infer_callback, callback = std::move(callback)](auto... args) {
+            complete(key, image, infer_callback, [callback, args...]() mutable { callback(args...); });
+        };
+    }
+
+    /**
+     * @brief 不再等待缺失帧, 按顺序派发所有已完成帧 (析构前在 WaitTaskDone 之后调用)
+     *
+     * 其他线程正在派发时等待其结束后再派发, 返回时本路视频流没有待派发的帧
+     */
+    void flush();
+
+private:
+    using clock = std::chrono::steady_clock;
+    using FrameKey = std::pair<int64_t, uint64_t>;// (image_id, 提交序号), image_id 相同时按提交顺序
+
+    struct Frame {
+        clock::time_point submitted;
+        WorkerPool::Task task;// 为空表示推理未完成
+    };
+
+    FrameKey submit(const int64_t image_id);
+    void complete(const FrameKey &key, const cv::Mat &image, const ResultDelivery &infer_callback,
+                  WorkerPool::Task task);
+
+    /**
+     * @brief 队首未完成的帧超出重排窗口或超时时跳过, force 时跳过所有未完成的帧
+     *
+     */
+    void skip_missing(const clock::time_point now, const bool force);
+    void release(std::unique_lock<std::mutex> &lock);
+
+    PostprocessQueue &queue_;
+
+    std::mutex mutex_;
+    std::condition_variable released_;
+    uint64_t next_sequence_{0};
+    std::map<FrameKey, Frame> frames_;// 已提交未派发的帧
+    size_t completed_{0};             // frames_ 中已完成的帧数
+    bool releasing_{false};
+};
+
+}// namespace gddi
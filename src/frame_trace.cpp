@@ -0,0 +1,201 @@
+#include "frame_trace.h"
+#include "algo_trace.h"
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#ifdef GDDI_ENABLE_TRACE
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace gddi {
+
+#ifdef GDDI_ENABLE_TRACE
+
+std::atomic<bool> g_trace_enabled{false};
+
+namespace {
+
+struct TraceSpan {
+    const char *category;
+    const char *name;
+    int64_t frame_id;
+    int32_t stream;
+    int64_t start_ns;
+    int64_t end_ns;
+};
+
+/**
+ * @brief 单写者环形缓冲区, 只有所属线程写入, 导出时读者按 head 校验被覆盖的区间
+ *
+ * 记录的字段为 relaxed 原子量, 写者写字段前、读者读完字段后各有一次栅栏:
+ * 读者读到的任何一个字段来自第 j 次写入时, 之后读到的 head 不小于 j, 被覆盖或正在写入的记录都会被丢弃
+ */
+class TraceRing {
+public:
+    TraceRing(uint32_t generation, uint32_t capacity)
+        : generation_(generation), thread_id_(static_cast<uint32_t>(syscall(SYS_gettid))), slots_(capacity) {}
+
+    void push(const TraceSpan &span) {
+        auto head = head_.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slots_[head % slots_.size()].store(span);
+        head_.store(head + 1, std::memory_order_release);
+    }
+
+    void snapshot(std::vector<TraceSpan> &spans) const {
+        auto capacity = static_cast<uint64_t>(slots_.size());
+        auto head = head_.load(std::memory_order_acquire);
+        auto begin = head > capacity ? head - capacity : 0;
+
+        std::vector<TraceSpan> copied;
+        for (auto index = begin; index < head; index++) { copied.emplace_back(slots_[index % capacity].load()); }
+
+        // 拷贝期间被写者覆盖的记录丢弃; 写者正在写 new_head 号记录, 占用槽位 new_head - capacity
+        std::atomic_thread_fence(std::memory_order_acquire);
+        auto new_head = head_.load(std::memory_order_relaxed);
+        auto valid_begin = new_head + 1 > capacity ? new_head + 1 - capacity : 0;
+        for (auto index = begin; index < head; index++) {
+            if (index >= valid_begin) { spans.emplace_back(copied[index - begin]); }
+        }
+    }
+
+    uint32_t generation() const { return generation_; }
+    uint32_t thread_id() const { return thread_id_; }
+
+private:
+    struct Slot {
+        std::atomic<const char *> category{nullptr};
+        std::atomic<const char *> name{nullptr};
+        std::atomic<int64_t> frame_id{0};
+        std::atomic<int32_t> stream{0};
+        std::atomic<int64_t> start_ns{0};
+        std::atomic<int64_t> end_ns{0};
+
+        void store(const TraceSpan &span) {
+            category.store(span.category, std::memory_order_relaxed);
+            name.store(span.name, std::memory_order_relaxed);
+            frame_id.store(span.frame_id, std::memory_order_relaxed);
+            stream.store(span.stream, std::memory_order_relaxed);
+            start_ns.store(span.start_ns, std::memory_order_relaxed);
+            end_ns.store(span.end_ns, std::memory_order_relaxed);
+        }
+
+        TraceSpan load() const {
+            return TraceSpan{category.load(std::memory_order_relaxed), name.load(std::memory_order_relaxed),
+                             frame_id.load(std::memory_order_relaxed), stream.load(std::memory_order_relaxed),
+                             start_ns.load(std::memory_order_relaxed), end_ns.load(std::memory_order_relaxed)};
+        }
+    };
+
+    uint32_t generation_;
+    uint32_t thread_id_;
+    std::vector<Slot> slots_;
+    std::atomic<uint64_t> head_{0};
+};
+
+struct TraceRegistry {
+    std::mutex mutex;
+    std::atomic<uint32_t> generation{0};
+    uint32_t capacity{16384};
+    std::vector<std::shared_ptr<TraceRing>> rings;
+};
+
+TraceRegistry &registry() {
+    static TraceRegistry instance;
+    return instance;
+}
+
+TraceRing &thread_ring() {
+    thread_local std::shared_ptr<TraceRing> ring;
+
+    auto &instance = registry();
+    auto generation = instance.generation.load(std::memory_order_acquire);
+    if (!ring || ring->generation() != generation) {
+        std::lock_guard<std::mutex> lock(instance.mutex);
+        ring = std::make_shared<TraceRing>(generation, instance.capacity);
+        instance.rings.emplace_back(ring);
+    }
+
+    return *ring;
+}
+
+int64_t to_ns(std::chrono::steady_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+}// namespace
+
+void record_trace_span(const char *category, const char *name, int64_t frame_id, int32_t stream,
+                       std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+    if (!trace_enabled()) { return; }
+    thread_ring().push(TraceSpan{category, name, frame_id, stream, to_ns(start), to_ns(end)});
+}
+
+bool start_trace(const uint32_t capacity) {
+    auto &instance = registry();
+    {
+        std::lock_guard<std::mutex> lock(instance.mutex);
+        instance.rings.clear();
+        instance.capacity = capacity > 0 ? capacity : 1;
+        instance.generation.fetch_add(1, std::memory_order_release);
+    }
+    g_trace_enabled.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void stop_trace() { g_trace_enabled.store(false, std::memory_order_relaxed); }
+
+std::string export_chrome_trace() {
+    std::vector<std::shared_ptr<TraceRing>> rings;
+    {
+        auto &instance = registry();
+        std::lock_guard<std::mutex> lock(instance.mutex);
+        rings = instance.rings;
+    }
+
+    std::ostringstream stream;
+    stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    bool first = true;
+    for (const auto &ring : rings) {
+        std::vector<TraceSpan> spans;
+        ring->snapshot(spans);
+
+        for (const auto &span : spans) {
+            if (!first) { stream << ","; }
+            first = false;
+
+            stream << "{\"name\":\"" << span.name << "\",\"cat\":\"" << span.category << "\",\"ph\":\"X\",\"ts\":"
+                   << span.start_ns / 1000 << "." << (span.start_ns % 1000) / 100
+                   << ",\"dur\":" << (span.end_ns - span.start_ns) / 1000.0 << ",\"pid\":" << span.stream
+                   << ",\"tid\":" << ring->thread_id() << ",\"args\":{\"frame_id\":" << span.frame_id << "}}";
+        }
+    }
+
+    stream << "]}";
+    return stream.str();
+}
+
+#else
+
+bool start_trace(const uint32_t capacity) { return false; }
+
+void stop_trace() {}
+
+std::string export_chrome_trace() { return "{\"traceEvents\":[]}"; }
+
+#endif
+
+bool dump_chrome_trace(const std::string &path) {
+    std::ofstream file(path);
+    if (!file.is_open()) { return false; }
+
+    file << export_chrome_trace();
+    return file.good();
+}
+
+}// namespace gddi
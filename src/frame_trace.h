@@ -0,0 +1,58 @@
+/**
+ * @file frame_trace.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 帧级追踪 span 记录 (每线程无锁环形缓冲区)
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 by GDDI
+ *
+ */
+
+#pragma once
+
+#include "frame_context.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace gddi {
+
+#ifdef GDDI_ENABLE_TRACE
+
+extern std::atomic<bool> g_trace_enabled;
+
+inline bool trace_enabled() { return g_trace_enabled.load(std::memory_order_relaxed); }
+
+void record_trace_span(const char *category, const char *name, int64_t frame_id, int32_t stream,
+                       std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+
+class TraceScope {
+public:
+    explicit TraceScope(const char *name) : name_(name) {
+        if (trace_enabled()) { start_ = std::chrono::steady_clock::now(); }
+    }
+    ~TraceScope() {
+        if (start_.time_since_epoch().count() != 0) {
+            auto &context = current_frame_context();
+            record_trace_span(context.algo, name_, context.frame_id, context.stream, start_,
+                              std::chrono::steady_clock::now());
+        }
+    }
+
+private:
+    const char *name_;
+    std::chrono::steady_clock::time_point start_{};
+};
+
+#define GDDI_TRACE_CONCAT_IMPL(a, b) a##b
+#define GDDI_TRACE_CONCAT(a, b) GDDI_TRACE_CONCAT_IMPL(a, b)
+#define GDDI_TRACE_SCOPE(name) gddi::TraceScope GDDI_TRACE_CONCAT(trace_scope_, __LINE__)(name)
+
+#else
+
+#define GDDI_TRACE_SCOPE(name)
+
+#endif
+
+}// namespace gddi
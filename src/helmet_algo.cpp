@@ -1,7 +1,10 @@
 #include "helmet_algo.h"
 #include "bytetrack/BYTETracker.h"
+#include "model_session.h"
 #include "sequence_statistic.h"
 //#include "spdlog/spdlog.h"
+#include "stage_timer.h"
+#include "stream_state.h"
 #include "utils.h"
 #include <api/global_config.h>
 #include <bmcv_api_ext.h>
@@ -12,21 +15,24 @@ namespace gddi {
 
 class HelmetAlgo::HelmetAlgoPrivate {
 public:
-    std::unique_ptr<BYTETracker> tracker;
-    std::unique_ptr<SequenceStatistic> sequence_statistic;
+    StreamShards<> streams;
 
     std::mutex model_mutex;
     std::vector<ModelConfig> model_configs;
-    std::vector<std::unique_ptr<gddeploy::InferAPI>> model_impls;
+    std::vector<std::unique_ptr<ModelSession>> model_impls;
 };
 
 HelmetAlgo::HelmetAlgo(const HelmetAlgoConfig &config) : config_(config) {
     gddeploy::gddeploy_init("");
     private_ = std::make_unique<HelmetAlgoPrivate>();
 
-    private_->tracker = std::make_unique<BYTETracker>(0.3, 0.6, 0.8, 30);
-    private_->sequence_statistic =
-        std::make_unique<SequenceStatistic>(config_.statistics_interval, config_.statistics_threshold);
+    private_->streams.init([this](const int32_t stream_id) {
+        auto state = std::make_unique<StreamState>("HelmetAlgo", stream_id);
+        state->tracker = std::make_unique<BYTETracker>(0.3, 0.6, 0.8, 30);
+        state->sequence_statistic =
+            std::make_unique<SequenceStatistic>(config_.statistics_interval, config_.statistics_threshold);
+        return state;
+    });
 }
 
 HelmetAlgo::~HelmetAlgo() {
@@ -39,11 +45,12 @@ bool HelmetAlgo::load_models(const std::vector<ModelConfig> &models) {
 
     private_->model_configs = models;
     for (const auto &model : models) {
-        auto algo_impl = std::make_unique<gddeploy::InferAPI>();
+        auto algo_impl = std::make_unique<ModelSession>("HelmetAlgo", private_->model_impls.size());
         if (algo_impl->Init("", model.path, model.license, gddeploy::ENUM_API_TYPE::ENUM_API_SESSION_API) != 0) {
             //spdlog::error("Failed to load model: {} - {}", model.name, model.path);
             return false;
         }
+        algo_impl->SetBatching(model.max_batch_size, model.batch_wait_us);
         private_->model_impls.emplace_back(std::move(algo_impl));
     }
 
@@ -52,19 +59,35 @@ bool HelmetAlgo::load_models(const std::vector<ModelConfig> &models) {
 
 
 bool HelmetAlgo::sync_infer(const int64_t image_id, const cv::Mat &image, std::vector<AlgoObject> &statistic_objects) {
+    return sync_infer(0, image_id, image, statistic_objects);
+}
+
+bool HelmetAlgo::sync_infer(const int32_t stream_id, const int64_t image_id, const cv::Mat &image,
+                            std::vector<AlgoObject> &statistic_objects) {
+    auto stream = private_->streams.get(stream_id);
+    if (!stream) {
+        printf("Invalid stream id: %d", stream_id);
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(stream->mutex);
+    auto arena = stream->arena.begin_frame();
+
+    StageTimer timer(stream->metrics, image_id);
     gddeploy::BufSurfWrapperPtr surface;
-    convertMat2BufSurface(const_cast<cv::Mat &>(image), surface);
+    convert_mat_to_surface(*private_->model_impls[0], const_cast<cv::Mat &>(image), surface);
+    timer.lap(AlgoStage::kPreprocess);
 
     auto in_package = gddeploy::Package::Create(1);
     in_package->data[0]->Set(surface);
 
     auto out_package = gddeploy::Package::Create(1);
     if (private_->model_impls[0]->InferSync(in_package, out_package) != 0) { return false; }
+    timer.lap(AlgoStage::kInferStage1);
 
-    std::vector<AlgoObject> infer_objects,infer_objects2;
+    FrameObjects infer_objects(arena), infer_objects2(arena);
     if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
         infer_objects = parse_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                           private_->model_configs[0].threshold);
+                                           private_->model_configs[0].threshold, arena);
     }
     // 二阶段检测
     if (!infer_objects.empty()) {
@@ -94,13 +117,15 @@ bool HelmetAlgo::sync_infer(const int64_t image_id, const cv::Mat &image, std::v
             auto out_package = gddeploy::Package::Create(1);
 
             gddeploy::BufSurfWrapperPtr surface_;
-            convertMat2BufSurface(const_cast<cv::Mat &>(crop_images[i]), surface_);
+            convert_mat_to_surface(*private_->model_impls[1], const_cast<cv::Mat &>(crop_images[i]), surface_);
+            timer.lap(AlgoStage::kCrop);
             in_package->data[0]->Set(surface_);
 
             private_->model_impls[1]->InferSync(in_package, out_package);
+            timer.lap(AlgoStage::kInferStage2);
             if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
                 infer_objects2 = parse_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                                   private_->model_configs[1].threshold);
+                                                   private_->model_configs[1].threshold, arena);
             }
             for(auto &val : infer_objects2 )
             {
@@ -118,9 +143,9 @@ bool HelmetAlgo::sync_infer(const int64_t image_id, const cv::Mat &image, std::v
     return true;
 }
 
-std::vector<AlgoObject> HelmetAlgo::parse_infer_result(const gddeploy::InferResult &infer_result,
-                                                      const float threshold) {
-    std::vector<AlgoObject> objects;
+FrameObjects HelmetAlgo::parse_infer_result(const gddeploy::InferResult &infer_result, const float threshold,
+                                            std::pmr::memory_resource *resource) {
+    FrameObjects objects(resource);
 
     for (auto result_type : infer_result.result_type) {
         if (result_type == gddeploy::GDD_RESULT_TYPE_DETECT) {
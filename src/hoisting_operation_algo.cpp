@@ -1,5 +1,12 @@
 #include "hoisting_operation_algo.h"
+#include "frame_sequencer.h"
+#include "model_session.h"
+#include "result_delivery.h"
 #include "spdlog/spdlog.h"
+#include "speculative_infer.h"
+#include "stage_timer.h"
+#include "stream_state.h"
+#include "tiled_infer.h"
 #include "utils.h"
 #include <api/global_config.h>
 #include <bmcv_api_ext.h>
@@ -11,19 +18,38 @@ namespace gddi {
 
 class HoistingOperationAlgo::HoistingOperationAlgoPrivate {
 public:
+    StreamShards<> streams;
+    PostprocessQueue postprocess;
+
     std::mutex model_mutex;
     std::vector<ModelConfig> model_configs;
-    std::vector<std::unique_ptr<gddeploy::InferAPI>> model_impls;
+    std::vector<std::unique_ptr<ModelSession>> model_impls;
 };
 
 HoistingOperationAlgo::HoistingOperationAlgo(const HoistingOperationAlgoConfig &config) : config_(config) {
     gddeploy::gddeploy_init("");
     private_ = std::make_unique<HoistingOperationAlgoPrivate>();
+
+    private_->streams.init([this](const int32_t stream_id) {
+        auto state = std::make_unique<StreamState>("HoistingOperationAlgo", stream_id);
+        state->sequencer = std::make_unique<FrameSequencer>(private_->postprocess);
+        if (auto region = config_.stream_regions.find(stream_id); region != config_.stream_regions.end()) {
+            state->region = std::make_unique<RegionMask>(region->second);
+        }
+        if (config_.speculation.mode != SpeculationMode::kSequential) {
+            state->speculation = std::make_unique<SpeculationPolicy>(config_.speculation);
+        }
+        return state;
+    });
 }
 
 HoistingOperationAlgo::~HoistingOperationAlgo() {
     std::lock_guard<std::mutex> lock(private_->model_mutex);
     for (auto &impl : private_->model_impls) { impl->WaitTaskDone(); }
+    private_->streams.for_each([](StreamState &state) {
+        if (state.sequencer) { state.sequencer->flush(); }
+    });
+    private_->postprocess.wait_idle();
 }
 
 bool HoistingOperationAlgo::load_models(const std::vector<ModelConfig> &models) {
@@ -37,11 +63,12 @@ bool HoistingOperationAlgo::load_models(const std::vector<ModelConfig> &models)
 
     private_->model_configs = models;
     for (const auto &model : models) {
-        auto algo_impl = std::make_unique<gddeploy::InferAPI>();
+        auto algo_impl = std::make_unique<ModelSession>("HoistingOperationAlgo", private_->model_impls.size());
         if (algo_impl->Init("", model.path, model.license, gddeploy::ENUM_API_TYPE::ENUM_API_SESSION_API) != 0) {
             spdlog::error("Failed to load model: {} - {}", model.name, model.path);
             return false;
         }
+        algo_impl->SetBatching(model.max_batch_size, model.batch_wait_us);
         private_->model_impls.emplace_back(std::move(algo_impl));
     }
 
@@ -49,47 +76,93 @@ bool HoistingOperationAlgo::load_models(const std::vector<ModelConfig> &models)
 }
 
 void HoistingOperationAlgo::async_infer(const int64_t image_id, const cv::Mat &image, InferCallback infer_callback) {
+    async_infer_impl(image_id, image, std::move(infer_callback));
+}
+
+void HoistingOperationAlgo::async_infer_view(const int64_t image_id, const cv::Mat &image, ViewCallback view_callback) {
+    async_infer_impl(image_id, image, std::move(view_callback));
+}
+
+void HoistingOperationAlgo::async_infer_impl(const int64_t image_id, const cv::Mat &image,
+                                             const ResultDelivery &infer_callback) {
+    auto stream = private_->streams.get(0);
+    StageTimer timer(stream->metrics, image_id);
+
+    // 开启分块推理时一阶段各分块一个批次提交, 跳过检测区域外的分块; 二阶段仍使用整幅图像
+    auto tile_batch = make_tile_batch(*private_->model_impls[0], image, private_->model_configs[0],
+                                      stream->region.get());
     gddeploy::BufSurfWrapperPtr surface;
-    convertMat2BufSurface(const_cast<cv::Mat &>(image), surface);
-
-    auto package = gddeploy::Package::Create(1);
-    package->data[0]->Set(surface);
-    package->data[0]->SetAlgParam(
-        gddeploy::AlgDetectParam{private_->model_configs[0].threshold, private_->model_configs[0].nms_threshold});
-
-    private_->model_impls[0]->InferAsync(
-        package,
-        [this, image_id, image, surface, infer_callback](gddeploy::Status status, gddeploy::PackagePtr data,
-                                                         gddeploy::any user_data) {
-            std::vector<AlgoObject> infer_objects;
-            if (!data->data.empty() && data->data[0]->HasMetaValue()) {
+    convert_mat_to_surface(*private_->model_impls[0], const_cast<cv::Mat &>(image), surface);
+    timer.lap(AlgoStage::kPreprocess);
+
+    auto package = tile_batch ? tile_batch->package : gddeploy::Package::Create(1);
+    if (!tile_batch) {
+        package->data[0]->Set(surface);
+        package->data[0]->SetAlgParam(
+            gddeploy::AlgDetectParam{private_->model_configs[0].threshold, private_->model_configs[0].nms_threshold});
+    }
+
+    // 门控通过率高时二阶段紧接一阶段提交 (调用序号与顺序执行相同), 两个模型都完成后 (后完成的推理回调线程) 再进入
+    // 一阶段回调, 不阻塞推理回调线程; 所有切片都被跳过时一阶段没有目标, 不投机
+    auto speculative = !package->data.empty() && stream->speculation && stream->speculation->speculate();
+    InferFuture stage2(gddeploy::Package::Create(1));
+    auto stage1_finished = std::make_shared<StageTimer::clock::time_point>();
+
+    auto on_stage1 = stream->sequencer->wrap(
+        image_id, image, infer_callback,
+        [this, stream, image_id, image, surface, tile_batch, infer_callback, speculative, stage2, stage1_finished,
+         timer_state = timer.handoff()](gddeploy::Status status, gddeploy::PackagePtr data, gddeploy::any user_data) {
+            std::lock_guard<std::mutex> lock(stream->mutex);
+            auto arena = stream->arena.begin_frame();
+            StageTimer timer(timer_state);
+            if (speculative) {
+                // 一阶段计时到门控模型完成, 之后等待二阶段模型的时间记为二阶段
+                timer.lap(AlgoStage::kInferStage1, *stage1_finished);
+                timer.lap(AlgoStage::kInferStage2);
+            } else {
+                timer.lap(AlgoStage::kInferStage1);
+            }
+
+            FrameObjects infer_objects(arena);
+            if (tile_batch) {
+                auto parse = [this, arena](const gddeploy::InferResult &result) {
+                    return filter_infer_result(result, private_->model_configs[0].labels, arena);
+                };
+                infer_objects = merge_tile_results(*tile_batch, data, parse,
+                                                   private_->model_configs[0].tile_merge_threshold, arena);
+            } else if (!data->data.empty() && data->data[0]->HasMetaValue()) {
                 infer_objects = filter_infer_result(data->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                                    private_->model_configs[0].labels);
+                                                    private_->model_configs[0].labels, arena);
             }
+            if (stream->region) { stream->region->filter(infer_objects); }
+            if (stream->speculation) { stream->speculation->record(!infer_objects.empty()); }
 
-            // 如果一阶段没有检测目标，直接返回
+            // 如果一阶段没有检测目标，直接返回 (投机执行时二阶段已完成, 结果丢弃)
             if (infer_objects.empty() && infer_callback) {
                 infer_callback(image_id, image, {});
             } else {
-                auto in_package = gddeploy::Package::Create(1);
-                in_package->data[0]->Set(surface);
-                in_package->data[0]->SetAlgParam(gddeploy::AlgDetectParam{private_->model_configs[1].threshold,
-                                                                          private_->model_configs[1].nms_threshold});
-
-                auto out_package = gddeploy::Package::Create(1);
-                private_->model_impls[1]->InferSync(in_package, out_package);
+                auto out_package = stage2.out_package();
+                if (!speculative) {
+                    auto in_package = gddeploy::Package::Create(1);
+                    in_package->data[0]->Set(surface);
+                    in_package->data[0]->SetAlgParam(gddeploy::AlgDetectParam{
+                        private_->model_configs[1].threshold, private_->model_configs[1].nms_threshold});
+                    private_->model_impls[1]->InferSync(in_package, out_package);
+                    timer.lap(AlgoStage::kInferStage2);
+                }
                 if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
                     infer_objects = filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                                        private_->model_configs[1].labels);
+                                                        private_->model_configs[1].labels, arena);
                 }
 
-                std::vector<AlgoObject> match_objects;
+                FrameObjects match_objects(arena);
                 if (!infer_objects.empty()) {
                     // 裁剪目标 & 排序
                     std::sort(infer_objects.begin(), infer_objects.end(),
                               [](const AlgoObject &item1, const AlgoObject &item2) {
                                   return item1.score > item2.score
-                                      && item1.rect.width * item1.rect.height > item2.rect.width * item2.rect.height;
+                                      && item1.rect.width * item1.rect.height
+                                             > item2.rect.width * item2.rect.height;
                               });
 
                     // 裁剪目标数
@@ -103,19 +176,21 @@ void HoistingOperationAlgo::async_infer(const int64_t image_id, const cv::Mat &i
                         auto crop_image = image(crop_rect).clone();
 
                         gddeploy::BufSurfWrapperPtr crop_surface;
-                        convertMat2BufSurface(crop_image, crop_surface);
-                        in_package = gddeploy::Package::Create(1);
+                        convert_mat_to_surface(*private_->model_impls[2], crop_image, crop_surface);
+                        timer.lap(AlgoStage::kCrop);
+                        auto in_package = gddeploy::Package::Create(1);
                         out_package = gddeploy::Package::Create(1);
                         in_package->data[0]->Set(crop_surface);
                         in_package->data[0]->SetAlgParam(gddeploy::AlgDetectParam{
                             private_->model_configs[2].threshold, private_->model_configs[2].nms_threshold});
 
                         private_->model_impls[2]->InferSync(in_package, out_package);
+                        timer.lap(AlgoStage::kInferStage3);
 
                         if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
                             auto objects =
                                 filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                                    private_->model_configs[2].labels);
+                                                    private_->model_configs[2].labels, arena);
                             for (auto &obj : objects) {
                                 obj.rect.x += crop_rect.x;
                                 obj.rect.y += crop_rect.y;
@@ -125,42 +200,122 @@ void HoistingOperationAlgo::async_infer(const int64_t image_id, const cv::Mat &i
                     }
                 }
 
+                // 裁剪区域重叠时去掉重复检出的目标
+                suppress_duplicate_objects(match_objects, private_->model_configs[2].crop_nms_threshold);
+
                 if (infer_callback) { infer_callback(image_id, image, match_objects); }
+                timer.lap(AlgoStage::kCallback);
             }
         });
+
+    gddeploy::InferAsyncCallback callback = on_stage1;
+    if (speculative) {
+        callback = [stage2, stage1_finished, on_stage1](gddeploy::Status status, gddeploy::PackagePtr data,
+                                                        gddeploy::any user_data) {
+            *stage1_finished = StageTimer::clock::now();
+            stage2.then([on_stage1, status, data, user_data]() mutable { on_stage1(status, data, user_data); });
+        };
+    }
+    private_->model_impls[0]->InferAsync(package, callback);
+
+    if (speculative) {
+        auto in_package = gddeploy::Package::Create(1);
+        in_package->data[0]->Set(surface);
+        in_package->data[0]->SetAlgParam(
+            gddeploy::AlgDetectParam{private_->model_configs[1].threshold, private_->model_configs[1].nms_threshold});
+        stage2.submit(*private_->model_impls[1], in_package);
+    }
 }
 
 bool HoistingOperationAlgo::sync_infer(const int64_t image_id, const cv::Mat &image,
                                        std::vector<AlgoObject> &match_objects) {
+    return sync_infer(0, image_id, image, match_objects);
+}
+
+bool HoistingOperationAlgo::sync_infer(const int32_t stream_id, const int64_t image_id, const cv::Mat &image,
+                                       std::vector<AlgoObject> &match_objects) {
+    auto stream = private_->streams.get(stream_id);
+    if (!stream) {
+        spdlog::error("Invalid stream id: {}", stream_id);
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(stream->mutex);
+    auto arena = stream->arena.begin_frame();
+
+    StageTimer timer(stream->metrics, image_id);
+
+    // 开启分块推理时一阶段各分块一个批次提交, 跳过检测区域外的分块; 二阶段仍使用整幅图像
+    auto tile_batch = make_tile_batch(*private_->model_impls[0], image, private_->model_configs[0],
+                                      stream->region.get());
     gddeploy::BufSurfWrapperPtr surface;
-    convertMat2BufSurface(const_cast<cv::Mat &>(image), surface);
+    convert_mat_to_surface(*private_->model_impls[0], const_cast<cv::Mat &>(image), surface);
+    timer.lap(AlgoStage::kPreprocess);
 
+    FrameObjects infer_objects(arena);
     auto in_package = gddeploy::Package::Create(1);
-    in_package->data[0]->Set(surface);
-    in_package->data[0]->SetAlgParam(
-        gddeploy::AlgDetectParam{private_->model_configs[0].threshold, private_->model_configs[0].nms_threshold});
-
     auto out_package = gddeploy::Package::Create(1);
-    if (private_->model_impls[0]->InferSync(in_package, out_package) != 0) { return false; }
+    auto in_package2 = gddeploy::Package::Create(1);
+    in_package2->data[0]->Set(surface);
+    in_package2->data[0]->SetAlgParam(
+        gddeploy::AlgDetectParam{private_->model_configs[1].threshold, private_->model_configs[1].nms_threshold});
+    auto out_package2 = gddeploy::Package::Create(1);
+    // 门控通过率高时一、二阶段同时提交, 一阶段没有目标时丢弃二阶段结果
+    auto speculative = stream->speculation && stream->speculation->speculate();
+    if (tile_batch) {
+        auto parse = [this, arena](const gddeploy::InferResult &result) {
+            return filter_infer_result(result, private_->model_configs[0].labels, arena);
+        };
+        if (speculative) {
+            out_package = gddeploy::Package::Create(tile_batch->tiles.size());
+            if (infer_concurrent(*private_->model_impls[0], tile_batch->package, out_package,
+                                 *private_->model_impls[1], in_package2, out_package2, timer)
+                != 0) {
+                return false;
+            }
+            infer_objects = merge_tile_results(*tile_batch, out_package, parse,
+                                               private_->model_configs[0].tile_merge_threshold, arena);
+        } else {
+            if (infer_tiles(*private_->model_impls[0], *tile_batch, parse,
+                            private_->model_configs[0].tile_merge_threshold, infer_objects)
+                != 0) {
+                return false;
+            }
+            timer.lap(AlgoStage::kInferStage1);
+        }
+    } else {
+        in_package->data[0]->Set(surface);
+        in_package->data[0]->SetAlgParam(
+            gddeploy::AlgDetectParam{private_->model_configs[0].threshold, private_->model_configs[0].nms_threshold});
 
-    std::vector<AlgoObject> infer_objects;
-    if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
-        infer_objects = filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                            private_->model_configs[0].labels);
+        if (speculative) {
+            if (infer_concurrent(*private_->model_impls[0], in_package, out_package, *private_->model_impls[1],
+                                 in_package2, out_package2, timer)
+                != 0) {
+                return false;
+            }
+        } else {
+            if (private_->model_impls[0]->InferSync(in_package, out_package) != 0) { return false; }
+            timer.lap(AlgoStage::kInferStage1);
+        }
+
+        if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
+            infer_objects = filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
+                                                private_->model_configs[0].labels, arena);
+        }
     }
+    if (stream->region) { stream->region->filter(infer_objects); }
+    if (stream->speculation) { stream->speculation->record(!infer_objects.empty()); }
 
     // 二阶段检测
     if (!infer_objects.empty()) {
-        in_package = gddeploy::Package::Create(1);
-        in_package->data[0]->Set(surface);
-        in_package->data[0]->SetAlgParam(
-            gddeploy::AlgDetectParam{private_->model_configs[1].threshold, private_->model_configs[1].nms_threshold});
-
-        out_package = gddeploy::Package::Create(1);
-        private_->model_impls[1]->InferSync(in_package, out_package);
+        out_package = out_package2;
+        if (!speculative) {
+            private_->model_impls[1]->InferSync(in_package2, out_package);
+            timer.lap(AlgoStage::kInferStage2);
+        }
         if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
             infer_objects = filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                                private_->model_configs[1].labels);
+                                                private_->model_configs[1].labels, arena);
         }
 
         if (!infer_objects.empty()) {
@@ -181,7 +336,8 @@ bool HoistingOperationAlgo::sync_infer(const int64_t image_id, const cv::Mat &im
                 auto crop_image = image(crop_rect).clone();
 
                 gddeploy::BufSurfWrapperPtr crop_surface;
-                convertMat2BufSurface(crop_image, crop_surface);
+                convert_mat_to_surface(*private_->model_impls[2], crop_image, crop_surface);
+                timer.lap(AlgoStage::kCrop);
                 in_package = gddeploy::Package::Create(1);
                 out_package = gddeploy::Package::Create(1);
                 in_package->data[0]->Set(crop_surface);
@@ -189,10 +345,11 @@ bool HoistingOperationAlgo::sync_infer(const int64_t image_id, const cv::Mat &im
                                                                           private_->model_configs[2].nms_threshold});
 
                 private_->model_impls[2]->InferSync(in_package, out_package);
+                timer.lap(AlgoStage::kInferStage3);
 
                 if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
                     auto objects = filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                                       private_->model_configs[2].labels);
+                                                       private_->model_configs[2].labels, arena);
                     for (auto &obj : objects) {
                         obj.rect.x += crop_rect.x;
                         obj.rect.y += crop_rect.y;
@@ -200,15 +357,19 @@ bool HoistingOperationAlgo::sync_infer(const int64_t image_id, const cv::Mat &im
                     }
                 }
             }
+
+            // 裁剪区域重叠时去掉重复检出的目标
+            suppress_duplicate_objects(match_objects, private_->model_configs[2].crop_nms_threshold);
         }
     }
 
     return true;
 }
 
-std::vector<AlgoObject> HoistingOperationAlgo::filter_infer_result(const gddeploy::InferResult &infer_result,
-                                                                   const std::set<std::string> &labels) {
-    std::vector<AlgoObject> objects;
+FrameObjects HoistingOperationAlgo::filter_infer_result(const gddeploy::InferResult &infer_result,
+                                                        const std::set<std::string> &labels,
+                                                        std::pmr::memory_resource *resource) {
+    FrameObjects objects(resource);
 
     for (auto result_type : infer_result.result_type) {
         if (result_type == gddeploy::GDD_RESULT_TYPE_DETECT) {
@@ -0,0 +1,324 @@
+#include "infer_scheduler.h"
+#include "latency_histogram.h"
+#include "model_session.h"
+#include "stage_timer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace gddi {
+
+namespace {
+
+using clock = std::chrono::steady_clock;
+
+constexpr size_t kClasses = static_cast<size_t>(InferPriority::kCount);
+
+// 设备满载时按该间隔检查截止时间
+constexpr auto kPollInterval = std::chrono::milliseconds(5);
+
+std::mutex g_mutex;
+std::shared_ptr<InferScheduler> g_scheduler;
+std::atomic<bool> g_scheduler_enabled{false};
+
+std::shared_mutex g_priority_mutex;
+std::unordered_map<std::string, InferPriority> g_priorities;
+
+}// namespace
+
+class InferScheduler::InferSchedulerPrivate {
+public:
+    struct Task {
+        InferPriority priority;
+        clock::time_point submitted;
+        Launch launch;
+        Drop drop;
+    };
+
+    using FlowKey = std::pair<const void *, int32_t>;
+
+    struct FlowQueue {
+        std::array<std::deque<Task>, kClasses> tasks;
+        double finish_tag{0};// 上一次派发的虚拟结束时间
+        double weight{1};
+    };
+
+    struct ClassCounters {
+        std::atomic<uint64_t> dispatched{0};
+        std::atomic<uint64_t> dropped{0};
+        LatencyHistogram queue_delay;
+    };
+
+    explicit InferSchedulerPrivate(const SchedulerConfig &config) : config(config) {
+        this->config.max_inflight = std::max(config.max_inflight, 1u);
+    }
+
+    void run();
+
+    /**
+     * @brief 丢弃回调在单独线程执行, 回调中可以再发起模型调用
+     *
+     */
+    void run_drops();
+
+    /**
+     * @brief 超过截止时间的请求移入丢弃队列
+     *
+     */
+    void expire(const clock::time_point now);
+
+    /**
+     * @brief 取出下一个派发的请求: 有效优先级 (提交优先级按等待时间提升) 最高, 同级取虚拟开始时间最小的流
+     *
+     * 同时移除已清空且没有剩余虚拟时间的流 (算法实例析构后不再保留)
+     */
+    Task pick(const clock::time_point now);
+
+    SchedulerConfig config;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::map<FlowKey, FlowQueue> flows;
+    double virtual_time{0};// 最近派发请求的虚拟开始时间, 新活跃的流从这里开始排队
+    size_t pending{0};
+    uint32_t inflight{0};
+    bool stop{false};
+
+    std::condition_variable drop_cv;
+    std::deque<Drop> drops;
+    size_t dropping{0};// 丢弃队列中和正在执行的丢弃回调数
+    bool drop_stop{false};
+
+    std::array<ClassCounters, kClasses> counters;
+    std::thread thread;
+    std::thread drop_thread;
+};
+
+void InferScheduler::InferSchedulerPrivate::expire(const clock::time_point now) {
+    for (size_t level = 0; level < kClasses; level++) {
+        if (config.deadline_ms[level] == 0) { continue; }
+        auto deadline = std::chrono::milliseconds(config.deadline_ms[level]);
+        for (auto &[_, queue] : flows) {
+            auto &tasks = queue.tasks[level];
+            while (!tasks.empty() && now - tasks.front().submitted > deadline) {
+                drops.emplace_back(std::move(tasks.front().drop));
+                tasks.pop_front();
+                pending--;
+                dropping++;
+                counters[level].dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+InferScheduler::InferSchedulerPrivate::Task InferScheduler::InferSchedulerPrivate::pick(const clock::time_point now) {
+    FlowQueue *best_queue = nullptr;
+    size_t best_level = 0;
+    size_t best_effective = kClasses;
+    double best_start = 0;
+    clock::time_point best_submitted;
+
+    for (auto iter = flows.begin(); iter != flows.end();) {
+        auto &queue = iter->second;
+        auto start = std::max(queue.finish_tag, virtual_time);
+        bool empty = true;
+        for (size_t level = 0; level < kClasses; level++) {
+            if (queue.tasks[level].empty()) { continue; }
+            empty = false;
+
+            // 饥饿保护: 每等待 starvation_ms 提升一级, 最高到 kNormal, kCritical 的排队时间不受低优先级影响
+            const auto &task = queue.tasks[level].front();
+            auto effective = level;
+            constexpr auto kPromoteLimit = static_cast<size_t>(InferPriority::kNormal);
+            if (config.starvation_ms > 0 && level > kPromoteLimit) {
+                auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(now - task.submitted).count();
+                auto steps = static_cast<size_t>(waited / config.starvation_ms);
+                effective = level - std::min(level - kPromoteLimit, steps);
+            }
+
+            if (!best_queue || effective < best_effective
+                || (effective == best_effective
+                    && (start < best_start || (start == best_start && task.submitted < best_submitted)))) {
+                best_queue = &queue;
+                best_level = level;
+                best_effective = effective;
+                best_start = start;
+                best_submitted = task.submitted;
+            }
+        }
+
+        // 虚拟结束时间不晚于 virtual_time 时, 重新活跃与新建的流排队位置相同
+        if (empty && queue.finish_tag <= virtual_time) {
+            iter = flows.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+
+    auto task = std::move(best_queue->tasks[best_level].front());
+    best_queue->tasks[best_level].pop_front();
+    best_queue->finish_tag = best_start + 1 / best_queue->weight;
+    virtual_time = best_start;
+    pending--;
+    return task;
+}
+
+void InferScheduler::InferSchedulerPrivate::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        auto now = clock::now();
+        expire(now);
+        if (!drops.empty()) { drop_cv.notify_one(); }
+
+        if (pending > 0 && inflight < config.max_inflight) {
+            auto task = pick(now);
+            inflight++;
+            lock.unlock();
+
+            auto &counter = counters[static_cast<size_t>(task.priority)];
+            counter.dispatched.fetch_add(1, std::memory_order_relaxed);
+            counter.queue_delay.record(
+                std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - task.submitted).count());
+            task.launch([this]() {
+                // 持锁通知: 析构时等到 inflight 为 0 后会释放 cv
+                std::lock_guard<std::mutex> guard(mutex);
+                inflight--;
+                cv.notify_one();
+            });
+
+            lock.lock();
+            continue;
+        }
+
+        if (stop && pending == 0 && inflight == 0 && dropping == 0) { break; }
+        if (pending > 0) {
+            cv.wait_for(lock, kPollInterval);
+        } else {
+            cv.wait(lock);
+        }
+    }
+}
+
+void InferScheduler::InferSchedulerPrivate::run_drops() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        drop_cv.wait(lock, [this]() { return drop_stop || !drops.empty(); });
+        if (drops.empty()) { break; }
+
+        auto drop = std::move(drops.front());
+        drops.pop_front();
+        lock.unlock();
+        if (drop) { drop(); }
+        lock.lock();
+
+        dropping--;
+        cv.notify_one();
+    }
+}
+
+InferScheduler::InferScheduler(const SchedulerConfig &config)
+    : private_(std::make_unique<InferSchedulerPrivate>(config)) {
+    private_->thread = std::thread([this]() { private_->run(); });
+    private_->drop_thread = std::thread([this]() { private_->run_drops(); });
+}
+
+InferScheduler::~InferScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(private_->mutex);
+        private_->stop = true;
+    }
+    private_->cv.notify_one();
+    private_->thread.join();
+
+    {
+        std::lock_guard<std::mutex> lock(private_->mutex);
+        private_->drop_stop = true;
+    }
+    private_->drop_cv.notify_one();
+    private_->drop_thread.join();
+}
+
+void InferScheduler::submit(const InferPriority priority, const InferFlow &flow, Launch launch, Drop drop) {
+    auto level = std::min(static_cast<size_t>(priority), kClasses - 1);
+    {
+        std::lock_guard<std::mutex> lock(private_->mutex);
+        auto [iter, inserted] = private_->flows.try_emplace(InferSchedulerPrivate::FlowKey{flow.id, flow.stream});
+        if (inserted) {
+            auto weight = private_->config.stream_weights.find(flow.stream);
+            if (weight != private_->config.stream_weights.end()) {
+                iter->second.weight = std::max(weight->second, 1u);
+            }
+        }
+        iter->second.tasks[level].emplace_back(InferSchedulerPrivate::Task{
+            static_cast<InferPriority>(level), clock::now(), std::move(launch), std::move(drop)});
+        private_->pending++;
+    }
+    private_->cv.notify_one();
+}
+
+SchedulerStats InferScheduler::stats() const {
+    SchedulerStats stats;
+    for (size_t level = 0; level < kClasses; level++) {
+        auto &counter = private_->counters[level];
+        auto &metric = stats.classes[level];
+        metric.dispatched = counter.dispatched.load(std::memory_order_relaxed);
+        metric.dropped = counter.dropped.load(std::memory_order_relaxed);
+        metric.queue_delay.algo = "InferScheduler";
+        metric.queue_delay.stage = "queue";
+        fill_latency_metric(counter.queue_delay, metric.queue_delay);
+    }
+    return stats;
+}
+
+std::shared_ptr<InferScheduler> infer_scheduler() {
+    if (!g_scheduler_enabled.load(std::memory_order_relaxed)) { return nullptr; }
+    std::lock_guard<std::mutex> lock(g_mutex);
+    return g_scheduler;
+}
+
+InferPriority algo_priority(const char *algo) {
+    std::shared_lock<std::shared_mutex> lock(g_priority_mutex);
+    auto iter = g_priorities.find(algo);
+    return iter != g_priorities.end() ? iter->second : InferPriority::kNormal;
+}
+
+void set_infer_scheduler(const SchedulerConfig &config) {
+    auto scheduler = std::make_shared<InferScheduler>(config);
+
+    std::shared_ptr<InferScheduler> previous;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        previous = std::move(g_scheduler);
+        g_scheduler = scheduler;
+    }
+    g_scheduler_enabled.store(true, std::memory_order_relaxed);
+}
+
+void reset_infer_scheduler() {
+    g_scheduler_enabled.store(false, std::memory_order_relaxed);
+
+    std::shared_ptr<InferScheduler> previous;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        previous = std::move(g_scheduler);
+    }
+}
+
+void set_algo_priority(const std::string &algo, const InferPriority priority) {
+    std::unique_lock<std::shared_mutex> lock(g_priority_mutex);
+    g_priorities[algo] = priority;
+}
+
+SchedulerStats get_scheduler_stats() {
+    auto scheduler = infer_scheduler();
+    return scheduler ? scheduler->stats() : SchedulerStats{};
+}
+
+}// namespace gddi
@@ -0,0 +1,74 @@
+#include "label_registry.h"
+#include "result_view.h"
+#include "spdlog/spdlog.h"
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <tuple>
+#include <unordered_map>
+
+namespace gddi {
+
+namespace {
+
+class LabelRegistry {
+public:
+    static LabelRegistry &instance() {
+        static LabelRegistry registry;
+        return registry;
+    }
+
+    // deque 尾部追加不会使已有元素失效, 返回的标签字符串在进程生命周期内有效; 标签表已满时返回 {-1, nullptr}
+    std::pair<int32_t, const std::string *> intern(const std::string &label) {
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            auto iter = ids_.find(label);
+            if (iter != ids_.end()) { return {iter->second, &names_[iter->second]}; }
+        }
+
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto iter = ids_.find(label);
+        if (iter != ids_.end()) { return {iter->second, &names_[iter->second]}; }
+        if (names_.size() >= kMaxLabels) {
+            if (!full_) { spdlog::warn("label table is full ({} labels), new labels get id -1", kMaxLabels); }
+            full_ = true;
+            return {-1, nullptr};
+        }
+
+        auto label_id = static_cast<int32_t>(names_.size());
+        names_.emplace_back(label);
+        ids_.emplace(label, label_id);
+        return {label_id, &names_.back()};
+    }
+
+    const std::string &name(const int32_t label_id) {
+        static const std::string kEmpty;
+
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        if (label_id < 0 || label_id >= static_cast<int32_t>(names_.size())) { return kEmpty; }
+        return names_[label_id];
+    }
+
+private:
+    std::shared_mutex mutex_;
+    std::unordered_map<std::string, int32_t> ids_;
+    std::deque<std::string> names_;
+    bool full_{false};
+};
+
+}// namespace
+
+Label::Label(const std::string &name) {
+    if (name.empty()) { return; }
+    std::tie(id_, name_) = LabelRegistry::instance().intern(name);
+    if (!name_) { spill_ = name; }
+}
+
+int32_t label_id(const std::string &label) {
+    if (label.empty()) { return -1; }
+    return LabelRegistry::instance().intern(label).first;
+}
+
+const std::string &label_name(const int32_t label_id) { return LabelRegistry::instance().name(label_id); }
+
+}// namespace gddi
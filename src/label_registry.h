@@ -0,0 +1,43 @@
+/**
+ * @file label_registry.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 进程内全局标签表, 跟踪器内部以标签ID与登记的字符串保存标签
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 by GDDI
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace gddi {
+
+// 全局标签表最多登记的标签数, 登记满后新标签不再分配ID
+constexpr size_t kMaxLabels = 4096;
+
+/**
+ * @brief 标签ID与登记的标签字符串 (同 result_view.h 的 label_id()/label_name()), 复制不分配内存
+ *
+ * 标签表已满时ID为 -1, 字符串保存在标签内
+ */
+class Label {
+public:
+    Label() = default;
+    Label(const std::string &name);
+
+    int32_t id() const { return id_; }
+    const std::string &str() const { return name_ ? *name_ : spill_; }
+
+    operator const std::string &() const { return str(); }
+
+private:
+    int32_t id_{-1};
+    const std::string *name_{nullptr};
+    std::string spill_;
+};
+
+}// namespace gddi
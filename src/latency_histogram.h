@@ -0,0 +1,117 @@
+/**
+ * @file latency_histogram.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 无锁对数线性(HDR)耗时直方图
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 by GDDI
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+
+namespace gddi {
+
+/**
+ * @brief 每个 2 的幂区间切分为 16 个子桶, 相对误差 < 6.25%, 量程 0 ~ 2^36 us
+ *
+ * record 只有 relaxed 原子加, 可在任意线程并发调用
+ */
+class LatencyHistogram {
+public:
+    static constexpr uint32_t kSubBucketBits = 4;
+    static constexpr uint32_t kSubBuckets = 1u << kSubBucketBits;
+    static constexpr uint32_t kMaxBits = 36;
+    static constexpr uint32_t kBucketCount = (kMaxBits - kSubBucketBits + 1) * kSubBuckets;
+
+    void record(uint64_t value_us) {
+        buckets_[bucket_index(value_us)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(value_us, std::memory_order_relaxed);
+
+        auto current_min = min_.load(std::memory_order_relaxed);
+        while (value_us < current_min
+               && !min_.compare_exchange_weak(current_min, value_us, std::memory_order_relaxed)) {}
+        auto current_max = max_.load(std::memory_order_relaxed);
+        while (value_us > current_max
+               && !max_.compare_exchange_weak(current_max, value_us, std::memory_order_relaxed)) {}
+    }
+
+    void reset() {
+        for (auto &bucket : buckets_) { bucket.store(0, std::memory_order_relaxed); }
+        count_.store(0, std::memory_order_relaxed);
+        sum_.store(0, std::memory_order_relaxed);
+        min_.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+    uint64_t min() const {
+        auto value = min_.load(std::memory_order_relaxed);
+        return value == std::numeric_limits<uint64_t>::max() ? 0 : value;
+    }
+    uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+    uint64_t bucket_count(uint32_t index) const { return buckets_[index].load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 分位数 (返回所在桶上界, 不超过观测到的最大值)
+     *
+     * @param quantile 0 ~ 1
+     * @return uint64_t
+     */
+    uint64_t percentile(double quantile) const {
+        std::array<uint64_t, kBucketCount> snapshot;
+        uint64_t total = 0;
+        for (uint32_t i = 0; i < kBucketCount; i++) {
+            snapshot[i] = bucket_count(i);
+            total += snapshot[i];
+        }
+        if (total == 0) { return 0; }
+
+        auto rank = static_cast<uint64_t>(quantile * total + 0.5);
+        if (rank == 0) { rank = 1; }
+
+        uint64_t accumulated = 0;
+        for (uint32_t i = 0; i < kBucketCount; i++) {
+            accumulated += snapshot[i];
+            if (accumulated >= rank) { return std::min(bucket_upper_bound(i), max()); }
+        }
+        return max();
+    }
+
+    static uint32_t bucket_index(uint64_t value) {
+        if (value < kSubBuckets) { return static_cast<uint32_t>(value); }
+
+        uint32_t msb = 63 - __builtin_clzll(value);
+        if (msb >= kMaxBits) { return kBucketCount - 1; }
+
+        uint32_t shift = msb - kSubBucketBits;
+        return (msb - kSubBucketBits + 1) * kSubBuckets + static_cast<uint32_t>((value >> shift) & (kSubBuckets - 1));
+    }
+
+    static uint64_t bucket_upper_bound(uint32_t index) {
+        if (index < kSubBuckets) { return index; }
+
+        uint32_t msb = index / kSubBuckets + kSubBucketBits - 1;
+        uint32_t shift = msb - kSubBucketBits;
+        uint64_t sub_bucket = index % kSubBuckets;
+        return ((kSubBuckets + sub_bucket + 1) << shift) - 1;
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, kBucketCount> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> min_{std::numeric_limits<uint64_t>::max()};
+    std::atomic<uint64_t> max_{0};
+};
+
+}// namespace gddi
@@ -1,7 +1,11 @@
 #include "light_leavepost_algo.h"
 #include "bytetrack/BYTETracker.h"
+#include "model_session.h"
 #include "sequence_statistic.h"
 //#include "spdlog/spdlog.h"
+#include "speculative_infer.h"
+#include "stage_timer.h"
+#include "stream_state.h"
 #include "utils.h"
 #include <api/global_config.h>
 #include <bmcv_api_ext.h>
@@ -12,21 +16,34 @@ namespace gddi {
 
 class Light_LeavepostAlgo::Light_LeavepostAlgoPrivate {
 public:
-    std::unique_ptr<BYTETracker> tracker;
-    std::unique_ptr<SequenceStatistic> sequence_statistic;
+    StreamShards<> streams;
 
     std::mutex model_mutex;
     std::vector<ModelConfig> model_configs;
-    std::vector<std::unique_ptr<gddeploy::InferAPI>> model_impls;
+    std::vector<std::unique_ptr<ModelSession>> model_impls;
 };
 
 Light_LeavepostAlgo::Light_LeavepostAlgo(const Light_LeavepostAlgoConfig &config) : config_(config) {
     gddeploy::gddeploy_init("");
     private_ = std::make_unique<Light_LeavepostAlgoPrivate>();
 
-    private_->tracker = std::make_unique<BYTETracker>(0.3, 0.6, 0.8, 30);
-    private_->sequence_statistic =
-        std::make_unique<SequenceStatistic>(config_.statistics_interval, config_.statistics_threshold);
+    private_->streams.init([this](const int32_t stream_id) {
+        auto state = std::make_unique<StreamState>("Light_LeavepostAlgo", stream_id);
+        state->tracker = std::make_unique<BYTETracker>(0.3, 0.6, 0.8, 30);
+        state->sequence_statistic =
+            std::make_unique<SequenceStatistic>(config_.statistics_interval, config_.statistics_threshold);
+        if (auto gate = config_.stream_motion_gates.find(stream_id); gate != config_.stream_motion_gates.end()) {
+            state->motion_gate = std::make_unique<MotionGate>(gate->second, "Light_LeavepostAlgo", stream_id);
+        }
+        if (config_.state_sampler.interval > 0) {
+            state->state_sampler =
+                std::make_unique<StateSampler>(config_.state_sampler, "Light_LeavepostAlgo", stream_id);
+        }
+        if (config_.speculation.mode != SpeculationMode::kSequential) {
+            state->speculation = std::make_unique<SpeculationPolicy>(config_.speculation);
+        }
+        return state;
+    });
 }
 
 Light_LeavepostAlgo::~Light_LeavepostAlgo() {
@@ -39,31 +56,73 @@ bool Light_LeavepostAlgo::load_models(const std::vector<ModelConfig> &models) {
 
     private_->model_configs = models;
     for (const auto &model : models) {
-        auto algo_impl = std::make_unique<gddeploy::InferAPI>();
+        auto algo_impl = std::make_unique<ModelSession>("Light_LeavepostAlgo", private_->model_impls.size());
         if (algo_impl->Init("", model.path, model.license, gddeploy::ENUM_API_TYPE::ENUM_API_SESSION_API) != 0) {
             //spdlog::error("Failed to load model: {} - {}", model.name, model.path);
             return false;
         }
+        algo_impl->SetBatching(model.max_batch_size, model.batch_wait_us);
         private_->model_impls.emplace_back(std::move(algo_impl));
     }
 
     return true;
 }
 
-bool Light_LeavepostAlgo::sync_infer(const int64_t image_id, const cv::Mat &image, std::vector<AlgoObject> &statistic_objects) {
+bool Light_LeavepostAlgo::sync_infer(const int64_t image_id, const cv::Mat &image,
+                                     std::vector<AlgoObject> &statistic_objects) {
+    return sync_infer(0, image_id, image, statistic_objects);
+}
+
+bool Light_LeavepostAlgo::sync_infer(const int32_t stream_id, const int64_t image_id, const cv::Mat &image,
+                                     std::vector<AlgoObject> &statistic_objects) {
+    auto stream = private_->streams.get(stream_id);
+    if (!stream) {
+        printf("Invalid stream id: %d", stream_id);
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(stream->mutex);
+    if (stream->motion_gate && stream->motion_gate->still(image)) {
+        // 画面静止, 不推理, 沿用上一次推理的结果
+        if (auto last = stream->motion_gate->last()) { statistic_objects = *last; }
+        return true;
+    }
+    auto arena = stream->arena.begin_frame();
+
+    StageTimer timer(stream->metrics, image_id);
     gddeploy::BufSurfWrapperPtr surface;
-    convertMat2BufSurface(const_cast<cv::Mat &>(image), surface);
+    convert_mat_to_surface(*private_->model_impls[0], const_cast<cv::Mat &>(image), surface);
+    timer.lap(AlgoStage::kPreprocess);
 
     auto in_package = gddeploy::Package::Create(1);
     in_package->data[0]->Set(surface);
 
+    // 门控模型按采样间隔推理, 其余帧沿用缓存的状态
+    auto sampled = !stream->state_sampler || stream->state_sampler->due();
+    // 门控通过率高时灯光模型与行人模型同时提交, 灯灭时丢弃行人模型结果; 未采样的帧没有可并行的灯光模型
+    auto speculative = sampled && stream->speculation && stream->speculation->speculate();
     auto out_package = gddeploy::Package::Create(1);
-    if (private_->model_impls[0]->InferSync(in_package, out_package) != 0) { return false; }
+    auto out_package2 = gddeploy::Package::Create(1);
+    if (speculative) {
+        auto in_package2 = gddeploy::Package::Create(1);
+        in_package2->data[0]->Set(surface);
+        if (infer_concurrent(*private_->model_impls[0], in_package, out_package, *private_->model_impls[1], in_package2,
+                             out_package2, timer)
+            != 0) {
+            return false;
+        }
+    } else {
+        if (sampled && private_->model_impls[0]->InferSync(in_package, out_package) != 0) { return false; }
+        timer.lap(AlgoStage::kInferStage1);
+    }
 
-    std::vector<AlgoObject> infer_objects,infer_objects2;
+    FrameObjects infer_objects(arena), infer_objects2(arena);
     if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
         infer_objects = parse_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                           private_->model_configs[0].threshold);
+                                           private_->model_configs[0].threshold, arena);
+    }
+    if (stream->state_sampler) {
+        stream->state_sampler->resolve(infer_objects, sampled,
+                                       [](const AlgoObject &item) { return item.label == "light_on"; });
     }
     bool flag = false;
     for(auto &item : infer_objects)
@@ -74,19 +133,18 @@ bool Light_LeavepostAlgo::sync_infer(const int64_t image_id, const cv::Mat &imag
             statistic_objects.push_back(item);
         }
     }
+    if (sampled && stream->speculation) { stream->speculation->record(flag); }
     if(flag)
     {
-            auto in_package2 = gddeploy::Package::Create(1);
-            auto out_package2 = gddeploy::Package::Create(1);
-
-            gddeploy::BufSurfWrapperPtr surface_;
-            convertMat2BufSurface(const_cast<cv::Mat &>(image), surface_);
-            in_package2->data[0]->Set(surface_);
-
-            private_->model_impls[1]->InferSync(in_package2, out_package2);
+            if (!speculative) {
+                auto in_package2 = gddeploy::Package::Create(1);
+                in_package2->data[0]->Set(surface);
+                private_->model_impls[1]->InferSync(in_package2, out_package2);
+                timer.lap(AlgoStage::kInferStage2);
+            }
             if (!out_package2->data.empty() && out_package2->data[0]->HasMetaValue()) {
                 infer_objects2 = parse_infer_result(out_package2->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                                   private_->model_configs[1].threshold);
+                                                   private_->model_configs[1].threshold, arena);
             }
             for(auto &val : infer_objects2 )
             {
@@ -98,12 +156,14 @@ bool Light_LeavepostAlgo::sync_infer(const int64_t image_id, const cv::Mat &imag
             }
     }
 
+    if (stream->motion_gate) { stream->motion_gate->keep(statistic_objects); }
+
     return true;
 }
 
-std::vector<AlgoObject> Light_LeavepostAlgo::parse_infer_result(const gddeploy::InferResult &infer_result,
-                                                      const float threshold) {
-    std::vector<AlgoObject> objects;
+FrameObjects Light_LeavepostAlgo::parse_infer_result(const gddeploy::InferResult &infer_result, const float threshold,
+                                                     std::pmr::memory_resource *resource) {
+    FrameObjects objects(resource);
 
     for (auto result_type : infer_result.result_type) {
         if (result_type == gddeploy::GDD_RESULT_TYPE_DETECT) {
@@ -1,7 +1,12 @@
 #include "light_mask_algo.h"
 #include "bytetrack/BYTETracker.h"
+#include "frame_sequencer.h"
+#include "model_session.h"
+#include "result_delivery.h"
 #include "sequence_statistic.h"
 #include "spdlog/spdlog.h"
+#include "stage_timer.h"
+#include "stream_state.h"
 #include "utils.h"
 #include <api/global_config.h>
 #include <bmcv_api_ext.h>
@@ -13,26 +18,44 @@ namespace gddi {
 
 class LightMaskAlgo::LightMaskAlgoPrivate {
 public:
-    std::unique_ptr<BYTETracker> tracker;
-    std::unique_ptr<SequenceStatistic> sequence_statistic;
+    StreamShards<> streams;
+    PostprocessQueue postprocess;
 
     std::mutex model_mutex;
     std::vector<ModelConfig> model_configs;
-    std::vector<std::unique_ptr<gddeploy::InferAPI>> model_impls;
+    std::vector<std::unique_ptr<ModelSession>> model_impls;
 };
 
 LightMaskAlgo::LightMaskAlgo(const LightMaskAlgoConfig &config) : config_(config) {
     gddeploy::gddeploy_init("");
     private_ = std::make_unique<LightMaskAlgoPrivate>();
 
-    private_->tracker = std::make_unique<BYTETracker>(0.3, 0.6, 0.8, 30);
-    private_->sequence_statistic =
-        std::make_unique<SequenceStatistic>(config_.statistics_interval, config_.statistics_threshold);
+    private_->streams.init([this](const int32_t stream_id) {
+        auto state = std::make_unique<StreamState>("LightMaskAlgo", stream_id);
+        state->sequencer = std::make_unique<FrameSequencer>(private_->postprocess);
+        state->tracker = std::make_unique<BYTETracker>(0.3, 0.6, 0.8, 30);
+        if (auto region = config_.stream_regions.find(stream_id); region != config_.stream_regions.end()) {
+            state->region = std::make_unique<RegionMask>(region->second);
+        }
+        state->sequence_statistic =
+            std::make_unique<SequenceStatistic>(config_.statistics_interval, config_.statistics_threshold);
+        if (auto gate = config_.stream_motion_gates.find(stream_id); gate != config_.stream_motion_gates.end()) {
+            state->motion_gate = std::make_unique<MotionGate>(gate->second, "LightMaskAlgo", stream_id);
+        }
+        if (config_.state_sampler.interval > 0) {
+            state->state_sampler = std::make_unique<StateSampler>(config_.state_sampler, "LightMaskAlgo", stream_id);
+        }
+        return state;
+    });
 }
 
 LightMaskAlgo::~LightMaskAlgo() {
     std::lock_guard<std::mutex> lock(private_->model_mutex);
     for (auto &impl : private_->model_impls) { impl->WaitTaskDone(); }
+    private_->streams.for_each([](StreamState &state) {
+        if (state.sequencer) { state.sequencer->flush(); }
+    });
+    private_->postprocess.wait_idle();
 }
 
 bool LightMaskAlgo::load_models(const std::vector<ModelConfig> &models) {
@@ -46,11 +69,12 @@ bool LightMaskAlgo::load_models(const std::vector<ModelConfig> &models) {
 
     private_->model_configs = models;
     for (const auto &model : models) {
-        auto algo_impl = std::make_unique<gddeploy::InferAPI>();
+        auto algo_impl = std::make_unique<ModelSession>("LightMaskAlgo", private_->model_impls.size());
         if (algo_impl->Init("", model.path, model.license, gddeploy::ENUM_API_TYPE::ENUM_API_SESSION_API) != 0) {
             spdlog::error("Failed to load model: {} - {}", model.name, model.path);
             return false;
         }
+        algo_impl->SetBatching(model.max_batch_size, model.batch_wait_us);
         private_->model_impls.emplace_back(std::move(algo_impl));
     }
 
@@ -58,126 +82,204 @@ bool LightMaskAlgo::load_models(const std::vector<ModelConfig> &models) {
 }
 
 void LightMaskAlgo::async_infer(const int64_t image_id, const cv::Mat &image, InferCallback infer_callback) {
+    async_infer_impl(image_id, image, std::move(infer_callback));
+}
+
+void LightMaskAlgo::async_infer_view(const int64_t image_id, const cv::Mat &image, ViewCallback view_callback) {
+    async_infer_impl(image_id, image, std::move(view_callback));
+}
+
+void LightMaskAlgo::async_infer_impl(const int64_t image_id, const cv::Mat &image,
+                                     const ResultDelivery &infer_callback) {
+    auto stream = private_->streams.get(0);
+    if (stream->motion_gate && stream->motion_gate->still(image)) {
+        // 画面静止, 不推理; 经 sequencer 排在之前提交的帧之后输出
+        stream->sequencer->wrap(image_id, image, infer_callback, [stream, image_id, image, infer_callback]() {
+            std::lock_guard<std::mutex> lock(stream->mutex);
+            std::vector<AlgoObject> statistic_objects;
+            if (auto last = stream->motion_gate->last()) {
+                statistic_objects = stream->sequence_statistic->update(*last);
+            }
+            if (infer_callback) { infer_callback(image_id, image, statistic_objects); }
+        })();
+        return;
+    }
+
+    StageTimer timer(stream->metrics, image_id);
     gddeploy::BufSurfWrapperPtr surface;
-    convertMat2BufSurface(const_cast<cv::Mat &>(image), surface);
+    convert_mat_to_surface(*private_->model_impls[0], const_cast<cv::Mat &>(image), surface);
+    timer.lap(AlgoStage::kPreprocess);
 
     auto package = gddeploy::Package::Create(1);
     package->data[0]->Set(surface);
     package->data[0]->SetAlgParam(
         gddeploy::AlgDetectParam{private_->model_configs[0].threshold, private_->model_configs[0].nms_threshold});
 
+    // 门控模型按采样间隔推理, 未采样的帧提交空包, ModelSession 直接回调
+    auto sampled = !stream->state_sampler || stream->state_sampler->due();
     private_->model_impls[0]->InferAsync(
-        package,
-        [this, image_id, image, surface, infer_callback](gddeploy::Status status, gddeploy::PackagePtr data,
-                                                         gddeploy::any user_data) {
-            std::vector<AlgoObject> infer_objects;
-            if (!data->data.empty() && data->data[0]->HasMetaValue()) {
-                infer_objects = filter_infer_result(data->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                                    private_->model_configs[0].labels);
-            }
-
-            // 如果一阶段没有检测目标，直接返回
-            if (infer_objects.empty() && infer_callback) {
-                infer_callback(image_id, image, {});
-            } else {
-                auto in_package = gddeploy::Package::Create(1);
-                in_package->data[0]->Set(surface);
-                in_package->data[0]->SetAlgParam(gddeploy::AlgDetectParam{private_->model_configs[1].threshold,
-                                                                          private_->model_configs[1].nms_threshold});
-
-                auto out_package = gddeploy::Package::Create(1);
-                private_->model_impls[1]->InferSync(in_package, out_package);
-                if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
-                    infer_objects = filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                                        private_->model_configs[1].labels);
-                }
-
-                // 生成目标跟踪ID
-                std::vector<Object> objects;
-                for (const auto &item : infer_objects) {
-                    objects.push_back(Object{
-                        .class_id = item.class_id,
-                        .prob = item.score,
-                        .rect = {(float)item.rect.x, (float)item.rect.y, (float)item.rect.width,
-                                 (float)item.rect.height},
-                        .label_name = item.label,
-                    });
+        sampled ? package : gddeploy::Package::Create(0),
+        stream->sequencer->wrap(
+            image_id, image, infer_callback,
+            [this, stream, image_id, image, surface, infer_callback, sampled, timer_state = timer.handoff()](
+                gddeploy::Status status, gddeploy::PackagePtr data, gddeploy::any user_data) {
+                std::lock_guard<std::mutex> lock(stream->mutex);
+                if (stream->motion_gate) { stream->motion_gate->drop(); }
+                auto arena = stream->arena.begin_frame();
+                StageTimer timer(timer_state);
+                timer.lap(AlgoStage::kInferStage1);
+
+                FrameObjects infer_objects(arena);
+                if (!data->data.empty() && data->data[0]->HasMetaValue()) {
+                    infer_objects = filter_infer_result(data->data[0]->GetMetaData<gddeploy::InferResult>(),
+                                                        private_->model_configs[0].labels, arena);
                 }
+                if (stream->state_sampler) { stream->state_sampler->resolve(infer_objects, sampled); }
+
+                // 如果一阶段没有检测目标，直接返回
+                if (infer_objects.empty() && infer_callback) {
+                    infer_callback(image_id, image, {});
+                } else {
+                    auto in_package = gddeploy::Package::Create(1);
+                    in_package->data[0]->Set(surface);
+                    in_package->data[0]->SetAlgParam(gddeploy::AlgDetectParam{
+                        private_->model_configs[1].threshold, private_->model_configs[1].nms_threshold});
+
+                    auto out_package = gddeploy::Package::Create(1);
+                    private_->model_impls[1]->InferSync(in_package, out_package);
+                    timer.lap(AlgoStage::kInferStage2);
+                    if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
+                        infer_objects = filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
+                                                            private_->model_configs[1].labels, arena);
+                    }
 
-                std::vector<AlgoObject> tracked_objects;
-                for (auto &item : private_->tracker->update(objects)) {
-                    tracked_objects.emplace_back(
-                        AlgoObject{item.target_id, item.class_id, item.label_name, item.score,
-                                   cv::Rect{(int)item.tlwh[0], (int)item.tlwh[1], (int)item.tlwh[2], (int)item.tlwh[3]},
-                                   item.track_id});
-                }
+                    // 生成目标跟踪ID
+                    std::vector<Object> objects;
+                    for (const auto &item : infer_objects) {
+                        objects.push_back(Object{
+                            .class_id = item.class_id,
+                            .prob = item.score,
+                            .rect = {(float)item.rect.x, (float)item.rect.y, (float)item.rect.width,
+                                     (float)item.rect.height},
+                            .label_name = item.label,
+                        });
+                    }
 
-                std::vector<AlgoObject> statistic_objects;
-                if (!tracked_objects.empty()) {
-                    // 裁剪目标 & 排序
-                    std::sort(tracked_objects.begin(), tracked_objects.end(),
-                              [](const AlgoObject &item1, const AlgoObject &item2) {
-                                  return item1.score > item2.score
-                                      && item1.rect.width * item1.rect.height > item2.rect.width * item2.rect.height;
-                              });
-
-                    // 裁剪目标数
-                    if (tracked_objects.size() > private_->model_configs[2].max_crop_number) {
-                        tracked_objects.resize(private_->model_configs[2].max_crop_number);
+                    FrameObjects tracked_objects(arena);
+                    for (auto &item : stream->tracker->update(objects)) {
+                        tracked_objects.emplace_back(
+                            AlgoObject{item.target_id, item.class_id, item.label_name, item.score,
+                                       cv::Rect{(int)item.tlwh[0], (int)item.tlwh[1], (int)item.tlwh[2],
+                                                (int)item.tlwh[3]},
+                                       item.track_id});
                     }
 
-                    std::vector<AlgoObject> match_objects;
-                    for (const auto &tracked_object : tracked_objects) {
-                        auto crop_rect = scale_crop_rect(image.cols, image.rows, tracked_object.rect,
-                                                         private_->model_configs[2].crop_scale_factor);
-                        auto crop_image = image(crop_rect).clone();
-
-                        gddeploy::BufSurfWrapperPtr crop_surface;
-                        convertMat2BufSurface(crop_image, crop_surface);
-                        in_package = gddeploy::Package::Create(1);
-                        out_package = gddeploy::Package::Create(1);
-                        in_package->data[0]->Set(crop_surface);
-                        in_package->data[0]->SetAlgParam(gddeploy::AlgDetectParam{
-                            private_->model_configs[2].threshold, private_->model_configs[2].nms_threshold});
-
-                        private_->model_impls[2]->InferSync(in_package, out_package);
-
-                        std::vector<AlgoObject> mask_objects;
-                        if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
-                            mask_objects =
-                                filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                                    private_->model_configs[2].labels);
+                    // 检测区域外的目标不再裁剪推理和告警
+                    if (stream->region) { stream->region->filter(tracked_objects); }
+
+                    timer.lap(AlgoStage::kTrack);
+
+                    std::vector<AlgoObject> statistic_objects;
+                    if (!tracked_objects.empty()) {
+                        // 裁剪目标 & 排序
+                        std::sort(tracked_objects.begin(), tracked_objects.end(),
+                                  [](const AlgoObject &item1, const AlgoObject &item2) {
+                                      return item1.score > item2.score
+                                          && item1.rect.width * item1.rect.height
+                                                 > item2.rect.width * item2.rect.height;
+                                  });
+
+                        // 裁剪目标数
+                        if (tracked_objects.size() > private_->model_configs[2].max_crop_number) {
+                            tracked_objects.resize(private_->model_configs[2].max_crop_number);
+                        }
+
+                        FrameObjects match_objects(arena);
+                        for (const auto &tracked_object : tracked_objects) {
+                            auto crop_rect = scale_crop_rect(image.cols, image.rows, tracked_object.rect,
+                                                             private_->model_configs[2].crop_scale_factor);
+                            auto crop_image = image(crop_rect).clone();
+
+                            gddeploy::BufSurfWrapperPtr crop_surface;
+                            convert_mat_to_surface(*private_->model_impls[2], crop_image, crop_surface);
+                            timer.lap(AlgoStage::kCrop);
+                            in_package = gddeploy::Package::Create(1);
+                            out_package = gddeploy::Package::Create(1);
+                            in_package->data[0]->Set(crop_surface);
+                            in_package->data[0]->SetAlgParam(gddeploy::AlgDetectParam{
+                                private_->model_configs[2].threshold, private_->model_configs[2].nms_threshold});
+
+                            private_->model_impls[2]->InferSync(in_package, out_package);
+                            timer.lap(AlgoStage::kInferStage3);
+
+                            FrameObjects mask_objects(arena);
+                            if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
+                                mask_objects =
+                                    filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
+                                                        private_->model_configs[2].labels, arena);
+                            }
+
+                            if (mask_objects.empty()) { match_objects.emplace_back(tracked_object); }
                         }
 
-                        if (mask_objects.empty()) { match_objects.emplace_back(tracked_object); }
+                        if (stream->motion_gate) { stream->motion_gate->keep(match_objects); }
+                        statistic_objects = stream->sequence_statistic->update(match_objects);
+                        timer.lap(AlgoStage::kStatistic);
                     }
 
-                    statistic_objects = private_->sequence_statistic->update(match_objects);
+                    if (infer_callback) { infer_callback(image_id, image, statistic_objects); }
+                    timer.lap(AlgoStage::kCallback);
                 }
-
-                if (infer_callback) { infer_callback(image_id, image, statistic_objects); }
-            }
-        });
+            }));
 }
 
 bool LightMaskAlgo::sync_infer(const int64_t image_id, const cv::Mat &image,
                                std::vector<AlgoObject> &statistic_objects) {
+    return sync_infer(0, image_id, image, statistic_objects);
+}
+
+bool LightMaskAlgo::sync_infer(const int32_t stream_id, const int64_t image_id, const cv::Mat &image,
+                               std::vector<AlgoObject> &statistic_objects) {
+    auto stream = private_->streams.get(stream_id);
+    if (!stream) {
+        spdlog::error("Invalid stream id: {}", stream_id);
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(stream->mutex);
+    if (stream->motion_gate) {
+        if (stream->motion_gate->still(image)) {
+            // 画面静止, 不推理, 上一次推理的时序统计输入再统计一次
+            if (auto last = stream->motion_gate->last()) {
+                statistic_objects = stream->sequence_statistic->update(*last);
+            }
+            return true;
+        }
+        stream->motion_gate->drop();
+    }
+    auto arena = stream->arena.begin_frame();
+
+    StageTimer timer(stream->metrics, image_id);
     gddeploy::BufSurfWrapperPtr surface;
-    convertMat2BufSurface(const_cast<cv::Mat &>(image), surface);
+    convert_mat_to_surface(*private_->model_impls[0], const_cast<cv::Mat &>(image), surface);
+    timer.lap(AlgoStage::kPreprocess);
 
     auto in_package = gddeploy::Package::Create(1);
     in_package->data[0]->Set(surface);
     in_package->data[0]->SetAlgParam(
         gddeploy::AlgDetectParam{private_->model_configs[0].threshold, private_->model_configs[0].nms_threshold});
 
+    // 门控模型按采样间隔推理, 其余帧沿用缓存的状态
+    auto sampled = !stream->state_sampler || stream->state_sampler->due();
     auto out_package = gddeploy::Package::Create(1);
-    if (private_->model_impls[0]->InferSync(in_package, out_package) != 0) { return false; }
+    if (sampled && private_->model_impls[0]->InferSync(in_package, out_package) != 0) { return false; }
+    timer.lap(AlgoStage::kInferStage1);
 
-    std::vector<AlgoObject> infer_objects;
+    FrameObjects infer_objects(arena);
     if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
         infer_objects = filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                            private_->model_configs[0].labels);
+                                            private_->model_configs[0].labels, arena);
     }
+    if (stream->state_sampler) { stream->state_sampler->resolve(infer_objects, sampled); }
 
     // 二阶段检测
     if (!infer_objects.empty()) {
@@ -188,9 +290,10 @@ bool LightMaskAlgo::sync_infer(const int64_t image_id, const cv::Mat &image,
             gddeploy::AlgDetectParam{private_->model_configs[1].threshold, private_->model_configs[1].nms_threshold});
 
         private_->model_impls[1]->InferSync(in_package, out_package);
+        timer.lap(AlgoStage::kInferStage2);
         if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
             infer_objects = filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                                private_->model_configs[1].labels);
+                                                private_->model_configs[1].labels, arena);
         }
 
         // 生成目标跟踪ID
@@ -204,13 +307,18 @@ bool LightMaskAlgo::sync_infer(const int64_t image_id, const cv::Mat &image,
             });
         }
 
-        std::vector<AlgoObject> tracked_objects;
-        for (auto &item : private_->tracker->update(objects)) {
+        FrameObjects tracked_objects(arena);
+        for (auto &item : stream->tracker->update(objects)) {
             tracked_objects.emplace_back(AlgoObject{
                 item.target_id, item.class_id, item.label_name, item.score,
                 cv::Rect{(int)item.tlwh[0], (int)item.tlwh[1], (int)item.tlwh[2], (int)item.tlwh[3]}, item.track_id});
         }
 
+        // 检测区域外的目标不再裁剪推理和告警
+        if (stream->region) { stream->region->filter(tracked_objects); }
+
+        timer.lap(AlgoStage::kTrack);
+
         if (!tracked_objects.empty()) {
             // 裁剪目标 & 排序
             std::sort(tracked_objects.begin(), tracked_objects.end(),
@@ -224,14 +332,15 @@ bool LightMaskAlgo::sync_infer(const int64_t image_id, const cv::Mat &image,
                 tracked_objects.resize(private_->model_configs[2].max_crop_number);
             }
 
-            std::vector<AlgoObject> match_objects;
+            FrameObjects match_objects(arena);
             for (const auto &tracked_object : tracked_objects) {
                 auto crop_rect = scale_crop_rect(image.cols, image.rows, tracked_object.rect,
                                                  private_->model_configs[2].crop_scale_factor);
                 auto crop_image = image(crop_rect).clone();
 
                 gddeploy::BufSurfWrapperPtr crop_surface;
-                convertMat2BufSurface(crop_image, crop_surface);
+                convert_mat_to_surface(*private_->model_impls[2], crop_image, crop_surface);
+                timer.lap(AlgoStage::kCrop);
                 in_package = gddeploy::Package::Create(1);
                 out_package = gddeploy::Package::Create(1);
                 in_package->data[0]->Set(crop_surface);
@@ -239,26 +348,30 @@ bool LightMaskAlgo::sync_infer(const int64_t image_id, const cv::Mat &image,
                                                                           private_->model_configs[2].nms_threshold});
 
                 private_->model_impls[2]->InferSync(in_package, out_package);
+                timer.lap(AlgoStage::kInferStage3);
 
-                std::vector<AlgoObject> mask_objects;
+                FrameObjects mask_objects(arena);
                 if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
                     mask_objects = filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                                       private_->model_configs[2].labels);
+                                                       private_->model_configs[2].labels, arena);
                 }
 
                 if (mask_objects.empty()) { match_objects.emplace_back(tracked_object); }
             }
 
-            statistic_objects = private_->sequence_statistic->update(match_objects);
+            if (stream->motion_gate) { stream->motion_gate->keep(match_objects); }
+            statistic_objects = stream->sequence_statistic->update(match_objects);
+            timer.lap(AlgoStage::kStatistic);
         }
     }
 
     return true;
 }
 
-std::vector<AlgoObject> LightMaskAlgo::filter_infer_result(const gddeploy::InferResult &infer_result,
-                                                           const std::set<std::string> &labels) {
-    std::vector<AlgoObject> objects;
+FrameObjects LightMaskAlgo::filter_infer_result(const gddeploy::InferResult &infer_result,
+                                                const std::set<std::string> &labels,
+                                                std::pmr::memory_resource *resource) {
+    FrameObjects objects(resource);
 
     for (auto result_type : infer_result.result_type) {
         if (result_type == gddeploy::GDD_RESULT_TYPE_DETECT) {
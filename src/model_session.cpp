@@ -0,0 +1,350 @@
+#include "model_session.h"
+#include "frame_context.h"
+#include "spdlog/spdlog.h"
+#include <atomic>
+#include <future>
+#include <mutex>
+
+namespace gddi {
+
+namespace {
+
+std::mutex g_mutex;
+std::shared_ptr<CaptureWriter> g_capture;
+std::shared_ptr<const CaptureReader> g_replay;
+
+InferBackendFactory g_backend_factory;
+
+// 热路径只读原子标志, 开启时才取共享指针
+std::atomic<bool> g_capture_enabled{false};
+std::atomic<bool> g_replay_enabled{false};
+
+std::shared_ptr<CaptureWriter> capture_writer() {
+    if (!g_capture_enabled.load(std::memory_order_relaxed)) { return nullptr; }
+    std::lock_guard<std::mutex> lock(g_mutex);
+    return g_capture;
+}
+
+std::shared_ptr<const CaptureReader> replay_reader() {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    return g_replay;
+}
+
+InferBackendFactory backend_factory() {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    return g_backend_factory;
+}
+
+/**
+ * @brief 设备后端
+ *
+ */
+class DeviceBackend : public InferBackend {
+public:
+    int Init(const std::string &config, const std::string &model_path, const std::string &license,
+             const gddeploy::ENUM_API_TYPE type) {
+        return impl_.Init(config, model_path, license, type);
+    }
+
+    int InferSync(gddeploy::PackagePtr in_package, gddeploy::PackagePtr out_package) override {
+        return impl_.InferSync(in_package, out_package);
+    }
+
+    void InferAsync(gddeploy::PackagePtr in_package, gddeploy::InferAsyncCallback callback,
+                    gddeploy::any user_data) override {
+        impl_.InferAsync(in_package, callback, user_data);
+    }
+
+    void WaitTaskDone() override { impl_.WaitTaskDone(); }
+
+private:
+    gddeploy::InferAPI impl_;
+};
+
+}// namespace
+
+/**
+ * @brief 合批线程提交的后端: 开启全局调度时每批作为一个调用排队 (流为本会话, 视频流ID -1), 否则直接提交
+ *
+ */
+class ModelSession::ScheduledBackend : public InferBackend {
+public:
+    explicit ScheduledBackend(ModelSession &session) : session_(session) {}
+
+    int InferSync(gddeploy::PackagePtr in_package, gddeploy::PackagePtr out_package) override {
+        return session_.impl_->InferSync(in_package, out_package);
+    }
+
+    void InferAsync(gddeploy::PackagePtr in_package, gddeploy::InferAsyncCallback callback,
+                    gddeploy::any user_data) override {
+        if (auto scheduler = infer_scheduler()) {
+            session_.schedule(*scheduler, InferFlow{&session_, -1}, std::move(in_package), std::move(callback),
+                              std::move(user_data));
+        } else {
+            session_.impl_->InferAsync(std::move(in_package), std::move(callback), std::move(user_data));
+        }
+    }
+
+    void WaitTaskDone() override { session_.wait_scheduled(); }
+
+private:
+    ModelSession &session_;
+};
+
+ModelSession::ModelSession(const char *algo, const uint32_t model_index)
+    : algo_(algo), algo_id_(capture_algo_id(algo)), model_index_(model_index) {}
+
+ModelSession::~ModelSession() {
+    // 排队中的调用回调时访问后端, 需要在后端释放前完成
+    batcher_.reset();
+    wait_scheduled();
+}
+
+int ModelSession::Init(const std::string &config, const std::string &model_path, const std::string &license,
+                       const gddeploy::ENUM_API_TYPE type) {
+    replay_ = replay_reader();
+    if (replay_) { return 0; }
+
+    if (auto factory = backend_factory()) {
+        impl_ = factory(algo_, model_index_, model_path);
+        return impl_ ? 0 : -1;
+    }
+
+    auto device = std::make_unique<DeviceBackend>();
+    auto ret = device->Init(config, model_path, license, type);
+    impl_ = std::move(device);
+    reads_input_ = true;
+    return ret;
+}
+
+void ModelSession::SetBatching(const uint32_t max_batch_size, const uint32_t max_wait_us) {
+    if (!impl_ || max_batch_size <= 1) { return; }
+    scheduled_ = std::make_unique<ScheduledBackend>(*this);
+    batcher_ = std::make_unique<DynamicBatcher>(*scheduled_, max_batch_size, max_wait_us,
+                                                register_batch_histograms(algo_, model_index_));
+}
+
+int ModelSession::InferSync(gddeploy::PackagePtr in_package, gddeploy::PackagePtr out_package) {
+    // 没有输入数据 (如分块全部在检测区域外) 时不调用模型
+    if (in_package->data.empty()) { return 0; }
+
+    // 批量输入 (如分块推理) 每个数据占用一个调用序号
+    auto count = in_package->data.size();
+    auto key = next_key(count);
+    if (replay_) { return replay(key, count, out_package) ? 0 : -1; }
+
+    // 开启合批时先合批再进入调度 (见 ScheduledBackend)
+    int ret = 0;
+    if (batcher_) {
+        ret = batcher_->InferSync(in_package, out_package);
+    } else if (auto scheduler = infer_scheduler()) {
+        ret = schedule_sync(*scheduler, in_package, out_package);
+    } else {
+        ret = impl_->InferSync(in_package, out_package);
+    }
+    if (ret == 0) {
+        if (auto writer = capture_writer()) { capture(*writer, key, count, out_package); }
+    }
+    return ret;
+}
+
+void ModelSession::InferAsync(gddeploy::PackagePtr in_package, gddeploy::InferAsyncCallback callback,
+                              gddeploy::any user_data) {
+    if (in_package->data.empty()) {
+        callback(gddeploy::Status::SUCCESS, gddeploy::Package::Create(0), user_data);
+        return;
+    }
+
+    // 提交时确定帧, 回调线程上的 FrameContext 属于其他帧
+    auto count = in_package->data.size();
+    auto key = next_key(count);
+    if (replay_) {
+        auto out_package = gddeploy::Package::Create(count);
+        if (!replay(key, count, out_package)) {
+            callback(gddeploy::Status::ERROR_BACKEND, out_package, user_data);
+            return;
+        }
+        callback(gddeploy::Status::SUCCESS, out_package, user_data);
+        return;
+    }
+
+    if (auto writer = capture_writer()) {
+        callback = [this, writer, key, count, callback = std::move(callback)](
+                       gddeploy::Status status, gddeploy::PackagePtr data, gddeploy::any user_data) {
+            if (status == gddeploy::Status::SUCCESS) { capture(*writer, key, count, data); }
+            callback(status, data, user_data);
+        };
+    }
+
+    // 开启合批时由合批线程合并后再进入调度
+    if (batcher_) {
+        batcher_->InferAsync(in_package, std::move(callback), user_data);
+    } else if (auto scheduler = infer_scheduler()) {
+        auto &context = current_frame_context();
+        schedule(*scheduler, InferFlow{context.flow, context.stream}, in_package, std::move(callback), user_data);
+    } else {
+        impl_->InferAsync(in_package, std::move(callback), user_data);
+    }
+}
+
+void ModelSession::schedule(InferScheduler &scheduler, const InferFlow &flow, gddeploy::PackagePtr in_package,
+                            gddeploy::InferAsyncCallback callback, gddeploy::any user_data) {
+    {
+        std::lock_guard<std::mutex> lock(task_mutex_);
+        scheduled_tasks_++;
+    }
+
+    // 派发后提交到设备, 完成时先释放调度名额再回调 (回调中可能发起下一阶段的同步调用)
+    auto count = in_package->data.size();
+    scheduler.submit(
+        algo_priority(algo_), flow,
+        [this, in_package, callback, user_data](InferScheduler::Done finished) {
+            impl_->InferAsync(
+                in_package,
+                [this, finished, callback](gddeploy::Status status, gddeploy::PackagePtr data,
+                                           gddeploy::any user_data) {
+                    finished();
+                    callback(status, data, user_data);
+                    finish_scheduled();
+                },
+                user_data);
+        },
+        [this, count, callback, user_data]() {
+            callback(gddeploy::Status::ERROR_BACKEND, gddeploy::Package::Create(count), user_data);
+            finish_scheduled();
+        });
+}
+
+int ModelSession::schedule_sync(InferScheduler &scheduler, gddeploy::PackagePtr in_package,
+                                gddeploy::PackagePtr out_package) {
+    // 调度线程只提交不等待, 当前线程等待结果
+    auto result = std::make_shared<std::promise<gddeploy::PackagePtr>>();
+    auto future = result->get_future();
+    auto &context = current_frame_context();
+    schedule(
+        scheduler, InferFlow{context.flow, context.stream}, in_package,
+        [result](gddeploy::Status status, gddeploy::PackagePtr data, gddeploy::any) {
+            result->set_value(status == gddeploy::Status::SUCCESS ? data : nullptr);
+        },
+        {});
+
+    auto data = future.get();
+    if (!data) { return -1; }
+    out_package->data = std::move(data->data);
+    return 0;
+}
+
+void ModelSession::finish_scheduled() {
+    // 持锁通知: 等待方返回后会话可能被释放
+    std::lock_guard<std::mutex> lock(task_mutex_);
+    if (--scheduled_tasks_ == 0) { task_cv_.notify_all(); }
+}
+
+void ModelSession::wait_scheduled() {
+    std::unique_lock<std::mutex> lock(task_mutex_);
+    task_cv_.wait(lock, [this]() { return scheduled_tasks_ == 0; });
+}
+
+void ModelSession::WaitTaskDone() {
+    // 合批线程提交的请求进入调度后才计数, 先等合批
+    if (batcher_) { batcher_->flush(); }
+    wait_scheduled();
+    if (impl_) { impl_->WaitTaskDone(); }
+}
+
+CaptureKey ModelSession::next_key(const size_t count) const {
+    auto &context = current_frame_context();
+    auto key = CaptureKey{algo_id_, static_cast<uint16_t>(model_index_), static_cast<uint16_t>(context.model_calls),
+                          context.stream, 0, context.frame_id};
+    context.model_calls += count;
+    return key;
+}
+
+void ModelSession::capture(CaptureWriter &writer, CaptureKey key, const size_t count,
+                           const gddeploy::PackagePtr &out_package) const {
+    for (size_t i = 0; i < count; i++, key.call_index++) {
+        if (i < out_package->data.size() && out_package->data[i]->HasMetaValue()) {
+            auto result = out_package->data[i]->GetMetaData<gddeploy::InferResult>();
+            writer.append(algo_, key, &result);
+        } else {
+            writer.append(algo_, key, nullptr);
+        }
+    }
+}
+
+bool ModelSession::replay(CaptureKey key, const size_t count, gddeploy::PackagePtr &out_package) const {
+    for (size_t i = 0; i < count && i < out_package->data.size(); i++, key.call_index++) {
+        gddeploy::InferResult result;
+        bool has_result = false;
+        if (!replay_->find(key, result, has_result)) {
+            spdlog::warn("No captured output for {} model {} stream {} frame {} call {}", algo_, key.model_index,
+                         key.stream_id, key.frame_id, key.call_index);
+            return false;
+        }
+
+        if (has_result) { out_package->data[i]->SetMetaData(std::move(result)); }
+    }
+    return true;
+}
+
+bool replay_enabled() { return g_replay_enabled.load(std::memory_order_relaxed); }
+
+void set_infer_backend_factory(InferBackendFactory factory) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_backend_factory = std::move(factory);
+}
+
+void reset_infer_backend_factory() { set_infer_backend_factory(nullptr); }
+
+bool start_capture(const std::string &path) {
+    auto writer = std::make_shared<CaptureWriter>();
+    if (!writer->open(path)) { return false; }
+
+    std::shared_ptr<CaptureWriter> previous;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        previous = std::move(g_capture);
+        g_capture = writer;
+    }
+    g_capture_enabled.store(true, std::memory_order_relaxed);
+
+    if (previous) { previous->close(); }
+    return true;
+}
+
+void stop_capture() {
+    g_capture_enabled.store(false, std::memory_order_relaxed);
+
+    std::shared_ptr<CaptureWriter> writer;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        writer = std::move(g_capture);
+    }
+
+    // 其他线程可能还持有 writer, close 之后的追加被忽略
+    if (writer) { writer->close(); }
+}
+
+bool start_replay(const std::string &path) {
+    auto reader = std::make_shared<CaptureReader>();
+    if (!reader->open(path)) { return false; }
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_replay = reader;
+    g_replay_enabled.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void stop_replay() {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_replay.reset();
+    g_replay_enabled.store(false, std::memory_order_relaxed);
+}
+
+std::vector<CapturedFrame> replay_frames() {
+    auto reader = replay_reader();
+    if (!reader) { return {}; }
+    return reader->frames();
+}
+
+}// namespace gddi
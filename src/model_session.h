@@ -0,0 +1,142 @@
+/**
+ * @file model_session.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 模型推理会话 (推理后端 + 录制/回放)
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 by GDDI
+ *
+ */
+
+#pragma once
+
+#include "capture_log.h"
+#include "dynamic_batcher.h"
+#include "infer_backend.h"
+#include "infer_scheduler.h"
+#include <api/infer_api.h>
+#include <common/type_convert.h>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace gddi {
+
+/**
+ * @brief 接口与 gddeploy::InferAPI 一致
+ *
+ * 后端默认为设备 (gddeploy::InferAPI), 注册了替身后端时使用替身后端 (见 infer_backend.h)
+ * 录制时把每次调用的输出追加到录制日志; 回放时不加载模型, 输出从日志读取, 异步调用在当前线程回调.
+ * 批量输入 (Package 多个数据) 的每个数据按一次调用记录; 没有输入数据时不调用模型, 异步调用在当前线程回调
+ * 调用对应的帧由 StageTimer 设置的 FrameContext 确定; 开启合批时调用序号仍在提交线程确定, 录制/回放不受合批影响
+ * 开启全局调度时调用按算法优先级和所在的流 (算法实例 + 视频流) 排队; 开启合批时先合批, 每批作为一个调用排队 (流为本会话).
+ * 排队超时的同步调用返回 -1, 异步调用回调 ERROR_BACKEND 和空结果
+ */
+class ModelSession {
+public:
+    /**
+     * @param algo 算法名, 与 StageMetrics 使用的字符串字面量相同
+     * @param model_index 模型序号
+     */
+    ModelSession(const char *algo, const uint32_t model_index);
+
+    /**
+     * @brief 提交剩余的合批请求, 等待排队中的调用回调
+     *
+     */
+    ~ModelSession();
+
+    int Init(const std::string &config, const std::string &model_path, const std::string &license,
+             const gddeploy::ENUM_API_TYPE type);
+
+    /**
+     * @brief 开启跨视频流合批 (Init 之后调用), 回放模式下不合批
+     *
+     * @param max_batch_size 每批最多输入数, 不大于 1 时不合批
+     * @param max_wait_us 第一个请求等待凑批的最长时间
+     */
+    void SetBatching(const uint32_t max_batch_size, const uint32_t max_wait_us);
+
+    int InferSync(gddeploy::PackagePtr in_package, gddeploy::PackagePtr out_package);
+
+    void InferAsync(gddeploy::PackagePtr in_package, gddeploy::InferAsyncCallback callback,
+                    gddeploy::any user_data = {});
+
+    /**
+     * @brief 等待已提交的调用全部回调 (包括合批与调度排队中的调用)
+     *
+     */
+    void WaitTaskDone();
+
+    /**
+     * @brief 后端是否读取输入图像; 回放与替身后端不读取, 不需要把 cv::Mat 转为 BufSurface
+     *
+     */
+    bool ReadsInput() const { return reads_input_; }
+
+private:
+    class ScheduledBackend;
+
+    /**
+     * @brief 经调度器排队后提交到后端, 排队超时回调 ERROR_BACKEND; 回调返回前计入排队中的调用
+     *
+     */
+    void schedule(InferScheduler &scheduler, const InferFlow &flow, gddeploy::PackagePtr in_package,
+                  gddeploy::InferAsyncCallback callback, gddeploy::any user_data);
+
+    /**
+     * @brief 经调度器排队后提交, 排队超时返回 -1
+     *
+     */
+    int schedule_sync(InferScheduler &scheduler, gddeploy::PackagePtr in_package, gddeploy::PackagePtr out_package);
+
+    void finish_scheduled();
+    void wait_scheduled();
+
+    CaptureKey next_key(const size_t count) const;
+    void capture(CaptureWriter &writer, CaptureKey key, const size_t count,
+                 const gddeploy::PackagePtr &out_package) const;
+    bool replay(CaptureKey key, const size_t count, gddeploy::PackagePtr &out_package) const;
+
+    const char *algo_;
+    uint32_t algo_id_;
+    uint32_t model_index_;
+
+    std::unique_ptr<InferBackend> impl_;
+    std::unique_ptr<ScheduledBackend> scheduled_;// 合批后的调用经全局调度提交
+    std::unique_ptr<DynamicBatcher> batcher_;    // 析构时先提交剩余请求
+    std::shared_ptr<const CaptureReader> replay_;
+    bool reads_input_{false};// Init 时创建了设备后端
+
+    std::mutex task_mutex_;
+    std::condition_variable task_cv_;
+    size_t scheduled_tasks_{0};// 已提交到调度器、还没有回调的调用数
+};
+
+bool replay_enabled();
+
+/**
+ * @brief 全局调度器, 未开启时为空
+ *
+ */
+std::shared_ptr<InferScheduler> infer_scheduler();
+
+/**
+ * @brief set_algo_priority 设置的算法优先级, 未设置为 kNormal
+ *
+ */
+InferPriority algo_priority(const char *algo);
+
+/**
+ * @brief cv::Mat 转 BufSurface, session 不读取输入 (回放或替身后端) 时直接跳过
+ *
+ * 同一实例的模型会话在 load_models 中一起初始化, 后端相同; 多个模型共用的输入按其中任一会话判断
+ */
+inline void convert_mat_to_surface(const ModelSession &session, cv::Mat &image,
+                                   gddeploy::BufSurfWrapperPtr &surface) {
+    if (session.ReadsInput()) { convertMat2BufSurface(image, surface); }
+}
+
+}// namespace gddi
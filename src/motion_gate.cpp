@@ -0,0 +1,137 @@
+#include "motion_gate.h"
+#include <algorithm>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#define GDDI_MOTION_NEON
+#elif defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define GDDI_MOTION_SSE2
+#endif
+
+namespace gddi {
+
+namespace {
+
+// 每个缩略图像素在原图对应区域内按 kSamples x kSamples 均匀采样取平均, 不读取整幅图像
+constexpr int kSamples = 4;
+
+}// namespace
+
+MotionGate::MotionGate(const MotionGateConfig &config, const std::string &algo, const int32_t stream)
+    : config_(config), counter_(register_skip_counter(algo, "motion", stream)) {}
+
+void MotionGate::resize(const int img_w, const int img_h) {
+    img_w_ = img_w;
+    img_h_ = img_h;
+    thumb_w_ = std::clamp(config_.thumb_width, 1, img_w);
+    thumb_h_ = std::clamp(static_cast<int>(static_cast<int64_t>(img_h) * thumb_w_ / img_w), 1, img_h);
+
+    auto fill = [](std::vector<int32_t> &samples, const int thumb, const int length) {
+        samples.resize(thumb * kSamples);
+        for (int i = 0; i < thumb; i++) {
+            auto begin = static_cast<int64_t>(i) * length / thumb;
+            auto span = static_cast<int64_t>(i + 1) * length / thumb - begin;
+            for (int k = 0; k < kSamples; k++) {
+                samples[i * kSamples + k] = static_cast<int32_t>(begin + (2 * k + 1) * span / (2 * kSamples));
+            }
+        }
+    };
+    fill(sample_cols_, thumb_w_, img_w);
+    fill(sample_rows_, thumb_h_, img_h);
+
+    current_.assign(thumb_w_ * thumb_h_, 0);
+    reference_.assign(thumb_w_ * thumb_h_, 0);
+    has_reference_ = false;
+}
+
+void MotionGate::sample(const cv::Mat &image, uint8_t *thumb) const {
+    const auto channels = image.channels();
+    for (int y = 0; y < thumb_h_; y++) {
+        const uint8_t *rows[kSamples];
+        for (int k = 0; k < kSamples; k++) { rows[k] = image.ptr<uint8_t>(sample_rows_[y * kSamples + k]); }
+
+        for (int x = 0; x < thumb_w_; x++) {
+            uint32_t sum = 0;
+            for (const auto *row : rows) {
+                for (int k = 0; k < kSamples; k++) {
+                    const auto *pixel = row + sample_cols_[x * kSamples + k] * channels;
+                    // BGR 亮度 (0.114, 0.587, 0.299) * 256
+                    sum += channels >= 3 ? 29u * pixel[0] + 150u * pixel[1] + 77u * pixel[2] : 256u * pixel[0];
+                }
+            }
+            *thumb++ = static_cast<uint8_t>((sum + kSamples * kSamples * 128) / (kSamples * kSamples * 256));
+        }
+    }
+}
+
+bool MotionGate::still(const cv::Mat &image) {
+    if (image.empty() || image.depth() != CV_8U) {
+        counter_->record(false);
+        return false;
+    }
+    if (image.cols != img_w_ || image.rows != img_h_) { resize(image.cols, image.rows); }
+
+    sample(image, current_.data());
+
+    bool still = false;
+    if (has_reference_ && skipped_frames_ < config_.max_skip_frames) {
+        auto threshold = static_cast<uint8_t>(std::clamp(config_.pixel_threshold, 0, 255));
+        auto changed = count_changed_pixels(current_.data(), reference_.data(), current_.size(), threshold);
+        still = changed <= config_.area_threshold * current_.size();
+    }
+
+    if (still) {
+        skipped_frames_++;
+    } else {
+        current_.swap(reference_);
+        has_reference_ = true;
+        skipped_frames_ = 0;
+    }
+
+    counter_->record(still);
+    return still;
+}
+
+size_t count_changed_pixels_reference(const uint8_t *a, const uint8_t *b, const size_t size,
+                                      const uint8_t threshold) {
+    size_t count = 0;
+    for (size_t i = 0; i < size; i++) {
+        if ((a[i] > b[i] ? a[i] - b[i] : b[i] - a[i]) > threshold) { count++; }
+    }
+    return count;
+}
+
+size_t count_changed_pixels(const uint8_t *a, const uint8_t *b, const size_t size, const uint8_t threshold) {
+    size_t count = 0;
+    size_t i = 0;
+
+#if defined(GDDI_MOTION_NEON)
+    const auto vthreshold = vdupq_n_u8(threshold);
+    for (; i + 16 <= size; i += 16) {
+        auto changed = vcgtq_u8(vabdq_u8(vld1q_u8(a + i), vld1q_u8(b + i)), vthreshold);
+        count += vaddlvq_u8(vshrq_n_u8(changed, 7));
+    }
+#elif defined(GDDI_MOTION_SSE2)
+    // |a - b| > threshold 等价于 saturate(|a - b| - threshold) != 0; 未变化的字节按 8 位累加, 溢出前用 SAD 汇总
+    const auto vthreshold = _mm_set1_epi8(static_cast<char>(threshold));
+    const auto vzero = _mm_setzero_si128();
+    size_t unchanged = 0;
+    while (i + 16 <= size) {
+        auto vunchanged = _mm_setzero_si128();
+        for (auto end = std::min(size & ~size_t(15), i + 16 * 255); i < end; i += 16) {
+            auto va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+            auto vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+            auto diff = _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va));
+            vunchanged = _mm_sub_epi8(vunchanged, _mm_cmpeq_epi8(_mm_subs_epu8(diff, vthreshold), vzero));
+        }
+        auto sum = _mm_sad_epu8(vunchanged, vzero);
+        unchanged += _mm_cvtsi128_si32(sum) + _mm_extract_epi16(sum, 4);
+    }
+    count = i - unchanged;
+#endif
+
+    return count + count_changed_pixels_reference(a + i, b + i, size - i, threshold);
+}
+
+}// namespace gddi
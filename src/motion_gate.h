@@ -0,0 +1,99 @@
+/**
+ * @file motion_gate.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 运动门控: 缩小的亮度图帧差, 画面静止时跳过推理
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 by GDDI
+ *
+ */
+
+#pragma once
+
+#include "stage_timer.h"
+#include "struct_def.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gddi {
+
+/**
+ * @brief 每帧从原图采样出宽 thumb_width 的亮度缩略图, 与上一次推理的帧 (参考帧) 逐像素比较
+ *
+ * 与参考帧而不是上一帧比较: 缓慢移动的目标累积到阈值后仍会触发推理, 跳过的帧沿用的结果始终来自相近的画面.
+ * still 只由提交帧的线程调用 (同一视频流串行); keep/drop/last 在视频流锁内调用, 与 still 不共享状态.
+ */
+class MotionGate {
+public:
+    MotionGate(const MotionGateConfig &config, const std::string &algo, const int32_t stream);
+
+    /**
+     * @brief 判断本帧是否静止, 同时记录跳帧计数; 返回 false 时本帧成为新的参考帧
+     *
+     * @return true 画面静止, 跳过推理
+     */
+    bool still(const cv::Mat &image);
+
+    /**
+     * @brief 记录推理帧的结果, 静止帧沿用
+     *
+     */
+    template <typename Objects>
+    void keep(const Objects &objects) {
+        last_objects_.assign(objects.begin(), objects.end());
+        has_last_ = true;
+    }
+
+    /**
+     * @brief 推理帧没有需要沿用的结果 (例如时序统计未更新)
+     *
+     */
+    void drop() { has_last_ = false; }
+
+    /**
+     * @brief 静止帧沿用的结果
+     *
+     * @return const std::vector<AlgoObject>* 没有可沿用的结果或配置为输出空结果时为空
+     */
+    const std::vector<AlgoObject> *last() const {
+        return config_.reemit_last && has_last_ ? &last_objects_ : nullptr;
+    }
+
+private:
+    void resize(const int img_w, const int img_h);
+    void sample(const cv::Mat &image, uint8_t *thumb) const;
+
+    MotionGateConfig config_;
+    SkipCounter *counter_;
+
+    int img_w_{0};
+    int img_h_{0};
+    int thumb_w_{0};
+    int thumb_h_{0};
+    std::vector<int32_t> sample_cols_;// 每个缩略图像素在原图上采样的列 (每行 kSamples 个)
+    std::vector<int32_t> sample_rows_;
+    std::vector<uint8_t> current_;
+    std::vector<uint8_t> reference_;
+    bool has_reference_{false};
+    int skipped_frames_{0};
+
+    std::vector<AlgoObject> last_objects_;
+    bool has_last_{false};
+};
+
+/**
+ * @brief 两幅亮度图中差值大于 threshold 的像素数 (aarch64: NEON, x86: SSE2, 其他: 标量)
+ *
+ */
+size_t count_changed_pixels(const uint8_t *a, const uint8_t *b, const size_t size, const uint8_t threshold);
+
+/**
+ * @brief 标量实现, 用于校验 SIMD 实现
+ *
+ */
+size_t count_changed_pixels_reference(const uint8_t *a, const uint8_t *b, const size_t size,
+                                      const uint8_t threshold);
+
+}// namespace gddi
@@ -1,7 +1,11 @@
 #include "person_misc_algo.h"
 #include "bytetrack/BYTETracker.h"
+#include "model_session.h"
 #include "sequence_statistic.h"
 //#include "spdlog/spdlog.h"
+#include "speculative_infer.h"
+#include "stage_timer.h"
+#include "stream_state.h"
 #include "utils.h"
 #include <api/global_config.h>
 #include <bmcv_api_ext.h>
@@ -12,21 +16,27 @@ namespace gddi {
 
 class Person_MiscAlgo::Person_MiscAlgoPrivate {
 public:
-    std::unique_ptr<BYTETracker> tracker;
-    std::unique_ptr<SequenceStatistic> sequence_statistic;
+    StreamShards<> streams;
 
     std::mutex model_mutex;
     std::vector<ModelConfig> model_configs;
-    std::vector<std::unique_ptr<gddeploy::InferAPI>> model_impls;
+    std::vector<std::unique_ptr<ModelSession>> model_impls;
 };
 
 Person_MiscAlgo::Person_MiscAlgo(const Person_MiscAlgoConfig &config) : config_(config) {
     gddeploy::gddeploy_init("");
     private_ = std::make_unique<Person_MiscAlgoPrivate>();
 
-    private_->tracker = std::make_unique<BYTETracker>(0.3, 0.6, 0.8, 30);
-    private_->sequence_statistic =
-        std::make_unique<SequenceStatistic>(config_.statistics_interval, config_.statistics_threshold);
+    private_->streams.init([this](const int32_t stream_id) {
+        auto state = std::make_unique<StreamState>("Person_MiscAlgo", stream_id);
+        state->tracker = std::make_unique<BYTETracker>(0.3, 0.6, 0.8, 30);
+        state->sequence_statistic =
+            std::make_unique<SequenceStatistic>(config_.statistics_interval, config_.statistics_threshold);
+        if (config_.speculation.mode != SpeculationMode::kSequential) {
+            state->speculation = std::make_unique<SpeculationPolicy>(config_.speculation);
+        }
+        return state;
+    });
 }
 
 Person_MiscAlgo::~Person_MiscAlgo() {
@@ -39,31 +49,62 @@ bool Person_MiscAlgo::load_models(const std::vector<ModelConfig> &models) {
 
     for (const auto &model : models) {
         private_->model_configs.push_back(model);
-        auto algo_impl = std::make_unique<gddeploy::InferAPI>();
+        auto algo_impl = std::make_unique<ModelSession>("Person_MiscAlgo", private_->model_impls.size());
         if (algo_impl->Init("", model.path, model.license, gddeploy::ENUM_API_TYPE::ENUM_API_SESSION_API) != 0) {
             printf("Failed to load model: %s - %s", model.name.c_str(), model.path.c_str());
             return false;
         }
+        algo_impl->SetBatching(model.max_batch_size, model.batch_wait_us);
         private_->model_impls.emplace_back(std::move(algo_impl));
     }
 
     return true;
 }
 
-bool Person_MiscAlgo::sync_infer(const int64_t image_id, const cv::Mat &image, std::vector<AlgoObject> &statistic_objects) {
+bool Person_MiscAlgo::sync_infer(const int64_t image_id, const cv::Mat &image,
+                                 std::vector<AlgoObject> &statistic_objects) {
+    return sync_infer(0, image_id, image, statistic_objects);
+}
+
+bool Person_MiscAlgo::sync_infer(const int32_t stream_id, const int64_t image_id, const cv::Mat &image,
+                                 std::vector<AlgoObject> &statistic_objects) {
+    auto stream = private_->streams.get(stream_id);
+    if (!stream) {
+        printf("Invalid stream id: %d", stream_id);
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(stream->mutex);
+    auto arena = stream->arena.begin_frame();
+
+    StageTimer timer(stream->metrics, image_id);
     gddeploy::BufSurfWrapperPtr surface;
-    convertMat2BufSurface(const_cast<cv::Mat &>(image), surface);
+    convert_mat_to_surface(*private_->model_impls[0], const_cast<cv::Mat &>(image), surface);
+    timer.lap(AlgoStage::kPreprocess);
 
     auto in_package = gddeploy::Package::Create(1);
     in_package->data[0]->Set(surface);
 
+    // 没有行人的帧才需要异物模型: 这类帧占比高时两个模型同时提交, 检测到行人时丢弃异物模型结果
+    auto speculative = stream->speculation && stream->speculation->speculate();
     auto out_package = gddeploy::Package::Create(1);
-    if (private_->model_impls[0]->InferSync(in_package, out_package) != 0) { return false; }
+    auto out_package2 = gddeploy::Package::Create(1);
+    if (speculative) {
+        auto in_package2 = gddeploy::Package::Create(1);
+        in_package2->data[0]->Set(surface);
+        if (infer_concurrent(*private_->model_impls[0], in_package, out_package, *private_->model_impls[1], in_package2,
+                             out_package2, timer)
+            != 0) {
+            return false;
+        }
+    } else {
+        if (private_->model_impls[0]->InferSync(in_package, out_package) != 0) { return false; }
+        timer.lap(AlgoStage::kInferStage1);
+    }
 
-    std::vector<AlgoObject> infer_objects,infer_objects2;
+    FrameObjects infer_objects(arena), infer_objects2(arena);
     if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
         infer_objects = parse_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                           private_->model_configs[0].threshold);
+                                           private_->model_configs[0].threshold, arena);
     }
     bool flag = true;
     for(auto &item : infer_objects)
@@ -74,19 +115,18 @@ bool Person_MiscAlgo::sync_infer(const int64_t image_id, const cv::Mat &image, s
             statistic_objects.push_back(item);
         }
     }
+    if (stream->speculation) { stream->speculation->record(flag); }
     if(flag)
     {
-            auto in_package2 = gddeploy::Package::Create(1);
-            auto out_package2 = gddeploy::Package::Create(1);
-
-            gddeploy::BufSurfWrapperPtr surface_;
-            convertMat2BufSurface(const_cast<cv::Mat &>(image), surface_);
-            in_package2->data[0]->Set(surface_);
-
-            private_->model_impls[1]->InferSync(in_package2, out_package2);
+            if (!speculative) {
+                auto in_package2 = gddeploy::Package::Create(1);
+                in_package2->data[0]->Set(surface);
+                private_->model_impls[1]->InferSync(in_package2, out_package2);
+                timer.lap(AlgoStage::kInferStage2);
+            }
             if (!out_package2->data.empty() && out_package2->data[0]->HasMetaValue()) {
                 infer_objects2 = parse_infer_result(out_package2->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                                   private_->model_configs[1].threshold);
+                                                   private_->model_configs[1].threshold, arena);
             }
             for(auto &val : infer_objects2 )
             {
@@ -101,9 +141,9 @@ bool Person_MiscAlgo::sync_infer(const int64_t image_id, const cv::Mat &image, s
     return true;
 }
 
-std::vector<AlgoObject> Person_MiscAlgo::parse_infer_result(const gddeploy::InferResult &infer_result,
-                                                      const float threshold) {
-    std::vector<AlgoObject> objects;
+FrameObjects Person_MiscAlgo::parse_infer_result(const gddeploy::InferResult &infer_result, const float threshold,
+                                                 std::pmr::memory_resource *resource) {
+    FrameObjects objects(resource);
 
     for (auto result_type : infer_result.result_type) {
         if (result_type == gddeploy::GDD_RESULT_TYPE_DETECT) {
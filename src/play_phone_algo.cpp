@@ -1,7 +1,14 @@
 #include "play_phone_algo.h"
 #include "bytetrack/BYTETracker.h"
+#include "crop_planner.h"
+#include "frame_sequencer.h"
+#include "model_session.h"
+#include "result_delivery.h"
 #include "sequence_statistic.h"
 #include "spdlog/spdlog.h"
+#include "stage_timer.h"
+#include "stream_state.h"
+#include "tiled_infer.h"
 #include "utils.h"
 #include <api/global_config.h>
 #include <bmcv_api_ext.h>
@@ -13,26 +20,38 @@ namespace gddi {
 
 class PlayPhoneAlgo::PlayPhoneAlgoPrivate {
 public:
-    std::unique_ptr<BYTETracker> tracker;
-    std::unique_ptr<SequenceStatistic> sequence_statistic;
+    StreamShards<> streams;
+    PostprocessQueue postprocess;
 
     std::mutex model_mutex;
     std::vector<ModelConfig> model_configs;
-    std::vector<std::unique_ptr<gddeploy::InferAPI>> model_impls;
+    std::vector<std::unique_ptr<ModelSession>> model_impls;
 };
 
 PlayPhoneAlgo::PlayPhoneAlgo(const PlayPhoneAlgoConfig &config) : config_(config) {
     gddeploy::gddeploy_init("");
     private_ = std::make_unique<PlayPhoneAlgoPrivate>();
 
-    private_->tracker = std::make_unique<BYTETracker>(0.3, 0.6, 0.8, 30);
-    private_->sequence_statistic =
-        std::make_unique<SequenceStatistic>(config_.statistics_interval, config_.statistics_threshold);
+    private_->streams.init([this](const int32_t stream_id) {
+        auto state = std::make_unique<StreamState>("PlayPhoneAlgo", stream_id);
+        state->sequencer = std::make_unique<FrameSequencer>(private_->postprocess);
+        state->tracker = std::make_unique<BYTETracker>(0.3, 0.6, 0.8, 30);
+        if (auto region = config_.stream_regions.find(stream_id); region != config_.stream_regions.end()) {
+            state->region = std::make_unique<RegionMask>(region->second);
+        }
+        state->sequence_statistic =
+            std::make_unique<SequenceStatistic>(config_.statistics_interval, config_.statistics_threshold);
+        return state;
+    });
 }
 
 PlayPhoneAlgo::~PlayPhoneAlgo() {
     std::lock_guard<std::mutex> lock(private_->model_mutex);
     for (auto &impl : private_->model_impls) { impl->WaitTaskDone(); }
+    private_->streams.for_each([](StreamState &state) {
+        if (state.sequencer) { state.sequencer->flush(); }
+    });
+    private_->postprocess.wait_idle();
 }
 
 bool PlayPhoneAlgo::load_models(const std::vector<ModelConfig> &models) {
@@ -46,11 +65,12 @@ bool PlayPhoneAlgo::load_models(const std::vector<ModelConfig> &models) {
 
     private_->model_configs = models;
     for (const auto &model : models) {
-        auto algo_impl = std::make_unique<gddeploy::InferAPI>();
+        auto algo_impl = std::make_unique<ModelSession>("PlayPhoneAlgo", private_->model_impls.size());
         if (algo_impl->Init("", model.path, model.license, gddeploy::ENUM_API_TYPE::ENUM_API_SESSION_API) != 0) {
             spdlog::error("Failed to load model: {} - {}", model.name, model.path);
             return false;
         }
+        algo_impl->SetBatching(model.max_batch_size, model.batch_wait_us);
         private_->model_impls.emplace_back(std::move(algo_impl));
     }
 
@@ -58,116 +78,224 @@ bool PlayPhoneAlgo::load_models(const std::vector<ModelConfig> &models) {
 }
 
 void PlayPhoneAlgo::async_infer(const int64_t image_id, const cv::Mat &image, InferCallback infer_callback) {
+    async_infer_impl(image_id, image, std::move(infer_callback));
+}
+
+void PlayPhoneAlgo::async_infer_view(const int64_t image_id, const cv::Mat &image, ViewCallback view_callback) {
+    async_infer_impl(image_id, image, std::move(view_callback));
+}
+
+void PlayPhoneAlgo::async_infer_impl(const int64_t image_id, const cv::Mat &image,
+                                     const ResultDelivery &infer_callback) {
+    auto stream = private_->streams.get(0);
+    StageTimer timer(stream->metrics, image_id);
+
+    // 配置了检测区域裁剪时一阶段只推理区域的外接矩形, 推理区域大于分块边长时分块推理
+    // surface 不复制图像数据, infer_image 需保持到推理回调结束
+    auto infer_rect = stream->region ? stream->region->infer_rect(image.cols, image.rows) : cv::Rect();
+    auto tile_batch = make_tile_batch(*private_->model_impls[0], image, private_->model_configs[0],
+                                      stream->region.get(), infer_rect);
+    cv::Mat infer_image;
     gddeploy::BufSurfWrapperPtr surface;
-    convertMat2BufSurface(const_cast<cv::Mat &>(image), surface);
+    if (!tile_batch) {
+        infer_image = infer_rect.empty() ? image : image(infer_rect).clone();
+        convert_mat_to_surface(*private_->model_impls[0], infer_image, surface);
+    }
+    timer.lap(AlgoStage::kPreprocess);
 
-    auto package = gddeploy::Package::Create(1);
-    package->data[0]->Set(surface);
-    package->data[0]->SetAlgParam(
-        gddeploy::AlgDetectParam{private_->model_configs[0].threshold, private_->model_configs[0].nms_threshold});
+    auto package = tile_batch ? tile_batch->package : gddeploy::Package::Create(1);
+    if (!tile_batch) {
+        package->data[0]->Set(surface);
+        package->data[0]->SetAlgParam(
+            gddeploy::AlgDetectParam{private_->model_configs[0].threshold, private_->model_configs[0].nms_threshold});
+    }
 
     private_->model_impls[0]->InferAsync(
         package,
-        [this, image_id, image, infer_callback](gddeploy::Status status, gddeploy::PackagePtr data,
-                                                gddeploy::any user_data) {
-            std::vector<AlgoObject> person_objects;
-            if (!data->data.empty() && data->data[0]->HasMetaValue()) {
-                person_objects = parse_infer_result(data->data[0]->GetMetaData<gddeploy::InferResult>());
-            }
-
-            // 生成目标跟踪ID
-            std::vector<Object> objects;
-            for (const auto &item : person_objects) {
-                objects.push_back(Object{
-                    .class_id = item.class_id,
-                    .prob = item.score,
-                    .rect = {(float)item.rect.x, (float)item.rect.y, (float)item.rect.width, (float)item.rect.height},
-                    .label_name = item.label,
-                });
-            }
-
-            std::vector<AlgoObject> tracked_objects;
-            for (auto &item : private_->tracker->update(objects)) {
-                tracked_objects.emplace_back(
-                    AlgoObject{item.target_id, item.class_id, item.label_name, item.score,
-                               cv::Rect{(int)item.tlwh[0], (int)item.tlwh[1], (int)item.tlwh[2], (int)item.tlwh[3]},
-                               item.track_id});
-            }
-
-            // 如果一阶段没有检测目标，直接返回
-            if (tracked_objects.empty() && infer_callback) {
-                infer_callback(image_id, image, {});
-            } else {
-                // 裁剪目标 & 排序
-                std::sort(tracked_objects.begin(), tracked_objects.end(),
-                          [](const AlgoObject &item1, const AlgoObject &item2) {
-                              return item1.score > item2.score
-                                  && item1.rect.width * item1.rect.height > item2.rect.width * item2.rect.height;
-                          });
-
-                // 裁剪目标数
-                if (tracked_objects.size() > private_->model_configs[1].max_crop_number) {
-                    tracked_objects.resize(private_->model_configs[1].max_crop_number);
+        stream->sequencer->wrap(
+            image_id, image, infer_callback,
+            [this, stream, image_id, image, infer_image, tile_batch, infer_callback, offset = infer_rect.tl(),
+             timer_state = timer.handoff()](gddeploy::Status status, gddeploy::PackagePtr data,
+                                            gddeploy::any user_data) {
+                std::lock_guard<std::mutex> lock(stream->mutex);
+                auto arena = stream->arena.begin_frame();
+                StageTimer timer(timer_state);
+                timer.lap(AlgoStage::kInferStage1);
+
+                FrameObjects person_objects(arena);
+                if (tile_batch) {
+                    auto parse = [this, arena](const gddeploy::InferResult &result) {
+                        return parse_infer_result(result, arena);
+                    };
+                    person_objects = merge_tile_results(*tile_batch, data, parse,
+                                                        private_->model_configs[0].tile_merge_threshold, arena);
+                } else {
+                    if (!data->data.empty() && data->data[0]->HasMetaValue()) {
+                        person_objects =
+                            parse_infer_result(data->data[0]->GetMetaData<gddeploy::InferResult>(), arena);
+                    }
+                    translate_objects(person_objects, offset);
                 }
 
-                std::vector<AlgoObject> cover_objects;
-                for (const auto &item : tracked_objects) {
-                    auto rect = scale_crop_rect(image.cols, image.rows, item.rect,
-                                                private_->model_configs[1].crop_scale_factor);
-                    auto crop_image = image(rect).clone();
-
-                    auto in_package = gddeploy::Package::Create(1);
-                    auto out_package = gddeploy::Package::Create(1);
-
-                    gddeploy::BufSurfWrapperPtr crop_surface;
-                    convertMat2BufSurface(const_cast<cv::Mat &>(crop_image), crop_surface);
-                    in_package->data[0]->Set(crop_surface);
-                    in_package->data[0]->SetAlgParam(gddeploy::AlgDetectParam{
-                        private_->model_configs[1].threshold, private_->model_configs[1].nms_threshold});
+                // 生成目标跟踪ID
+                std::vector<Object> objects;
+                for (const auto &item : person_objects) {
+                    objects.push_back(Object{
+                        .class_id = item.class_id,
+                        .prob = item.score,
+                        .rect = {(float)item.rect.x, (float)item.rect.y, (float)item.rect.width,
+                                 (float)item.rect.height},
+                        .label_name = item.label,
+                    });
+                }
 
-                    private_->model_impls[1]->InferSync(in_package, out_package);
+                FrameObjects tracked_objects(arena);
+                for (auto &item : stream->tracker->update(objects)) {
+                    tracked_objects.emplace_back(
+                        AlgoObject{item.target_id, item.class_id, item.label_name, item.score,
+                                   cv::Rect{(int)item.tlwh[0], (int)item.tlwh[1], (int)item.tlwh[2], (int)item.tlwh[3]},
+                                   item.track_id});
+                }
 
-                    std::vector<AlgoObject> infer_objects;
-                    if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
-                        infer_objects = parse_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>());
+                // 检测区域外的目标不再裁剪推理和告警
+                if (stream->region) { stream->region->filter(tracked_objects); }
+
+                timer.lap(AlgoStage::kTrack);
+
+                // 如果一阶段没有检测目标，直接返回
+                if (tracked_objects.empty() && infer_callback) {
+                    infer_callback(image_id, image, {});
+                } else {
+                    // 裁剪目标 & 排序
+                    std::sort(tracked_objects.begin(), tracked_objects.end(),
+                              [](const AlgoObject &item1, const AlgoObject &item2) {
+                                  return item1.score > item2.score
+                                      && item1.rect.width * item1.rect.height > item2.rect.width * item2.rect.height;
+                              });
+
+                    // 裁剪目标数
+                    if (tracked_objects.size() > private_->model_configs[1].max_crop_number) {
+                        tracked_objects.resize(private_->model_configs[1].max_crop_number);
                     }
 
-                    // 赋值跟踪ID
-                    for (auto &obj : infer_objects) {
-                        obj.rect.x += rect.x;
-                        obj.rect.y += rect.y;
-                        obj.track_id = item.track_id;
+                    // 重叠的裁剪区域合并推理
+                    std::vector<cv::Rect> crop_rects;
+                    for (const auto &item : tracked_objects) {
+                        crop_rects.emplace_back(scale_crop_rect(image.cols, image.rows, item.rect,
+                                                                private_->model_configs[1].crop_scale_factor));
+                    }
+                    auto crop_groups =
+                        coalesce_crops(image.cols, image.rows, crop_rects, private_->model_configs[1].crop_merge_ratio);
+
+                    auto crop_batches = pack_crops(crop_groups, private_->model_configs[1].atlas_size);
+
+                    FrameObjects cover_objects(arena);
+                    for (const auto &batch : crop_batches) {
+                        auto crop_image = compose_crops(image, crop_groups, batch);
+
+                        auto in_package = gddeploy::Package::Create(1);
+                        auto out_package = gddeploy::Package::Create(1);
+
+                        gddeploy::BufSurfWrapperPtr crop_surface;
+                        convert_mat_to_surface(*private_->model_impls[1], const_cast<cv::Mat &>(crop_image),
+                                               crop_surface);
+                        timer.lap(AlgoStage::kCrop);
+                        in_package->data[0]->Set(crop_surface);
+                        in_package->data[0]->SetAlgParam(gddeploy::AlgDetectParam{
+                            private_->model_configs[1].threshold, private_->model_configs[1].nms_threshold});
+
+                        auto ret = private_->model_impls[1]->InferSync(in_package, out_package);
+                        timer.lap(AlgoStage::kInferStage2);
+                        if (ret != 0) { continue; }// 推理失败 (如排队超时) 的批跳过
+
+                        FrameObjects infer_objects(arena);
+                        if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
+                            infer_objects =
+                                parse_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(), arena);
+                        }
+
+                        // 按所在拼块和包含关系分配给各目标, 换算到原图座标, 赋值跟踪ID
+                        for (const auto &tile : batch.tiles) {
+                            auto &group = crop_groups[tile.group];
+                            for (auto member : group.members) {
+                                auto member_objects =
+                                    split_crop_objects(infer_objects, batch, tile, group, crop_rects[member], arena);
+                                for (auto &obj : member_objects) { obj.track_id = tracked_objects[member].track_id; }
+
+                                // 找到重叠的目标
+                                auto objects = find_cover_objects(member_objects, config_.include_labels,
+                                                                  config_.exclude_labels, config_.map_label,
+                                                                  config_.cover_threshold, arena);
+                                cover_objects.insert(cover_objects.end(), objects.begin(), objects.end());
+                            }
+                        }
                     }
 
-                    // 找到重叠的目标
-                    auto objects = find_cover_objects(infer_objects, config_.include_labels, config_.exclude_labels,
-                                                      config_.map_label, config_.cover_threshold);
-                    cover_objects.insert(cover_objects.end(), objects.begin(), objects.end());
-                }
+                    // 裁剪区域重叠时去掉重复检出的目标, 保留给检出位置所在的跟踪目标
+                    suppress_duplicate_objects(cover_objects, tracked_objects,
+                                               private_->model_configs[1].crop_nms_threshold);
 
-                auto statistic_objects = private_->sequence_statistic->update(cover_objects);
+                    auto statistic_objects = stream->sequence_statistic->update(cover_objects);
+                    timer.lap(AlgoStage::kStatistic);
 
-                if (infer_callback) { infer_callback(image_id, image, statistic_objects); }
-            }
-        });
+                    if (infer_callback) { infer_callback(image_id, image, statistic_objects); }
+                    timer.lap(AlgoStage::kCallback);
+                }
+            }));
 }
 
 bool PlayPhoneAlgo::sync_infer(const int64_t image_id, const cv::Mat &image,
                                std::vector<AlgoObject> &statistic_objects) {
+    return sync_infer(0, image_id, image, statistic_objects);
+}
+
+bool PlayPhoneAlgo::sync_infer(const int32_t stream_id, const int64_t image_id, const cv::Mat &image,
+                               std::vector<AlgoObject> &statistic_objects) {
+    auto stream = private_->streams.get(stream_id);
+    if (!stream) {
+        spdlog::error("Invalid stream id: {}", stream_id);
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(stream->mutex);
+    auto arena = stream->arena.begin_frame();
+
+    StageTimer timer(stream->metrics, image_id);
+
+    // 配置了检测区域裁剪时一阶段只推理区域的外接矩形, 推理区域大于分块边长时分块推理
+    auto infer_rect = stream->region ? stream->region->infer_rect(image.cols, image.rows) : cv::Rect();
+    auto tile_batch = make_tile_batch(*private_->model_impls[0], image, private_->model_configs[0],
+                                      stream->region.get(), infer_rect);
+    cv::Mat infer_image;
     gddeploy::BufSurfWrapperPtr surface;
-    convertMat2BufSurface(const_cast<cv::Mat &>(image), surface);
+    if (!tile_batch) {
+        infer_image = infer_rect.empty() ? image : image(infer_rect).clone();
+        convert_mat_to_surface(*private_->model_impls[0], infer_image, surface);
+    }
+    timer.lap(AlgoStage::kPreprocess);
 
+    FrameObjects infer_objects(arena);
     auto in_package = gddeploy::Package::Create(1);
-    in_package->data[0]->Set(surface);
-    in_package->data[0]->SetAlgParam(
-        gddeploy::AlgDetectParam{private_->model_configs[0].threshold, private_->model_configs[0].nms_threshold});
-
     auto out_package = gddeploy::Package::Create(1);
-    if (private_->model_impls[0]->InferSync(in_package, out_package) != 0) { return false; }
+    if (tile_batch) {
+        auto parse = [this, arena](const gddeploy::InferResult &result) { return parse_infer_result(result, arena); };
+        if (infer_tiles(*private_->model_impls[0], *tile_batch, parse, private_->model_configs[0].tile_merge_threshold,
+                        infer_objects)
+            != 0) {
+            return false;
+        }
+        timer.lap(AlgoStage::kInferStage1);
+    } else {
+        in_package->data[0]->Set(surface);
+        in_package->data[0]->SetAlgParam(
+            gddeploy::AlgDetectParam{private_->model_configs[0].threshold, private_->model_configs[0].nms_threshold});
+
+        if (private_->model_impls[0]->InferSync(in_package, out_package) != 0) { return false; }
+        timer.lap(AlgoStage::kInferStage1);
 
-    std::vector<AlgoObject> infer_objects;
-    if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
-        infer_objects = parse_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>());
+        if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
+            infer_objects = parse_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(), arena);
+        }
+        translate_objects(infer_objects, infer_rect.tl());
     }
 
     // 生成目标跟踪ID
@@ -181,13 +309,18 @@ bool PlayPhoneAlgo::sync_infer(const int64_t image_id, const cv::Mat &image,
         });
     }
 
-    std::vector<AlgoObject> tracked_objects;
-    for (auto &item : private_->tracker->update(objects)) {
+    FrameObjects tracked_objects(arena);
+    for (auto &item : stream->tracker->update(objects)) {
         tracked_objects.emplace_back(AlgoObject{
             item.target_id, item.class_id, item.label_name, item.score,
             cv::Rect{(int)item.tlwh[0], (int)item.tlwh[1], (int)item.tlwh[2], (int)item.tlwh[3]}, item.track_id});
     }
 
+    // 检测区域外的目标不再裁剪推理和告警
+    if (stream->region) { stream->region->filter(tracked_objects); }
+
+    timer.lap(AlgoStage::kTrack);
+
     // 二阶段检测
     if (!tracked_objects.empty()) {
         // 裁剪目标 & 排序
@@ -201,47 +334,70 @@ bool PlayPhoneAlgo::sync_infer(const int64_t image_id, const cv::Mat &image,
             tracked_objects.resize(private_->model_configs[1].max_crop_number);
         }
 
-        std::vector<AlgoObject> cover_objects;
+        // 重叠的裁剪区域合并推理
+        std::vector<cv::Rect> crop_rects;
         for (const auto &item : tracked_objects) {
-            auto rect =
-                scale_crop_rect(image.cols, image.rows, item.rect, private_->model_configs[1].crop_scale_factor);
-            auto crop_image = image(rect).clone();
+            crop_rects.emplace_back(
+                scale_crop_rect(image.cols, image.rows, item.rect, private_->model_configs[1].crop_scale_factor));
+        }
+        auto crop_groups =
+            coalesce_crops(image.cols, image.rows, crop_rects, private_->model_configs[1].crop_merge_ratio);
+
+        auto crop_batches = pack_crops(crop_groups, private_->model_configs[1].atlas_size);
+
+        FrameObjects cover_objects(arena);
+        for (const auto &batch : crop_batches) {
+            auto crop_image = compose_crops(image, crop_groups, batch);
 
             in_package = gddeploy::Package::Create(1);
             out_package = gddeploy::Package::Create(1);
 
             gddeploy::BufSurfWrapperPtr crop_surface;
-            convertMat2BufSurface(const_cast<cv::Mat &>(crop_image), crop_surface);
+            convert_mat_to_surface(*private_->model_impls[1], const_cast<cv::Mat &>(crop_image), crop_surface);
+            timer.lap(AlgoStage::kCrop);
             in_package->data[0]->Set(crop_surface);
             in_package->data[0]->SetAlgParam(gddeploy::AlgDetectParam{private_->model_configs[1].threshold,
                                                                       private_->model_configs[1].nms_threshold});
 
-            private_->model_impls[1]->InferSync(in_package, out_package);
+            auto ret = private_->model_impls[1]->InferSync(in_package, out_package);
+            timer.lap(AlgoStage::kInferStage2);
+            if (ret != 0) { continue; }// 推理失败 (如排队超时) 的批跳过
+
+            // 每批单独解析, 不沿用一阶段或上一批的结果
+            FrameObjects crop_objects(arena);
             if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
-                infer_objects = parse_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>());
+                crop_objects = parse_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(), arena);
             }
 
-            // 赋值跟踪ID
-            for (auto &obj : infer_objects) {
-                obj.rect.x += rect.x;
-                obj.rect.y += rect.y;
-                obj.track_id = item.track_id;
-            }
+            // 按所在拼块和包含关系分配给各目标, 换算到原图座标, 赋值跟踪ID
+            for (const auto &tile : batch.tiles) {
+                auto &group = crop_groups[tile.group];
+                for (auto member : group.members) {
+                    auto member_objects =
+                        split_crop_objects(crop_objects, batch, tile, group, crop_rects[member], arena);
+                    for (auto &obj : member_objects) { obj.track_id = tracked_objects[member].track_id; }
 
-            // 找到重叠的目标
-            auto objects = find_cover_objects(infer_objects, config_.include_labels, config_.exclude_labels,
-                                              config_.map_label, config_.cover_threshold);
-            cover_objects.insert(cover_objects.end(), objects.begin(), objects.end());
+                    // 找到重叠的目标
+                    auto objects = find_cover_objects(member_objects, config_.include_labels, config_.exclude_labels,
+                                                      config_.map_label, config_.cover_threshold, arena);
+                    cover_objects.insert(cover_objects.end(), objects.begin(), objects.end());
+                }
+            }
         }
 
-        statistic_objects = private_->sequence_statistic->update(cover_objects);
+        // 裁剪区域重叠时去掉重复检出的目标, 保留给检出位置所在的跟踪目标
+        suppress_duplicate_objects(cover_objects, tracked_objects, private_->model_configs[1].crop_nms_threshold);
+
+        statistic_objects = stream->sequence_statistic->update(cover_objects);
+        timer.lap(AlgoStage::kStatistic);
     }
 
     return true;
 }
 
-std::vector<AlgoObject> PlayPhoneAlgo::parse_infer_result(const gddeploy::InferResult &infer_result) {
-    std::vector<AlgoObject> objects;
+FrameObjects PlayPhoneAlgo::parse_infer_result(const gddeploy::InferResult &infer_result,
+                                               std::pmr::memory_resource *resource) {
+    FrameObjects objects(resource);
 
     for (auto result_type : infer_result.result_type) {
         if (result_type == gddeploy::GDD_RESULT_TYPE_DETECT) {
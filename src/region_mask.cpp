@@ -0,0 +1,86 @@
+#include "region_mask.h"
+#include "frame_arena.h"
+#include "utils.h"
+
+namespace gddi {
+
+RegionMask::RegionMask(const RegionConfig &config, const int cell_shift)
+    : cell_shift_(cell_shift), outside_(config.include_regions.empty()) {
+    int max_x = -1;
+    int max_y = -1;
+    for (const auto *regions : {&config.include_regions, &config.exclude_regions}) {
+        for (const auto &region : *regions) {
+            for (const auto &point : region) {
+                max_x = std::max(max_x, point.x);
+                max_y = std::max(max_y, point.y);
+            }
+        }
+    }
+    if (max_x < 0 || max_y < 0) { return; }
+
+    cols_ = (max_x >> cell_shift_) + 1;
+    rows_ = (max_y >> cell_shift_) + 1;
+    cells_.assign(cols_ * rows_, outside_ ? 1 : 0);
+
+    auto cell_size = 1 << cell_shift_;
+    auto fill = [&](const std::vector<cv::Point> &region, const uint8_t value) {
+        if (region.size() < 3) { return; }
+        // 顶点顺序不限, convert_polygon 统一方向并闭合
+        auto poly = convert_polygon(region);
+
+        // 只遍历多边形外接矩形内的格子, 以格子中心判断
+        int min_x = max_x, min_y = max_y, end_x = 0, end_y = 0;
+        for (const auto &point : region) {
+            min_x = std::min(min_x, point.x);
+            min_y = std::min(min_y, point.y);
+            end_x = std::max(end_x, point.x);
+            end_y = std::max(end_y, point.y);
+        }
+        auto col_begin = std::max(min_x, 0) >> cell_shift_;
+        auto row_begin = std::max(min_y, 0) >> cell_shift_;
+        auto col_end = end_x >> cell_shift_;
+        auto row_end = end_y >> cell_shift_;
+        for (int row = row_begin; row <= row_end; row++) {
+            for (int col = col_begin; col <= col_end; col++) {
+                point_type center(col * cell_size + cell_size * 0.5f, row * cell_size + cell_size * 0.5f);
+                if (bg::covered_by(center, poly)) { cells_[row * cols_ + col] = value; }
+            }
+        }
+    };
+
+    for (const auto &region : config.include_regions) { fill(region, 1); }
+    for (const auto &region : config.exclude_regions) { fill(region, 0); }
+
+    if (config.crop_infer) {
+        for (const auto &region : config.include_regions) {
+            for (const auto &point : region) { infer_bounds_ |= cv::Rect(point.x, point.y, 1, 1); }
+        }
+    }
+}
+
+bool RegionMask::intersects(const cv::Rect &rect) const {
+    if (rect.empty()) { return false; }
+    if (outside_ && (rect.x < 0 || rect.y < 0)) { return true; }
+
+    auto col_begin = std::max(rect.x, 0) >> cell_shift_;
+    auto row_begin = std::max(rect.y, 0) >> cell_shift_;
+    auto col_end = (rect.x + rect.width - 1) >> cell_shift_;
+    auto row_end = (rect.y + rect.height - 1) >> cell_shift_;
+    if (outside_ && (col_end >= cols_ || row_end >= rows_)) { return true; }
+
+    for (int row = row_begin; row <= std::min(row_end, rows_ - 1); row++) {
+        auto cells = cells_.data() + row * cols_;
+        for (int col = col_begin; col <= std::min(col_end, cols_ - 1); col++) {
+            if (cells[col]) { return true; }
+        }
+    }
+    return false;
+}
+
+cv::Rect RegionMask::infer_rect(const int img_w, const int img_h) const {
+    auto rect = infer_bounds_ & cv::Rect(0, 0, img_w, img_h);
+    if (rect.empty() || rect.area() * 10 >= static_cast<int64_t>(img_w) * img_h * 9) { return {}; }
+    return scale_crop_rect(img_w, img_h, rect);
+}
+
+}// namespace gddi
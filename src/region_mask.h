@@ -0,0 +1,83 @@
+/**
+ * @file region_mask.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 检测区域 / 屏蔽区域的低分辨率位图, 按点查询 O(1)
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 by GDDI
+ *
+ */
+
+#pragma once
+
+#include "struct_def.h"
+#include <cstdint>
+#include <vector>
+
+namespace gddi {
+
+/**
+ * @brief 创建时把多边形栅格化为 (1 << cell_shift) 像素一格的位图, 之后只查表
+ *
+ * 格子中心落在检测区域内且不在屏蔽区域内时该格有效; 精度为一个格子, 告警区域边界不需要更高精度.
+ * 位图只覆盖多边形的外接范围, 范围外的点: 配置了检测区域时无效, 否则有效.
+ */
+class RegionMask {
+public:
+    explicit RegionMask(const RegionConfig &config, const int cell_shift = 3);
+
+    bool contains(const int x, const int y) const {
+        if (x < 0 || y < 0) { return outside_; }
+        auto col = x >> cell_shift_;
+        auto row = y >> cell_shift_;
+        if (col >= cols_ || row >= rows_) { return outside_; }
+        return cells_[row * cols_ + col] != 0;
+    }
+
+    /**
+     * @brief 以目标框中心判断
+     *
+     */
+    bool contains(const cv::Rect &rect) const {
+        return contains(rect.x + rect.width / 2, rect.y + rect.height / 2);
+    }
+
+    /**
+     * @brief 矩形内是否有有效格子, 用于跳过检测区域外的分块
+     *
+     */
+    bool intersects(const cv::Rect &rect) const;
+
+    /**
+     * @brief 一阶段推理区域: 检测区域的外接矩形 (按 scale_crop_rect 对齐, 限制在图像内)
+     *
+     * @return cv::Rect 未开启 crop_infer 或区域接近全图 (裁剪没有收益) 时为空, 推理整幅图像
+     */
+    cv::Rect infer_rect(const int img_w, const int img_h) const;
+
+    /**
+     * @brief 删除中心不在区域内的目标, 保持原有顺序
+     *
+     */
+    template <typename Objects>
+    void filter(Objects &objects) const {
+        size_t count = 0;
+        for (size_t i = 0; i < objects.size(); i++) {
+            if (!contains(objects[i].rect)) { continue; }
+            if (count != i) { objects[count] = std::move(objects[i]); }
+            count++;
+        }
+        objects.erase(objects.begin() + count, objects.end());
+    }
+
+private:
+    int cell_shift_;
+    int cols_{0};
+    int rows_{0};
+    bool outside_;
+    std::vector<uint8_t> cells_;
+    cv::Rect infer_bounds_;
+};
+
+}// namespace gddi
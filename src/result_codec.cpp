@@ -0,0 +1,226 @@
+#include "result_codec.h"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+namespace gddi {
+
+namespace {
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "result codec assumes a little-endian host");
+
+constexpr uint32_t kMagic = 0x53524447;// "GDRS"
+
+enum RecordType : uint16_t {
+    kFrame = 1,
+    kLabel = 2,
+};
+
+struct RecordHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t type;
+    uint32_t size;// 含头和填充
+    uint32_t count;
+};
+
+struct FrameInfo {
+    int64_t frame_id;
+    int64_t timestamp;
+    int32_t stream_id;
+    uint32_t reserved;
+};
+
+struct LabelInfo {
+    int32_t label_id;
+    uint32_t length;
+};
+
+static_assert(sizeof(RecordHeader) == 16, "unexpected RecordHeader layout");
+static_assert(sizeof(FrameInfo) == 24, "unexpected FrameInfo layout");
+static_assert(sizeof(ObjectView) == 36, "unexpected ObjectView layout");
+
+// 标签ID上限, 防止损坏数据导致标签表过大
+constexpr int32_t kMaxLabelId = 1 << 20;
+
+inline size_t align8(const size_t size) { return (size + 7) & ~size_t(7); }
+
+inline void append(std::vector<uint8_t> &buffer, const void *data, const size_t size) {
+    auto bytes = static_cast<const uint8_t *>(data);
+    buffer.insert(buffer.end(), bytes, bytes + size);
+}
+
+}// namespace
+
+ResultWriter::ResultWriter(const int fd, const size_t buffer_size)
+    : fd_(fd), buffer_size_(buffer_size), output_(staging_) {
+    staging_.reserve(buffer_size_);
+}
+
+ResultWriter::ResultWriter(std::vector<uint8_t> &buffer) : output_(buffer) {}
+
+ResultWriter::~ResultWriter() { flush(); }
+
+bool ResultWriter::write(const int64_t frame_id, const int64_t timestamp, const int32_t stream_id,
+                         const ObjectSpan &objects) {
+    if (failed_) { return false; }
+
+    auto frame_offset = begin_frame(frame_id, timestamp, stream_id, objects.size());
+    for (const auto &object : objects) { append_object(object); }
+    return end_frame(frame_offset);
+}
+
+bool ResultWriter::write(const int64_t frame_id, const int64_t timestamp, const int32_t stream_id,
+                         const std::vector<AlgoObject> &objects) {
+    if (failed_) { return false; }
+
+    auto frame_offset = begin_frame(frame_id, timestamp, stream_id, objects.size());
+    for (const auto &item : objects) {
+        append_object(ObjectView{item.target_id, item.class_id, label_id(item.label), item.score, item.rect.x,
+                                 item.rect.y, item.rect.width, item.rect.height, item.track_id});
+    }
+    return end_frame(frame_offset);
+}
+
+bool ResultWriter::flush() {
+    if (fd_ < 0 || failed_) { return !failed_; }
+
+    size_t written = 0;
+    while (written < staging_.size()) {
+        auto ret = ::write(fd_, staging_.data() + written, staging_.size() - written);
+        if (ret < 0) {
+            if (errno == EINTR) { continue; }
+            spdlog::error("Failed to write results: {}", std::strerror(errno));
+            failed_ = true;
+            return false;
+        }
+        written += ret;
+    }
+
+    staging_.clear();
+    return true;
+}
+
+size_t ResultWriter::begin_frame(const int64_t frame_id, const int64_t timestamp, const int32_t stream_id,
+                                 const size_t num_objects) {
+    auto frame_offset = output_.size();
+    auto record_size = align8(sizeof(RecordHeader) + sizeof(FrameInfo) + num_objects * sizeof(ObjectView));
+
+    RecordHeader header{kMagic, kResultCodecVersion, kFrame, static_cast<uint32_t>(record_size),
+                        static_cast<uint32_t>(num_objects)};
+    FrameInfo info{frame_id, timestamp, stream_id, 0};
+    append(output_, &header, sizeof(header));
+    append(output_, &info, sizeof(info));
+
+    pending_labels_.clear();
+    return frame_offset;
+}
+
+void ResultWriter::append_object(const ObjectView &object) {
+    append(output_, &object, sizeof(object));
+
+    if (object.label_id < 0) { return; }
+    if (static_cast<size_t>(object.label_id) >= labels_written_.size()) { labels_written_.resize(object.label_id + 1); }
+    if (!labels_written_[object.label_id]) {
+        labels_written_[object.label_id] = true;
+        pending_labels_.push_back(object.label_id);
+    }
+}
+
+bool ResultWriter::end_frame(const size_t frame_offset) {
+    output_.resize(align8(output_.size()));
+
+    // 新标签记录追加在帧记录之后, 再整体移到帧记录之前 (只在标签首次出现时发生)
+    if (!pending_labels_.empty()) {
+        auto labels_offset = output_.size();
+        for (auto id : pending_labels_) {
+            const auto &name = label_name(id);
+            auto record_size = align8(sizeof(RecordHeader) + sizeof(LabelInfo) + name.size());
+
+            RecordHeader header{kMagic, kResultCodecVersion, kLabel, static_cast<uint32_t>(record_size), 1};
+            LabelInfo info{id, static_cast<uint32_t>(name.size())};
+            append(output_, &header, sizeof(header));
+            append(output_, &info, sizeof(info));
+            append(output_, name.data(), name.size());
+            output_.resize(align8(output_.size()));
+        }
+        std::rotate(output_.begin() + frame_offset, output_.begin() + labels_offset, output_.end());
+    }
+
+    if (fd_ >= 0 && staging_.size() >= buffer_size_) { return flush(); }
+    return true;
+}
+
+ResultReader::ResultReader(const void *data, const size_t size)
+    : data_(static_cast<const uint8_t *>(data)), size_(size) {
+    if (reinterpret_cast<uintptr_t>(data_) % alignof(ObjectView) != 0) { fail("Unaligned input buffer"); }
+}
+
+bool ResultReader::next(FrameResult &frame) {
+    if (!error_.empty()) { return false; }
+
+    while (offset_ < size_) {
+        if (size_ - offset_ < sizeof(RecordHeader)) { return fail("Truncated record header"); }
+
+        RecordHeader header;
+        std::memcpy(&header, data_ + offset_, sizeof(header));
+        if (header.magic != kMagic) { return fail("Bad record magic"); }
+        if (header.version > kResultCodecVersion) {
+            return fail("Unsupported record version " + std::to_string(header.version));
+        }
+        if (header.size < sizeof(RecordHeader) || header.size % 8 != 0 || header.size > size_ - offset_) {
+            return fail("Bad record size");
+        }
+
+        auto payload = data_ + offset_ + sizeof(RecordHeader);
+        auto payload_size = header.size - sizeof(RecordHeader);
+        offset_ += header.size;
+
+        if (header.type == kFrame) {
+            if (payload_size < sizeof(FrameInfo)
+                || (payload_size - sizeof(FrameInfo)) / sizeof(ObjectView) < header.count) {
+                return fail("Bad frame record");
+            }
+
+            FrameInfo info;
+            std::memcpy(&info, payload, sizeof(info));
+            frame.frame_id = info.frame_id;
+            frame.timestamp = info.timestamp;
+            frame.stream_id = info.stream_id;
+            frame.objects =
+                ObjectSpan(reinterpret_cast<const ObjectView *>(payload + sizeof(FrameInfo)), header.count);
+            return true;
+        }
+
+        if (header.type == kLabel) {
+            LabelInfo info;
+            if (payload_size < sizeof(LabelInfo)) { return fail("Bad label record"); }
+            std::memcpy(&info, payload, sizeof(info));
+            if (info.label_id < 0 || info.label_id >= kMaxLabelId || info.length > payload_size - sizeof(LabelInfo)) {
+                return fail("Bad label record");
+            }
+
+            if (static_cast<size_t>(info.label_id) >= labels_.size()) { labels_.resize(info.label_id + 1); }
+            labels_[info.label_id].assign(reinterpret_cast<const char *>(payload + sizeof(LabelInfo)), info.length);
+        }
+
+        // 未知类型的记录 (新版本扩展) 直接跳过
+    }
+
+    return false;
+}
+
+const std::string &ResultReader::label(const int32_t label_id) const {
+    static const std::string kEmpty;
+    if (label_id < 0 || static_cast<size_t>(label_id) >= labels_.size()) { return kEmpty; }
+    return labels_[label_id];
+}
+
+bool ResultReader::fail(const std::string &error) {
+    error_ = error;
+    return false;
+}
+
+}// namespace gddi
@@ -0,0 +1,94 @@
+#include "result_delivery.h"
+#include <mutex>
+
+namespace gddi {
+
+struct ResultBuffer::Block {
+    std::vector<ObjectView> objects;
+};
+
+namespace {
+
+// 缓冲池最多保留的空闲缓冲区, 超出时直接释放
+constexpr size_t kMaxFreeBlocks = 64;
+
+}// namespace
+
+// 进程内共享的结果缓冲池, 缓冲区归还时保留容量
+class ResultBufferPool {
+public:
+    static ResultBufferPool &instance() {
+        static ResultBufferPool pool;
+        return pool;
+    }
+
+    ~ResultBufferPool() {
+        for (auto block : free_blocks_) { delete block; }
+    }
+
+    ResultBuffer::Block *acquire() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!free_blocks_.empty()) {
+                auto block = free_blocks_.back();
+                free_blocks_.pop_back();
+                return block;
+            }
+        }
+        return new ResultBuffer::Block();
+    }
+
+    void release(ResultBuffer::Block *block) {
+        block->objects.clear();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (free_blocks_.size() < kMaxFreeBlocks) {
+                free_blocks_.push_back(block);
+                return;
+            }
+        }
+        delete block;
+    }
+
+private:
+    ResultBufferPool() { free_blocks_.reserve(kMaxFreeBlocks); }
+
+    std::mutex mutex_;
+    std::vector<ResultBuffer::Block *> free_blocks_;
+};
+
+ResultBuffer &ResultBuffer::operator=(ResultBuffer &&other) noexcept {
+    if (this != &other) {
+        release();
+        block_ = other.block_;
+        other.block_ = nullptr;
+    }
+    return *this;
+}
+
+ObjectSpan ResultBuffer::objects() const {
+    if (!block_) { return {}; }
+    return {block_->objects.data(), block_->objects.size()};
+}
+
+void ResultBuffer::release() {
+    if (!block_) { return; }
+    ResultBufferPool::instance().release(block_);
+    block_ = nullptr;
+}
+
+void ResultDelivery::deliver_view(const int64_t image_id, const cv::Mat &image, const AlgoObject *objects,
+                                  const size_t num_objects) const {
+    ResultBuffer buffer(ResultBufferPool::instance().acquire());
+
+    auto &views = buffer.block_->objects;
+    views.reserve(num_objects);
+    for (auto item = objects; item != objects + num_objects; ++item) {
+        views.push_back(ObjectView{item->target_id, item->class_id, label_id(item->label), item->score, item->rect.x,
+                                   item->rect.y, item->rect.width, item->rect.height, item->track_id});
+    }
+
+    view_callback_(image_id, image, buffer.objects(), buffer);
+}
+
+}// namespace gddi
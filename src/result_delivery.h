@@ -0,0 +1,59 @@
+/**
+ * @file result_delivery.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 推理结果交付 (InferCallback / ViewCallback 统一入口)
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 by GDDI
+ *
+ */
+
+#pragma once
+
+#include "result_view.h"
+#include "struct_def.h"
+#include <vector>
+
+namespace gddi {
+
+/**
+ * @brief 持有两种回调之一, 算法内部按原来的 infer_callback 用法调用
+ *
+ * InferCallback: std::vector 结果直接传入, 其他容器 (FrameObjects) 拷贝为 std::vector;
+ * ViewCallback: 结果转换为 ObjectView 写入池化缓冲区, 不构造 std::string
+ */
+class ResultDelivery {
+public:
+    ResultDelivery() = default;
+    ResultDelivery(InferCallback callback) : infer_callback_(std::move(callback)) {}
+    ResultDelivery(ViewCallback callback) : view_callback_(std::move(callback)) {}
+
+    explicit operator bool() const { return infer_callback_ || view_callback_; }
+
+    void operator()(const int64_t image_id, const cv::Mat &image, const std::vector<AlgoObject> &objects) const {
+        if (infer_callback_) {
+            infer_callback_(image_id, image, objects);
+        } else {
+            deliver_view(image_id, image, objects.data(), objects.size());
+        }
+    }
+
+    template <typename Objects>
+    void operator()(const int64_t image_id, const cv::Mat &image, const Objects &objects) const {
+        if (infer_callback_) {
+            infer_callback_(image_id, image, std::vector<AlgoObject>(objects.begin(), objects.end()));
+        } else {
+            deliver_view(image_id, image, objects.data(), objects.size());
+        }
+    }
+
+private:
+    void deliver_view(const int64_t image_id, const cv::Mat &image, const AlgoObject *objects,
+                      const size_t num_objects) const;
+
+    InferCallback infer_callback_;
+    ViewCallback view_callback_;
+};
+
+}// namespace gddi
@@ -1,6 +1,11 @@
 #include "safety_belt_algo.h"
 #include "core/infer_server.h"
+#include "frame_sequencer.h"
+#include "model_session.h"
+#include "result_delivery.h"
 #include "spdlog/spdlog.h"
+#include "stage_timer.h"
+#include "stream_state.h"
 #include "utils.h"
 #include <api/global_config.h>
 #include <bmcv_api_ext.h>
@@ -13,24 +18,41 @@ namespace gddi {
 
 class SafetyBeltAlgo::SafetyBeltAlgoPrivate {
 public:
-    std::vector<int> light_group;
-    std::time_t last_light_time{0};
+    struct SafetyBeltStreamState : StreamState {
+        using StreamState::StreamState;
 
-    std::vector<std::pair<int, int>> safety_belt_group;
+        std::vector<int> light_group;
+        std::time_t last_light_time{0};
+
+        std::vector<std::pair<int, int>> safety_belt_group;
+    };
+
+    StreamShards<SafetyBeltStreamState> streams;
+    PostprocessQueue postprocess;
 
     std::mutex model_mutex;
     std::vector<ModelConfig> model_configs;
-    std::vector<std::unique_ptr<gddeploy::InferAPI>> model_impls;
+    std::vector<std::unique_ptr<ModelSession>> model_impls;
 };
 
 SafetyBeltAlgo::SafetyBeltAlgo(const SafetyBeltAlgoConfig &config) : config_(config) {
     gddeploy::gddeploy_init("");
     private_ = std::make_unique<SafetyBeltAlgoPrivate>();
+
+    private_->streams.init([this](const int32_t stream_id) {
+        auto state = std::make_unique<SafetyBeltAlgoPrivate::SafetyBeltStreamState>("SafetyBeltAlgo", stream_id);
+        state->sequencer = std::make_unique<FrameSequencer>(private_->postprocess);
+        return state;
+    });
 }
 
 SafetyBeltAlgo::~SafetyBeltAlgo() {
     std::lock_guard<std::mutex> lock(private_->model_mutex);
     for (auto &impl : private_->model_impls) { impl->WaitTaskDone(); }
+    private_->streams.for_each([](StreamState &state) {
+        if (state.sequencer) { state.sequencer->flush(); }
+    });
+    private_->postprocess.wait_idle();
 }
 
 bool SafetyBeltAlgo::load_models(const std::vector<ModelConfig> &models) {
@@ -44,11 +66,12 @@ bool SafetyBeltAlgo::load_models(const std::vector<ModelConfig> &models) {
 
     private_->model_configs = models;
     for (const auto &model : models) {
-        auto algo_impl = std::make_unique<gddeploy::InferAPI>();
+        auto algo_impl = std::make_unique<ModelSession>("SafetyBeltAlgo", private_->model_impls.size());
         if (algo_impl->Init("", model.path, model.license, gddeploy::ENUM_API_TYPE::ENUM_API_SESSION_API) != 0) {
             spdlog::error("Failed to load model: {} - {}", model.name, model.path);
             return false;
         }
+        algo_impl->SetBatching(model.max_batch_size, model.batch_wait_us);
         private_->model_impls.emplace_back(std::move(algo_impl));
     }
 
@@ -56,8 +79,20 @@ bool SafetyBeltAlgo::load_models(const std::vector<ModelConfig> &models) {
 }
 
 void SafetyBeltAlgo::async_infer(const int64_t image_id, const cv::Mat &image, InferCallback infer_callback) {
+    async_infer_impl(image_id, image, std::move(infer_callback));
+}
+
+void SafetyBeltAlgo::async_infer_view(const int64_t image_id, const cv::Mat &image, ViewCallback view_callback) {
+    async_infer_impl(image_id, image, std::move(view_callback));
+}
+
+void SafetyBeltAlgo::async_infer_impl(const int64_t image_id, const cv::Mat &image,
+                                      const ResultDelivery &infer_callback) {
+    auto stream = private_->streams.get(0);
+    StageTimer timer(stream->metrics, image_id);
     gddeploy::BufSurfWrapperPtr surface;
-    convertMat2BufSurface(const_cast<cv::Mat &>(image), surface);
+    convert_mat_to_surface(*private_->model_impls[0], const_cast<cv::Mat &>(image), surface);
+    timer.lap(AlgoStage::kPreprocess);
 
     auto package = gddeploy::Package::Create(1);
     package->data[0]->Set(surface);
@@ -66,110 +101,140 @@ void SafetyBeltAlgo::async_infer(const int64_t image_id, const cv::Mat &image, I
 
     private_->model_impls[0]->InferAsync(
         package,
-        [this, image_id, image, surface, infer_callback](gddeploy::Status status, gddeploy::PackagePtr data,
-                                                         gddeploy::any user_data) {
-            std::vector<AlgoObject> person_objects;
-            if (!data->data.empty() && data->data[0]->HasMetaValue()) {
-                person_objects = filter_infer_result(data->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                                     private_->model_configs[0].labels);
-            }
-
-            // 检测人数
-            if (person_objects.size() < 2) {
-                // 如果人数少于2，直接返回检测到的人员信息
-                if (infer_callback) { infer_callback(image_id, image, person_objects); }
-                return true;
-            }
+        stream->sequencer->wrap(
+            image_id, image, infer_callback,
+            [this, stream, image_id, image, surface, infer_callback, timer_state = timer.handoff()](
+                gddeploy::Status status, gddeploy::PackagePtr data, gddeploy::any user_data) {
+                std::lock_guard<std::mutex> lock(stream->mutex);
+                auto arena = stream->arena.begin_frame();
+                StageTimer timer(timer_state);
+                timer.lap(AlgoStage::kInferStage1);
+
+                FrameObjects person_objects(arena);
+                if (!data->data.empty() && data->data[0]->HasMetaValue()) {
+                    person_objects = filter_infer_result(data->data[0]->GetMetaData<gddeploy::InferResult>(),
+                                                         private_->model_configs[0].labels, arena);
+                }
 
-            // 对每个检测到的人进行安全带检测
-            std::vector<AlgoObject> belt_objects;
-            for (const auto &person : person_objects) {
-                auto crop_rect =
-                    scale_crop_rect(image.cols, image.rows, person.rect, private_->model_configs[1].crop_scale_factor);
-                auto crop_image = image(crop_rect).clone();
+                // 检测人数
+                if (person_objects.size() < 2) {
+                    // 如果人数少于2，直接返回检测到的人员信息
+                    if (infer_callback) { infer_callback(image_id, image, person_objects); }
+                    timer.lap(AlgoStage::kCallback);
+                    return true;
+                }
 
-                gddeploy::BufSurfWrapperPtr crop_surface;
-                convertMat2BufSurface(crop_image, crop_surface);
-                auto in_package = gddeploy::Package::Create(1);
-                auto out_package = gddeploy::Package::Create(1);
-                in_package->data[0]->Set(crop_surface);
-                in_package->data[0]->SetAlgParam(gddeploy::AlgDetectParam{private_->model_configs[1].threshold,
-                                                                          private_->model_configs[1].nms_threshold});
+                // 对每个检测到的人进行安全带检测
+                FrameObjects belt_objects(arena);
+                for (const auto &person : person_objects) {
+                    auto crop_rect = scale_crop_rect(image.cols, image.rows, person.rect,
+                                                     private_->model_configs[1].crop_scale_factor);
+                    auto crop_image = image(crop_rect).clone();
+
+                    gddeploy::BufSurfWrapperPtr crop_surface;
+                    convert_mat_to_surface(*private_->model_impls[1], crop_image, crop_surface);
+                    timer.lap(AlgoStage::kCrop);
+                    auto in_package = gddeploy::Package::Create(1);
+                    auto out_package = gddeploy::Package::Create(1);
+                    in_package->data[0]->Set(crop_surface);
+                    in_package->data[0]->SetAlgParam(gddeploy::AlgDetectParam{
+                        private_->model_configs[1].threshold, private_->model_configs[1].nms_threshold});
+
+                    private_->model_impls[1]->InferSync(in_package, out_package);
+                    timer.lap(AlgoStage::kInferStage2);
+
+                    if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
+                        auto objects = filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
+                                                           private_->model_configs[1].labels, arena);
+                        belt_objects.insert(belt_objects.end(), objects.begin(), objects.end());
+                    }
+                }
 
-                private_->model_impls[1]->InferSync(in_package, out_package);
+                // 如果安全带统计小于阈值，则认为未戴安全带
+                stream->safety_belt_group.emplace_back(belt_objects.empty() ? 0 : 1, std::time(nullptr));
+                float safety_belt_count =
+                    std::count_if(stream->safety_belt_group.begin(), stream->safety_belt_group.end(),
+                                  [](const auto &pair) { return pair.first == 1; });
+                if (safety_belt_count / stream->safety_belt_group.size() < config_.safety_belt_threshold) {
+                    if (infer_callback) { infer_callback(image_id, image, person_objects); }
+                    timer.lap(AlgoStage::kCallback);
 
-                if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
-                    auto objects = filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                                       private_->model_configs[1].labels);
-                    belt_objects.insert(belt_objects.end(), objects.begin(), objects.end());
+                    // 重置灯光统计
+                    stream->light_group.clear();
+                    stream->last_light_time = 0;
+                    return true;
                 }
-            }
 
-            // 如果安全带统计小于阈值，则认为未戴安全带
-            private_->safety_belt_group.emplace_back(belt_objects.empty() ? 0 : 1, std::time(nullptr));
-            float safety_belt_count =
-                std::count_if(private_->safety_belt_group.begin(), private_->safety_belt_group.end(),
-                              [](const auto &pair) { return pair.first == 1; });
-            if (safety_belt_count / private_->safety_belt_group.size() < config_.safety_belt_threshold) {
-                if (infer_callback) { infer_callback(image_id, image, person_objects); }
-
-                // 重置灯光统计
-                private_->light_group.clear();
-                private_->last_light_time = 0;
-                return true;
-            }
-
-            if (std::time(nullptr) - private_->safety_belt_group.front().second >= config_.statistics_time) {
-                private_->safety_belt_group.erase(private_->safety_belt_group.begin());
-            }
+                if (std::time(nullptr) - stream->safety_belt_group.front().second >= config_.statistics_time) {
+                    stream->safety_belt_group.erase(stream->safety_belt_group.begin());
+                }
 
-            // 检测灯光
-            if (private_->last_light_time == 0) { private_->last_light_time = std::time(nullptr); }
+                // 检测灯光
+                if (stream->last_light_time == 0) { stream->last_light_time = std::time(nullptr); }
 
-            auto in_package = gddeploy::Package::Create(1);
-            in_package->data[0]->Set(surface);
-            in_package->data[0]->SetAlgParam(gddeploy::AlgDetectParam{private_->model_configs[2].threshold,
-                                                                      private_->model_configs[2].nms_threshold});
+                auto in_package = gddeploy::Package::Create(1);
+                in_package->data[0]->Set(surface);
+                in_package->data[0]->SetAlgParam(gddeploy::AlgDetectParam{private_->model_configs[2].threshold,
+                                                                          private_->model_configs[2].nms_threshold});
 
-            auto out_package = gddeploy::Package::Create(1);
-            if (private_->model_impls[2]->InferSync(in_package, out_package) != 0) { return true; }
+                auto out_package = gddeploy::Package::Create(1);
+                if (private_->model_impls[2]->InferSync(in_package, out_package) != 0) { return true; }
+                timer.lap(AlgoStage::kInferStage3);
 
-            if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
-                auto objects = filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                                   private_->model_configs[2].labels);
-                private_->light_group.emplace_back(objects.empty() ? 0 : 1);
-                if (std::time(nullptr) - private_->light_group.front() >= config_.light_threshold) {
-                    private_->light_group.erase(private_->light_group.begin());
+                if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
+                    auto objects = filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
+                                                       private_->model_configs[2].labels, arena);
+                    stream->light_group.emplace_back(objects.empty() ? 0 : 1);
+                    if (std::time(nullptr) - stream->light_group.front() >= config_.light_threshold) {
+                        stream->light_group.erase(stream->light_group.begin());
+                    }
                 }
-            }
 
-            // 灯光判断逻辑
-            if (std::time(nullptr) - private_->last_light_time >= config_.delay_time) {
-                if (!private_->light_group.empty()) {
-                    float count = std::count(private_->light_group.begin(), private_->light_group.end(), 1);
-                    if (count / private_->light_group.size() >= config_.light_threshold) {
-                        // 如果灯亮了，返回空结果（表示条件都满足）
-                        if (infer_callback) { infer_callback(image_id, image, {}); }
+                // 灯光判断逻辑
+                if (std::time(nullptr) - stream->last_light_time >= config_.delay_time) {
+                    if (!stream->light_group.empty()) {
+                        float count = std::count(stream->light_group.begin(), stream->light_group.end(), 1);
+                        if (count / stream->light_group.size() >= config_.light_threshold) {
+                            // 如果灯亮了，返回空结果（表示条件都满足）
+                            if (infer_callback) { infer_callback(image_id, image, {}); }
+                            timer.lap(AlgoStage::kCallback);
+                        } else {
+                            // 如果灯没亮，返回原始的人员检测结果
+                            if (infer_callback) { infer_callback(image_id, image, person_objects); }
+                            timer.lap(AlgoStage::kCallback);
+                        }
                     } else {
-                        // 如果灯没亮，返回原始的人员检测结果
                         if (infer_callback) { infer_callback(image_id, image, person_objects); }
+                        timer.lap(AlgoStage::kCallback);
                     }
-                } else {
-                    if (infer_callback) { infer_callback(image_id, image, person_objects); }
-                }
 
-                // 重置灯光统计
-                private_->light_group.clear();
-                private_->last_light_time = 0;
-            }
+                    // 重置灯光统计
+                    stream->light_group.clear();
+                    stream->last_light_time = 0;
+                }
 
-            return true;
-        });
+                return true;
+            }));
 }
 
 bool SafetyBeltAlgo::sync_infer(const int64_t image_id, const cv::Mat &image, std::vector<AlgoObject> &person_objects) {
+    return sync_infer(0, image_id, image, person_objects);
+}
+
+bool SafetyBeltAlgo::sync_infer(const int32_t stream_id, const int64_t image_id, const cv::Mat &image,
+                                std::vector<AlgoObject> &person_objects) {
+    auto stream = private_->streams.get(stream_id);
+    if (!stream) {
+        spdlog::error("Invalid stream id: {}", stream_id);
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(stream->mutex);
+    auto arena = stream->arena.begin_frame();
+
+    StageTimer timer(stream->metrics, image_id);
     gddeploy::BufSurfWrapperPtr surface;
-    convertMat2BufSurface(const_cast<cv::Mat &>(image), surface);
+    convert_mat_to_surface(*private_->model_impls[0], const_cast<cv::Mat &>(image), surface);
+    timer.lap(AlgoStage::kPreprocess);
 
     auto in_package = gddeploy::Package::Create(1);
     in_package->data[0]->Set(surface);
@@ -178,29 +243,31 @@ bool SafetyBeltAlgo::sync_infer(const int64_t image_id, const cv::Mat &image, st
 
     auto out_package = gddeploy::Package::Create(1);
     if (private_->model_impls[0]->InferSync(in_package, out_package) != 0) { return false; }
+    timer.lap(AlgoStage::kInferStage1);
 
-    std::vector<AlgoObject> infer_objects;
+    FrameObjects infer_objects(arena);
     if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
         infer_objects = filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                            private_->model_configs[0].labels);
+                                            private_->model_configs[0].labels, arena);
     }
 
     // 检测人数
     if (infer_objects.size() < 2) {
         // 如果人数少于2，直接返回检测到的人员信息
-        person_objects = infer_objects;
+        person_objects = to_vector(infer_objects);
         return true;
     }
 
     // 对每个检测到的人进行安全带检测
-    std::vector<AlgoObject> belt_objects;
+    FrameObjects belt_objects(arena);
     for (const auto &person : infer_objects) {
         auto crop_rect =
             scale_crop_rect(image.cols, image.rows, person.rect, private_->model_configs[1].crop_scale_factor);
         auto crop_image = image(crop_rect).clone();
 
         gddeploy::BufSurfWrapperPtr crop_surface;
-        convertMat2BufSurface(crop_image, crop_surface);
+        convert_mat_to_surface(*private_->model_impls[1], crop_image, crop_surface);
+        timer.lap(AlgoStage::kCrop);
         in_package = gddeploy::Package::Create(1);
         in_package->data[0]->Set(crop_surface);
         in_package->data[0]->SetAlgParam(
@@ -208,33 +275,34 @@ bool SafetyBeltAlgo::sync_infer(const int64_t image_id, const cv::Mat &image, st
 
         out_package = gddeploy::Package::Create(1);
         if (private_->model_impls[1]->InferSync(in_package, out_package) != 0) { return false; }
+        timer.lap(AlgoStage::kInferStage2);
 
         if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
             auto objects = filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                               private_->model_configs[1].labels);
+                                               private_->model_configs[1].labels, arena);
             belt_objects.insert(belt_objects.end(), objects.begin(), objects.end());
         }
     }
 
     // 如果安全带统计小于阈值，则认为未戴安全带
-    private_->safety_belt_group.emplace_back(belt_objects.empty() ? 0 : 1, std::time(nullptr));
-    float safety_belt_count = std::count_if(private_->safety_belt_group.begin(), private_->safety_belt_group.end(),
+    stream->safety_belt_group.emplace_back(belt_objects.empty() ? 0 : 1, std::time(nullptr));
+    float safety_belt_count = std::count_if(stream->safety_belt_group.begin(), stream->safety_belt_group.end(),
                                             [](const auto &pair) { return pair.first == 1; });
-    if (safety_belt_count / private_->safety_belt_group.size() < config_.safety_belt_threshold) {
-        person_objects = infer_objects;
+    if (safety_belt_count / stream->safety_belt_group.size() < config_.safety_belt_threshold) {
+        person_objects = to_vector(infer_objects);
 
         // 重置灯光统计
-        private_->light_group.clear();
-        private_->last_light_time = 0;
+        stream->light_group.clear();
+        stream->last_light_time = 0;
         return true;
     }
 
-    if (std::time(nullptr) - private_->safety_belt_group.front().second >= config_.statistics_time) {
-        private_->safety_belt_group.erase(private_->safety_belt_group.begin());
+    if (std::time(nullptr) - stream->safety_belt_group.front().second >= config_.statistics_time) {
+        stream->safety_belt_group.erase(stream->safety_belt_group.begin());
     }
 
     // 检测灯光
-    if (private_->last_light_time == 0) { private_->last_light_time = std::time(nullptr); }
+    if (stream->last_light_time == 0) { stream->last_light_time = std::time(nullptr); }
 
     in_package = gddeploy::Package::Create(1);
     in_package->data[0]->Set(surface);
@@ -243,42 +311,44 @@ bool SafetyBeltAlgo::sync_infer(const int64_t image_id, const cv::Mat &image, st
 
     out_package = gddeploy::Package::Create(1);
     if (private_->model_impls[2]->InferSync(in_package, out_package) != 0) { return false; }
+    timer.lap(AlgoStage::kInferStage3);
 
     if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
         auto objects = filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                           private_->model_configs[2].labels);
-        private_->light_group.emplace_back(objects.empty() ? 0 : 1);
-        if (std::time(nullptr) - private_->light_group.front() >= config_.light_threshold) {
-            private_->light_group.erase(private_->light_group.begin());
+                                           private_->model_configs[2].labels, arena);
+        stream->light_group.emplace_back(objects.empty() ? 0 : 1);
+        if (std::time(nullptr) - stream->light_group.front() >= config_.light_threshold) {
+            stream->light_group.erase(stream->light_group.begin());
         }
     }
 
     // 修改灯光判断逻辑
-    if (std::time(nullptr) - private_->last_light_time >= config_.delay_time) {
-        if (!private_->light_group.empty()) {
-            float count = std::count(private_->light_group.begin(), private_->light_group.end(), 1);
-            if (count / private_->light_group.size() >= config_.light_threshold) {
+    if (std::time(nullptr) - stream->last_light_time >= config_.delay_time) {
+        if (!stream->light_group.empty()) {
+            float count = std::count(stream->light_group.begin(), stream->light_group.end(), 1);
+            if (count / stream->light_group.size() >= config_.light_threshold) {
                 // 如果灯亮了，返回空结果（表示条件都满足）
                 person_objects = {};
             } else {
                 // 如果灯没亮，返回原始的人员检测结果
-                person_objects = infer_objects;
+                person_objects = to_vector(infer_objects);
             }
         } else {
-            person_objects = infer_objects;
+            person_objects = to_vector(infer_objects);
         }
 
         // 重置灯光统计
-        private_->light_group.clear();
-        private_->last_light_time = 0;
+        stream->light_group.clear();
+        stream->last_light_time = 0;
     }
 
     return true;
 }
 
-std::vector<AlgoObject> SafetyBeltAlgo::filter_infer_result(const gddeploy::InferResult &infer_result,
-                                                            const std::set<std::string> &labels) {
-    std::vector<AlgoObject> objects;
+FrameObjects SafetyBeltAlgo::filter_infer_result(const gddeploy::InferResult &infer_result,
+                                                 const std::set<std::string> &labels,
+                                                 std::pmr::memory_resource *resource) {
+    FrameObjects objects(resource);
 
     for (auto result_type : infer_result.result_type) {
         if (result_type == gddeploy::GDD_RESULT_TYPE_DETECT) {
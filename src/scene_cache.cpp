@@ -0,0 +1,80 @@
+#include "scene_cache.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace gddi {
+
+namespace {
+
+// 全图均匀采样 64 x 36 个像素, 直方图只反映整体亮度分布, 不需要读取整幅图像
+constexpr int kSampleCols = 64;
+constexpr int kSampleRows = 36;
+
+}// namespace
+
+SceneCache::SceneCache(const float threshold, const clock::duration max_age, const int hysteresis,
+                       const std::string &algo, const int32_t stream)
+    : threshold_(threshold), max_age_(max_age), hysteresis_(std::max(hysteresis, 1)),
+      counter_(register_skip_counter(algo, "scene", stream)) {}
+
+SceneCache::Histogram SceneCache::signature(const cv::Mat &image) const {
+    Histogram histogram{};
+    const auto channels = image.channels();
+    for (int row = 0; row < kSampleRows; row++) {
+        const auto *pixels = image.ptr<uint8_t>((2 * row + 1) * image.rows / (2 * kSampleRows));
+        for (int col = 0; col < kSampleCols; col++) {
+            const auto *pixel = pixels + (2 * col + 1) * image.cols / (2 * kSampleCols) * channels;
+            // BGR 亮度 (0.114, 0.587, 0.299) * 256
+            auto luma = channels >= 3 ? (29u * pixel[0] + 150u * pixel[1] + 77u * pixel[2]) >> 8 : pixel[0];
+            histogram[luma * kBins / 256]++;
+        }
+    }
+    return histogram;
+}
+
+bool SceneCache::stale(const cv::Mat &image) {
+    if (image.empty() || image.depth() != CV_8U) {
+        counter_->record(false);
+        return true;
+    }
+
+    auto now = clock::now();
+    auto current = signature(image);
+
+    bool stale = !has_reference_ || switching_.load(std::memory_order_acquire) || now - reference_time_ >= max_age_;
+    if (!stale) {
+        // 两个直方图不重叠部分的占比
+        uint32_t distance = 0;
+        for (int i = 0; i < kBins; i++) {
+            distance += std::abs(static_cast<int>(current[i]) - static_cast<int>(reference_[i]));
+        }
+        stale = distance > threshold_ * 2 * kSampleCols * kSampleRows;
+    }
+
+    if (stale) {
+        reference_ = current;
+        reference_time_ = now;
+        has_reference_ = true;
+    }
+
+    counter_->record(!stale);
+    return stale;
+}
+
+void SceneCache::update(const AlgoObject &object) {
+    if (!has_result_ || object.class_id == result_.class_id) {
+        result_ = object;
+        has_result_ = true;
+        candidate_count_ = 0;
+    } else {
+        if (object.class_id != candidate_.class_id) { candidate_count_ = 0; }
+        candidate_ = object;
+        if (++candidate_count_ >= hysteresis_) {
+            result_ = candidate_;
+            candidate_count_ = 0;
+        }
+    }
+    switching_.store(candidate_count_ > 0, std::memory_order_release);
+}
+
+}// namespace gddi
@@ -0,0 +1,88 @@
+/**
+ * @file scene_cache.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 场景分类结果缓存: 亮度直方图变化或超时后才重新分类, 输出带迟滞
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 by GDDI
+ *
+ */
+
+#pragma once
+
+#include "stage_timer.h"
+#include "struct_def.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string>
+
+namespace gddi {
+
+/**
+ * @brief 单路视频流的场景分类缓存
+ *
+ * 亮度特征为全图稀疏采样的 16 档亮度直方图, 与上一次分类时的直方图比较.
+ * stale 只由提交帧的线程调用 (同一视频流串行); update/result 在视频流锁内调用.
+ */
+class SceneCache {
+public:
+    using clock = std::chrono::steady_clock;
+    static constexpr int kBins = 16;
+
+    /**
+     * @param threshold 直方图变化阈值 (两直方图不重叠部分的占比, 0 ~ 1)
+     * @param max_age 缓存最长有效时间
+     * @param hysteresis 新类别连续分类 N 次后才切换输出
+     */
+    SceneCache(const float threshold, const clock::duration max_age, const int hysteresis, const std::string &algo,
+               const int32_t stream);
+
+    /**
+     * @brief 判断本帧是否需要重新分类, 同时记录跳帧计数; 返回 true 时本帧的直方图成为新的参考
+     *
+     * 类别切换确认期间每帧都重新分类
+     */
+    bool stale(const cv::Mat &image);
+
+    /**
+     * @brief 记录分类结果, 与当前输出不同的类别连续出现 hysteresis 次后才切换
+     *
+     */
+    template <typename Objects>
+    void update(const Objects &objects) {
+        if (objects.empty()) { return; }
+        update(objects[0]);
+    }
+    void update(const AlgoObject &object);
+
+    /**
+     * @brief 当前输出的分类结果
+     *
+     * @return const AlgoObject* 还没有分类结果时为空
+     */
+    const AlgoObject *result() const { return has_result_ ? &result_ : nullptr; }
+
+private:
+    using Histogram = std::array<uint32_t, kBins>;
+
+    Histogram signature(const cv::Mat &image) const;
+
+    float threshold_;
+    clock::duration max_age_;
+    int hysteresis_;
+    SkipCounter *counter_;
+
+    Histogram reference_{};
+    bool has_reference_{false};
+    clock::time_point reference_time_;
+
+    AlgoObject result_{};
+    bool has_result_{false};
+    AlgoObject candidate_{};
+    int candidate_count_{0};
+    std::atomic<bool> switching_{false};// 类别切换确认中
+};
+
+}// namespace gddi
@@ -2,20 +2,21 @@
 
 namespace gddi {
 
-std::vector<AlgoObject> SequenceStatistic::update(const std::vector<AlgoObject> &objects) {
-    for (auto &item : objects) {
-        if (event_map_.count(item.track_id) == 0) { event_map_[item.track_id] = EventSqeuence{}; }
+std::vector<AlgoObject> SequenceStatistic::update(const AlgoObject *objects, const size_t num_objects) {
+    auto objects_end = objects + num_objects;
+    for (auto item = objects; item != objects_end; ++item) {
+        if (event_map_.count(item->track_id) == 0) { event_map_[item->track_id] = EventSqeuence{}; }
 
-        event_map_.at(item.track_id).event_group.emplace_back(1);
-        event_map_.at(item.track_id).last_update_time = std::time(nullptr);
+        event_map_.at(item->track_id).event_group.emplace_back(1);
+        event_map_.at(item->track_id).last_update_time = std::time(nullptr);
     }
 
     // 处理事件
     std::vector<AlgoObject> update_objects;
     for (auto iter = event_map_.begin(); iter != event_map_.end();) {
-        auto find_iter = std::find_if(objects.begin(), objects.end(),
+        auto find_iter = std::find_if(objects, objects_end,
                                       [track_id = iter->first](const auto &item) { return item.track_id == track_id; });
-        if (find_iter == objects.end()) { iter->second.event_group.push_back(0); }
+        if (find_iter == objects_end) { iter->second.event_group.push_back(0); }
 
         if (time(nullptr) - iter->second.last_event_time >= interval_) {
             iter->second.last_event_time = std::time(nullptr);
@@ -24,7 +25,7 @@ std::vector<AlgoObject> SequenceStatistic::update(const std::vector<AlgoObject>
             float count = std::count(iter->second.event_group.begin(), iter->second.event_group.end(), 1);
             if (count / iter->second.event_group.size() >= threshold_) { new_group_status = 1; }
 
-            if (find_iter != objects.end() && iter->second.last_group_status == 0 && new_group_status == 1) {
+            if (find_iter != objects_end && iter->second.last_group_status == 0 && new_group_status == 1) {
                 update_objects.emplace_back(*find_iter);
             }
 
@@ -9,7 +9,7 @@
  * 
  */
 
-#pragma one
+#pragma once
 
 #include "struct_def.h"
 #include <ctime>
@@ -31,7 +31,12 @@ public:
         : interval_(interval), threshold_(threshold) {}
     virtual ~SequenceStatistic() = default;
 
-    std::vector<AlgoObject> update(const std::vector<AlgoObject> &objects);
+    template <typename Objects>
+    std::vector<AlgoObject> update(const Objects &objects) {
+        return update(objects.data(), objects.size());
+    }
+
+    std::vector<AlgoObject> update(const AlgoObject *objects, const size_t num_objects);
 
 private:
     uint32_t interval_;
@@ -1,7 +1,13 @@
 #include "sparks_cover_algo.h"
 #include "bytetrack/BYTETracker.h"
+#include "frame_sequencer.h"
+#include "model_session.h"
+#include "result_delivery.h"
 #include "sequence_statistic.h"
 #include "spdlog/spdlog.h"
+#include "stage_timer.h"
+#include "stream_state.h"
+#include "tiled_infer.h"
 #include "utils.h"
 #include <api/global_config.h>
 #include <bmcv_api_ext.h>
@@ -13,26 +19,38 @@ namespace gddi {
 
 class SparksCoverAlgo::SparksCoverAlgoPrivate {
 public:
-    std::unique_ptr<BYTETracker> tracker;
-    std::unique_ptr<SequenceStatistic> sequence_statistic;
+    StreamShards<> streams;
+    PostprocessQueue postprocess;
 
     std::mutex model_mutex;
     std::vector<ModelConfig> model_configs;
-    std::vector<std::unique_ptr<gddeploy::InferAPI>> model_impls;
+    std::vector<std::unique_ptr<ModelSession>> model_impls;
 };
 
 SparksCoverAlgo::SparksCoverAlgo(const SparksCoverAlgoConfig &config) : config_(config) {
     gddeploy::gddeploy_init("");
     private_ = std::make_unique<SparksCoverAlgoPrivate>();
 
-    private_->tracker = std::make_unique<BYTETracker>(0.3, 0.6, 0.8, 30);
-    private_->sequence_statistic =
-        std::make_unique<SequenceStatistic>(config_.statistics_interval, config_.statistics_threshold);
+    private_->streams.init([this](const int32_t stream_id) {
+        auto state = std::make_unique<StreamState>("SparksCoverAlgo", stream_id);
+        state->sequencer = std::make_unique<FrameSequencer>(private_->postprocess);
+        state->tracker = std::make_unique<BYTETracker>(0.3, 0.6, 0.8, 30);
+        if (auto region = config_.stream_regions.find(stream_id); region != config_.stream_regions.end()) {
+            state->region = std::make_unique<RegionMask>(region->second);
+        }
+        state->sequence_statistic =
+            std::make_unique<SequenceStatistic>(config_.statistics_interval, config_.statistics_threshold);
+        return state;
+    });
 }
 
 SparksCoverAlgo::~SparksCoverAlgo() {
     std::lock_guard<std::mutex> lock(private_->model_mutex);
     for (auto &impl : private_->model_impls) { impl->WaitTaskDone(); }
+    private_->streams.for_each([](StreamState &state) {
+        if (state.sequencer) { state.sequencer->flush(); }
+    });
+    private_->postprocess.wait_idle();
 }
 
 bool SparksCoverAlgo::load_models(const std::vector<ModelConfig> &models) {
@@ -46,11 +64,12 @@ bool SparksCoverAlgo::load_models(const std::vector<ModelConfig> &models) {
 
     private_->model_configs = models;
     for (const auto &model : models) {
-        auto algo_impl = std::make_unique<gddeploy::InferAPI>();
+        auto algo_impl = std::make_unique<ModelSession>("SparksCoverAlgo", private_->model_impls.size());
         if (algo_impl->Init("", model.path, model.license, gddeploy::ENUM_API_TYPE::ENUM_API_SESSION_API) != 0) {
             spdlog::error("Failed to load model: {} - {}", model.name, model.path);
             return false;
         }
+        algo_impl->SetBatching(model.max_batch_size, model.batch_wait_us);
         private_->model_impls.emplace_back(std::move(algo_impl));
     }
 
@@ -58,164 +77,241 @@ bool SparksCoverAlgo::load_models(const std::vector<ModelConfig> &models) {
 }
 
 void SparksCoverAlgo::async_infer(const int64_t image_id, const cv::Mat &image, InferCallback infer_callback) {
-    gddeploy::BufSurfWrapperPtr surface;
-    convertMat2BufSurface(const_cast<cv::Mat &>(image), surface);
+    async_infer_impl(image_id, image, std::move(infer_callback));
+}
 
-    auto package = gddeploy::Package::Create(1);
-    package->data[0]->Set(surface);
-    package->data[0]->SetAlgParam(
-        gddeploy::AlgDetectParam{private_->model_configs[0].threshold, private_->model_configs[0].nms_threshold});
+void SparksCoverAlgo::async_infer_view(const int64_t image_id, const cv::Mat &image, ViewCallback view_callback) {
+    async_infer_impl(image_id, image, std::move(view_callback));
+}
+
+void SparksCoverAlgo::async_infer_impl(const int64_t image_id, const cv::Mat &image,
+                                       const ResultDelivery &infer_callback) {
+    auto stream = private_->streams.get(0);
+    StageTimer timer(stream->metrics, image_id);
+
+    // 开启分块推理时一阶段各分块一个批次提交, 跳过检测区域外的分块
+    auto tile_batch = make_tile_batch(*private_->model_impls[0], image, private_->model_configs[0],
+                                      stream->region.get());
+    gddeploy::BufSurfWrapperPtr surface;
+    if (!tile_batch) { convert_mat_to_surface(*private_->model_impls[0], const_cast<cv::Mat &>(image), surface); }
+    timer.lap(AlgoStage::kPreprocess);
+
+    auto package = tile_batch ? tile_batch->package : gddeploy::Package::Create(1);
+    if (!tile_batch) {
+        package->data[0]->Set(surface);
+        package->data[0]->SetAlgParam(
+            gddeploy::AlgDetectParam{private_->model_configs[0].threshold, private_->model_configs[0].nms_threshold});
+    }
 
     private_->model_impls[0]->InferAsync(
         package,
-        [this, image_id, image, surface, infer_callback](gddeploy::Status status, gddeploy::PackagePtr data,
-                                                         gddeploy::any user_data) {
-            std::vector<AlgoObject> sparks_objects;
-            if (!data->data.empty() && data->data[0]->HasMetaValue()) {
-                sparks_objects = filter_infer_result(data->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                                     private_->model_configs[0].labels);
-            }
-
-            // 如果一阶段没有检测目标，直接返回
-            if (sparks_objects.empty() && infer_callback) {
-                infer_callback(image_id, image, {});
-            } else {
-                // 生成目标跟踪ID
-                std::vector<Object> objects;
-                for (const auto &item : sparks_objects) {
-                    objects.push_back(Object{
-                        .class_id = item.class_id,
-                        .prob = item.score,
-                        .rect = {(float)item.rect.x, (float)item.rect.y, (float)item.rect.width,
-                                 (float)item.rect.height},
-                        .label_name = item.label,
-                    });
+        stream->sequencer->wrap(
+            image_id, image, infer_callback,
+            [this, stream, image_id, image, surface, tile_batch, infer_callback, timer_state = timer.handoff()](
+                gddeploy::Status status, gddeploy::PackagePtr data, gddeploy::any user_data) {
+                std::lock_guard<std::mutex> lock(stream->mutex);
+                auto arena = stream->arena.begin_frame();
+                StageTimer timer(timer_state);
+                timer.lap(AlgoStage::kInferStage1);
+
+                FrameObjects sparks_objects(arena);
+                if (tile_batch) {
+                    auto parse = [this, arena](const gddeploy::InferResult &result) {
+                        return filter_infer_result(result, private_->model_configs[0].labels, arena);
+                    };
+                    sparks_objects = merge_tile_results(*tile_batch, data, parse,
+                                                        private_->model_configs[0].tile_merge_threshold, arena);
+                } else if (!data->data.empty() && data->data[0]->HasMetaValue()) {
+                    sparks_objects = filter_infer_result(data->data[0]->GetMetaData<gddeploy::InferResult>(),
+                                                         private_->model_configs[0].labels, arena);
                 }
 
-                std::vector<AlgoObject> tracked_objects;
-                for (auto &item : private_->tracker->update(objects)) {
-                    tracked_objects.emplace_back(
-                        AlgoObject{item.target_id, item.class_id, item.label_name, item.score,
-                                   cv::Rect{(int)item.tlwh[0], (int)item.tlwh[1], (int)item.tlwh[2], (int)item.tlwh[3]},
-                                   item.track_id});
-                }
+                // 如果一阶段没有检测目标，直接返回
+                if (sparks_objects.empty() && infer_callback) {
+                    infer_callback(image_id, image, {});
+                } else {
+                    // 生成目标跟踪ID
+                    std::vector<Object> objects;
+                    for (const auto &item : sparks_objects) {
+                        objects.push_back(Object{
+                            .class_id = item.class_id,
+                            .prob = item.score,
+                            .rect = {(float)item.rect.x, (float)item.rect.y, (float)item.rect.width,
+                                     (float)item.rect.height},
+                            .label_name = item.label,
+                        });
+                    }
 
-                // 裁剪目标 & 排序
-                std::sort(tracked_objects.begin(), tracked_objects.end(),
-                          [](const AlgoObject &item1, const AlgoObject &item2) {
-                              return item1.score > item2.score
-                                  && item1.rect.width * item1.rect.height > item2.rect.width * item2.rect.height;
-                          });
+                    FrameObjects tracked_objects(arena);
+                    for (auto &item : stream->tracker->update(objects)) {
+                        tracked_objects.emplace_back(
+                            AlgoObject{item.target_id, item.class_id, item.label_name, item.score,
+                                       cv::Rect{(int)item.tlwh[0], (int)item.tlwh[1], (int)item.tlwh[2],
+                                                (int)item.tlwh[3]},
+                                       item.track_id});
+                    }
 
-                // 裁剪目标数
-                if (tracked_objects.size() > private_->model_configs[1].max_crop_number) {
-                    tracked_objects.resize(private_->model_configs[1].max_crop_number);
-                }
+                    // 检测区域外的目标不再裁剪推理和告警
+                    if (stream->region) { stream->region->filter(tracked_objects); }
 
-                // 二阶段检测
-                std::vector<AlgoObject> match_objects;
-                for (const auto &item : tracked_objects) {
-                    auto crop_rect = scale_crop_rect(image.cols, image.rows, item.rect,
-                                                     private_->model_configs[1].crop_scale_factor);
-                    auto crop_image = image(crop_rect).clone();
-                    gddeploy::BufSurfWrapperPtr crop_surface;
-                    convertMat2BufSurface(crop_image, crop_surface);
-
-                    auto in_package = gddeploy::Package::Create(1);
-                    auto out_package = gddeploy::Package::Create(1);
-                    in_package->data[0]->Set(crop_surface);
-                    in_package->data[0]->SetAlgParam(gddeploy::AlgDetectParam{
-                        private_->model_configs[1].threshold, private_->model_configs[1].nms_threshold});
-
-                    private_->model_impls[1]->InferSync(in_package, out_package);
-
-                    std::vector<AlgoObject> person_objects;
-                    if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
-                        person_objects = filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                                             private_->model_configs[1].labels);
-                        for (auto &person_object : person_objects) {
-                            person_object.rect.x += crop_rect.x;
-                            person_object.rect.y += crop_rect.y;
-                        }
-                    }
+                    timer.lap(AlgoStage::kTrack);
 
                     // 裁剪目标 & 排序
-                    std::sort(person_objects.begin(), person_objects.end(),
+                    std::sort(tracked_objects.begin(), tracked_objects.end(),
                               [](const AlgoObject &item1, const AlgoObject &item2) {
                                   return item1.score > item2.score
                                       && item1.rect.width * item1.rect.height > item2.rect.width * item2.rect.height;
                               });
 
                     // 裁剪目标数
-                    if (person_objects.size() > private_->model_configs[2].max_crop_number) {
-                        person_objects.resize(private_->model_configs[2].max_crop_number);
+                    if (tracked_objects.size() > private_->model_configs[1].max_crop_number) {
+                        tracked_objects.resize(private_->model_configs[1].max_crop_number);
                     }
 
-                    // 三阶段检测
-                    for (const auto &person_object : person_objects) {
-                        crop_rect = scale_crop_rect(image.cols, image.rows, person_object.rect,
-                                                    private_->model_configs[2].crop_scale_factor);
-                        crop_image = image(crop_rect).clone();
-                        gddeploy::BufSurfWrapperPtr person_surface;
-                        convertMat2BufSurface(crop_image, person_surface);
-
-                        in_package = gddeploy::Package::Create(1);
-                        out_package = gddeploy::Package::Create(1);
-                        in_package->data[0]->Set(person_surface);
+                    // 二阶段检测
+                    FrameObjects match_objects(arena);
+                    for (const auto &item : tracked_objects) {
+                        auto crop_rect = scale_crop_rect(image.cols, image.rows, item.rect,
+                                                         private_->model_configs[1].crop_scale_factor);
+                        auto crop_image = image(crop_rect).clone();
+                        gddeploy::BufSurfWrapperPtr crop_surface;
+                        convert_mat_to_surface(*private_->model_impls[1], crop_image, crop_surface);
+                        timer.lap(AlgoStage::kCrop);
+
+                        auto in_package = gddeploy::Package::Create(1);
+                        auto out_package = gddeploy::Package::Create(1);
+                        in_package->data[0]->Set(crop_surface);
                         in_package->data[0]->SetAlgParam(gddeploy::AlgDetectParam{
-                            private_->model_configs[2].threshold, private_->model_configs[2].nms_threshold});
+                            private_->model_configs[1].threshold, private_->model_configs[1].nms_threshold});
 
-                        private_->model_impls[2]->InferSync(in_package, out_package);
+                        private_->model_impls[1]->InferSync(in_package, out_package);
+                        timer.lap(AlgoStage::kInferStage2);
 
-                        std::vector<AlgoObject> cover_objects;
+                        FrameObjects person_objects(arena);
                         if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
-                            cover_objects =
+                            person_objects =
                                 filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                                    private_->model_configs[2].labels);
-                            for (auto &cover_object : cover_objects) {
-                                cover_object.rect.x += crop_rect.x;
-                                cover_object.rect.y += crop_rect.y;
+                                                    private_->model_configs[1].labels, arena);
+                            for (auto &person_object : person_objects) {
+                                person_object.rect.x += crop_rect.x;
+                                person_object.rect.y += crop_rect.y;
                             }
                         }
 
-                        // if (!cover_objects.empty()) {
-                        //     cv::rectangle(image, crop_rect, cv::Scalar(0, 0, 255), 2);
-                        //     for (auto &cover_object : cover_objects) {
-                        //         spdlog::info("cover_object: {}", cover_object.label);
-                        //         cv::rectangle(image, cover_object.rect, cv::Scalar(0, 255, 0), 2);
-                        //     }
-                        //     cv::imwrite("crop_image-1.jpg", image);
-                        // }
+                        // 裁剪目标 & 排序
+                        std::sort(person_objects.begin(), person_objects.end(),
+                                  [](const AlgoObject &item1, const AlgoObject &item2) {
+                                      return item1.score > item2.score
+                                          && item1.rect.width * item1.rect.height
+                                                 > item2.rect.width * item2.rect.height;
+                                  });
+
+                        // 裁剪目标数
+                        if (person_objects.size() > private_->model_configs[2].max_crop_number) {
+                            person_objects.resize(private_->model_configs[2].max_crop_number);
+                        }
+
+                        // 三阶段检测
+                        for (const auto &person_object : person_objects) {
+                            crop_rect = scale_crop_rect(image.cols, image.rows, person_object.rect,
+                                                        private_->model_configs[2].crop_scale_factor);
+                            crop_image = image(crop_rect).clone();
+                            gddeploy::BufSurfWrapperPtr person_surface;
+                            convert_mat_to_surface(*private_->model_impls[2], crop_image, person_surface);
+                            timer.lap(AlgoStage::kCrop);
+
+                            in_package = gddeploy::Package::Create(1);
+                            out_package = gddeploy::Package::Create(1);
+                            in_package->data[0]->Set(person_surface);
+                            in_package->data[0]->SetAlgParam(gddeploy::AlgDetectParam{
+                                private_->model_configs[2].threshold, private_->model_configs[2].nms_threshold});
+
+                            private_->model_impls[2]->InferSync(in_package, out_package);
+                            timer.lap(AlgoStage::kInferStage3);
+
+                            FrameObjects cover_objects(arena);
+                            if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
+                                cover_objects =
+                                    filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
+                                                        private_->model_configs[2].labels, arena);
+                                for (auto &cover_object : cover_objects) {
+                                    cover_object.rect.x += crop_rect.x;
+                                    cover_object.rect.y += crop_rect.y;
+                                }
+                            }
+
+                            // if (!cover_objects.empty()) {
+                            //     cv::rectangle(image, crop_rect, cv::Scalar(0, 0, 255), 2);
+                            //     for (auto &cover_object : cover_objects) {
+                            //         spdlog::info("cover_object: {}", cover_object.label);
+                            //         cv::rectangle(image, cover_object.rect, cv::Scalar(0, 255, 0), 2);
+                            //     }
+                            //     cv::imwrite("crop_image-1.jpg", image);
+                            // }
 
-                        if (cover_objects.empty()) { match_objects.emplace_back(person_object); }
+                            if (cover_objects.empty()) { match_objects.emplace_back(person_object); }
+                        }
                     }
-                }
 
-                if (infer_callback) {
-                    infer_callback(image_id, image, private_->sequence_statistic->update(match_objects));
+                    auto statistic_objects = stream->sequence_statistic->update(match_objects);
+                    timer.lap(AlgoStage::kStatistic);
+
+                    if (infer_callback) { infer_callback(image_id, image, statistic_objects); }
+                    timer.lap(AlgoStage::kCallback);
                 }
-            }
-        });
+            }));
 }
 
 bool SparksCoverAlgo::sync_infer(const int64_t image_id, const cv::Mat &image,
                                  std::vector<AlgoObject> &statistic_objects) {
+    return sync_infer(0, image_id, image, statistic_objects);
+}
+
+bool SparksCoverAlgo::sync_infer(const int32_t stream_id, const int64_t image_id, const cv::Mat &image,
+                                 std::vector<AlgoObject> &statistic_objects) {
+    auto stream = private_->streams.get(stream_id);
+    if (!stream) {
+        spdlog::error("Invalid stream id: {}", stream_id);
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(stream->mutex);
+    auto arena = stream->arena.begin_frame();
+
+    StageTimer timer(stream->metrics, image_id);
+
+    // 开启分块推理时一阶段各分块一个批次提交, 跳过检测区域外的分块
+    auto tile_batch = make_tile_batch(*private_->model_impls[0], image, private_->model_configs[0],
+                                      stream->region.get());
     gddeploy::BufSurfWrapperPtr surface;
-    convertMat2BufSurface(const_cast<cv::Mat &>(image), surface);
+    if (!tile_batch) { convert_mat_to_surface(*private_->model_impls[0], const_cast<cv::Mat &>(image), surface); }
+    timer.lap(AlgoStage::kPreprocess);
 
     // 一阶段检测
+    FrameObjects sparks_objects(arena);
     auto in_package = gddeploy::Package::Create(1);
-    in_package->data[0]->Set(surface);
-    in_package->data[0]->SetAlgParam(
-        gddeploy::AlgDetectParam{private_->model_configs[0].threshold, private_->model_configs[0].nms_threshold});
-
     auto out_package = gddeploy::Package::Create(1);
-    if (private_->model_impls[0]->InferSync(in_package, out_package) != 0) { return false; }
+    if (tile_batch) {
+        auto parse = [this, arena](const gddeploy::InferResult &result) {
+            return filter_infer_result(result, private_->model_configs[0].labels, arena);
+        };
+        if (infer_tiles(*private_->model_impls[0], *tile_batch, parse, private_->model_configs[0].tile_merge_threshold,
+                        sparks_objects)
+            != 0) {
+            return false;
+        }
+        timer.lap(AlgoStage::kInferStage1);
+    } else {
+        in_package->data[0]->Set(surface);
+        in_package->data[0]->SetAlgParam(
+            gddeploy::AlgDetectParam{private_->model_configs[0].threshold, private_->model_configs[0].nms_threshold});
 
-    std::vector<AlgoObject> sparks_objects;
-    if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
-        sparks_objects = filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                             private_->model_configs[0].labels);
+        if (private_->model_impls[0]->InferSync(in_package, out_package) != 0) { return false; }
+        timer.lap(AlgoStage::kInferStage1);
+
+        if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
+            sparks_objects = filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
+                                                 private_->model_configs[0].labels, arena);
+        }
     }
 
     // 生成目标跟踪ID
@@ -229,13 +325,18 @@ bool SparksCoverAlgo::sync_infer(const int64_t image_id, const cv::Mat &image,
         });
     }
 
-    std::vector<AlgoObject> tracked_objects;
-    for (auto &item : private_->tracker->update(objects)) {
+    FrameObjects tracked_objects(arena);
+    for (auto &item : stream->tracker->update(objects)) {
         tracked_objects.emplace_back(AlgoObject{
             item.target_id, item.class_id, item.label_name, item.score,
             cv::Rect{(int)item.tlwh[0], (int)item.tlwh[1], (int)item.tlwh[2], (int)item.tlwh[3]}, item.track_id});
     }
 
+    // 检测区域外的目标不再裁剪推理和告警
+    if (stream->region) { stream->region->filter(tracked_objects); }
+
+    timer.lap(AlgoStage::kTrack);
+
     // 裁剪目标 & 排序
     std::sort(tracked_objects.begin(), tracked_objects.end(), [](const AlgoObject &item1, const AlgoObject &item2) {
         return item1.score > item2.score && item1.rect.width * item1.rect.height > item2.rect.width * item2.rect.height;
@@ -252,7 +353,8 @@ bool SparksCoverAlgo::sync_infer(const int64_t image_id, const cv::Mat &image,
             scale_crop_rect(image.cols, image.rows, item.rect, private_->model_configs[1].crop_scale_factor);
         auto crop_image = image(crop_rect).clone();
         gddeploy::BufSurfWrapperPtr crop_surface;
-        convertMat2BufSurface(crop_image, crop_surface);
+        convert_mat_to_surface(*private_->model_impls[1], crop_image, crop_surface);
+        timer.lap(AlgoStage::kCrop);
 
         in_package = gddeploy::Package::Create(1);
         out_package = gddeploy::Package::Create(1);
@@ -261,11 +363,12 @@ bool SparksCoverAlgo::sync_infer(const int64_t image_id, const cv::Mat &image,
             gddeploy::AlgDetectParam{private_->model_configs[1].threshold, private_->model_configs[1].nms_threshold});
 
         private_->model_impls[1]->InferSync(in_package, out_package);
+        timer.lap(AlgoStage::kInferStage2);
 
-        std::vector<AlgoObject> person_objects;
+        FrameObjects person_objects(arena);
         if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
             person_objects = filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                                 private_->model_configs[1].labels);
+                                                 private_->model_configs[1].labels, arena);
             for (auto &person_object : person_objects) {
                 person_object.rect.x += crop_rect.x;
                 person_object.rect.y += crop_rect.y;
@@ -284,13 +387,14 @@ bool SparksCoverAlgo::sync_infer(const int64_t image_id, const cv::Mat &image,
         }
 
         // 三阶段检测
-        std::vector<AlgoObject> match_objects;
+        FrameObjects match_objects(arena);
         for (const auto &person_object : person_objects) {
             crop_rect = scale_crop_rect(image.cols, image.rows, person_object.rect,
                                         private_->model_configs[2].crop_scale_factor);
             crop_image = image(crop_rect).clone();
             gddeploy::BufSurfWrapperPtr person_surface;
-            convertMat2BufSurface(crop_image, person_surface);
+            convert_mat_to_surface(*private_->model_impls[2], crop_image, person_surface);
+            timer.lap(AlgoStage::kCrop);
 
             in_package = gddeploy::Package::Create(1);
             out_package = gddeploy::Package::Create(1);
@@ -299,11 +403,12 @@ bool SparksCoverAlgo::sync_infer(const int64_t image_id, const cv::Mat &image,
                                                                       private_->model_configs[2].nms_threshold});
 
             private_->model_impls[2]->InferSync(in_package, out_package);
+            timer.lap(AlgoStage::kInferStage3);
 
-            std::vector<AlgoObject> cover_objects;
+            FrameObjects cover_objects(arena);
             if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
                 cover_objects = filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                                    private_->model_configs[2].labels);
+                                                    private_->model_configs[2].labels, arena);
                 for (auto &cover_object : cover_objects) {
                     cover_object.rect.x += crop_rect.x;
                     cover_object.rect.y += crop_rect.y;
@@ -322,15 +427,17 @@ bool SparksCoverAlgo::sync_infer(const int64_t image_id, const cv::Mat &image,
             if (cover_objects.empty()) { match_objects.emplace_back(person_object); }
         }
 
-        statistic_objects = private_->sequence_statistic->update(match_objects);
+        statistic_objects = stream->sequence_statistic->update(match_objects);
+        timer.lap(AlgoStage::kStatistic);
     }
 
     return true;
 }
 
-std::vector<AlgoObject> SparksCoverAlgo::filter_infer_result(const gddeploy::InferResult &infer_result,
-                                                             const std::set<std::string> &labels) {
-    std::vector<AlgoObject> objects;
+FrameObjects SparksCoverAlgo::filter_infer_result(const gddeploy::InferResult &infer_result,
+                                                  const std::set<std::string> &labels,
+                                                  std::pmr::memory_resource *resource) {
+    FrameObjects objects(resource);
 
     for (auto result_type : infer_result.result_type) {
         if (result_type == gddeploy::GDD_RESULT_TYPE_DETECT) {
@@ -0,0 +1,94 @@
+#include "speculative_infer.h"
+#include <condition_variable>
+#include <mutex>
+
+namespace gddi {
+
+namespace {
+
+// 通过率滑动平均系数, 约 32 帧 (25fps 下 1 秒多) 适应场景变化
+constexpr float kPassRateSmoothing = 1.0f / 32;
+
+}// namespace
+
+bool SpeculationPolicy::speculate() const {
+    if (replay_enabled()) { return false; }
+    switch (config_.mode) {
+        case SpeculationMode::kSpeculative: return true;
+        case SpeculationMode::kAdaptive: return pass_rate() >= config_.pass_rate;
+        default: return false;
+    }
+}
+
+void SpeculationPolicy::record(const bool passed) {
+    auto pass_rate = pass_rate_.load(std::memory_order_relaxed);
+    pass_rate_.store(pass_rate + ((passed ? 1.0f : 0.0f) - pass_rate) * kPassRateSmoothing,
+                     std::memory_order_relaxed);
+}
+
+struct InferFuture::State {
+    std::mutex mutex;
+    std::condition_variable done_cv;
+    bool done{false};
+    bool success{false};
+    clock::time_point finished;
+    std::function<void()> continuation;
+};
+
+InferFuture::InferFuture(gddeploy::PackagePtr out_package)
+    : state_(std::make_shared<State>()), out_package_(std::move(out_package)) {}
+
+void InferFuture::submit(ModelSession &session, const gddeploy::PackagePtr &in_package) {
+    session.InferAsync(in_package, [state = state_, out_package = out_package_](
+                                       gddeploy::Status status, gddeploy::PackagePtr data, gddeploy::any) {
+        std::function<void()> continuation;
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->success = status == gddeploy::Status::SUCCESS;
+            if (state->success) { out_package->data = data->data; }
+            state->finished = clock::now();
+            state->done = true;
+            continuation = std::move(state->continuation);
+        }
+        state->done_cv.notify_all();
+        if (continuation) { continuation(); }
+    });
+}
+
+bool InferFuture::get() const {
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    state_->done_cv.wait(lock, [this]() { return state_->done; });
+    return state_->success;
+}
+
+void InferFuture::then(std::function<void()> continuation) const {
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        if (!state_->done) {
+            state_->continuation = std::move(continuation);
+            return;
+        }
+    }
+    continuation();
+}
+
+InferFuture::clock::time_point InferFuture::finished() const {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->finished;
+}
+
+int infer_concurrent(ModelSession &first, const gddeploy::PackagePtr &first_in, const gddeploy::PackagePtr &first_out,
+                     ModelSession &second, const gddeploy::PackagePtr &second_in,
+                     const gddeploy::PackagePtr &second_out, StageTimer &timer) {
+    InferFuture first_done(first_out), second_done(second_out);
+    first_done.submit(first, first_in);
+    second_done.submit(second, second_in);
+
+    auto success = first_done.get();
+    timer.lap(AlgoStage::kInferStage1, first_done.finished());
+    second_done.get();
+    timer.lap(AlgoStage::kInferStage2, second_done.finished());
+    return success ? 0 : -1;
+}
+
+}// namespace gddi
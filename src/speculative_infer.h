@@ -0,0 +1,110 @@
+/**
+ * @file speculative_infer.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 门控模型与二阶段全图模型同时提交 (投机执行), 按门控通过率选择投机或顺序执行
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 by GDDI
+ *
+ */
+
+#pragma once
+
+#include "model_session.h"
+#include "stage_timer.h"
+#include "struct_def.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+
+namespace gddi {
+
+/**
+ * @brief 单路视频流的执行方式选择
+ *
+ * 门控模型每次推理后 record 一次, 通过率为指数滑动平均 (初始为 0, 即先顺序执行).
+ * record 在视频流锁内调用; 异步推理的 speculate 在提交线程调用, 通过率为原子变量.
+ * 回放模式下不投机: 顺序执行录制的日志里没有门控未通过帧的二阶段输出
+ */
+class SpeculationPolicy {
+public:
+    explicit SpeculationPolicy(const SpeculationConfig &config) : config_(config) {}
+
+    /**
+     * @brief 本帧是否同时提交两个模型
+     *
+     */
+    bool speculate() const;
+
+    /**
+     * @brief 记录门控模型结果
+     *
+     * @param passed 门控通过 (需要二阶段结果)
+     */
+    void record(const bool passed);
+
+    float pass_rate() const { return pass_rate_.load(std::memory_order_relaxed); }
+
+private:
+    SpeculationConfig config_;
+    std::atomic<float> pass_rate_{0};
+};
+
+/**
+ * @brief 异步推理的结果, 提交前即可拷贝给其他回调等待
+ *
+ */
+class InferFuture {
+public:
+    using clock = std::chrono::steady_clock;
+
+    /**
+     * @param out_package 推理成功时结果写入该 Package
+     */
+    explicit InferFuture(gddeploy::PackagePtr out_package);
+
+    void submit(ModelSession &session, const gddeploy::PackagePtr &in_package);
+
+    /**
+     * @brief 等待推理完成 (阻塞, 只用于同步推理的调用线程, 不能在推理回调里调用)
+     *
+     * @return true 推理成功
+     */
+    bool get() const;
+
+    /**
+     * @brief 推理完成后调用 continuation, 不阻塞: 已完成时在当前线程调用, 否则在推理完成回调的线程调用; 只能设置一次
+     *
+     */
+    void then(std::function<void()> continuation) const;
+
+    /**
+     * @brief 推理完成的时间, 完成后 (get 返回或 continuation 中) 读取
+     *
+     */
+    clock::time_point finished() const;
+
+    const gddeploy::PackagePtr &out_package() const { return out_package_; }
+
+private:
+    struct State;
+
+    std::shared_ptr<State> state_;
+    gddeploy::PackagePtr out_package_;
+};
+
+/**
+ * @brief 两个模型按先后顺序同时提交, 都完成后返回 (surface 引用调用方的图像)
+ *
+ * 调用序号与依次调用 InferSync 相同, 录制/回放不受执行方式影响.
+ * 计时: kInferStage1 到第一个模型完成, kInferStage2 为之后继续等待第二个模型的时间 (第二个模型先完成时为 0)
+ *
+ * @return int 第一个模型成功为 0; 第二个模型失败时 second_out 没有结果, 与顺序执行时忽略二阶段返回值一致
+ */
+int infer_concurrent(ModelSession &first, const gddeploy::PackagePtr &first_in, const gddeploy::PackagePtr &first_out,
+                     ModelSession &second, const gddeploy::PackagePtr &second_in,
+                     const gddeploy::PackagePtr &second_out, StageTimer &timer);
+
+}// namespace gddi
@@ -0,0 +1,217 @@
+/**
+ * @file stage_timer.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 算法流水线分阶段计时
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 by GDDI
+ *
+ */
+
+#pragma once
+
+#include "frame_context.h"
+#include "frame_trace.h"
+#include "latency_histogram.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace gddi {
+
+struct LatencyMetric;
+
+enum class AlgoStage : uint32_t {
+    kPreprocess = 0,// 整帧 convertMat2BufSurface
+    kInferStage1,   // 一阶段推理 (异步为提交到后处理线程开始执行的时间)
+    kTrack,         // 目标跟踪
+    kCrop,          // 裁剪 + convertMat2BufSurface
+    kInferStage2,   // 二阶段推理
+    kInferStage3,   // 三阶段推理
+    kStatistic,     // 后处理 & 时序统计
+    kCallback,      // 用户回调
+    kTotal,         // 整帧
+    kCount
+};
+
+const char *algo_stage_name(AlgoStage stage);
+
+/**
+ * @brief 直方图注册表, 同一 (algo, stage, stream) 返回同一直方图, 直方图生命周期与进程相同
+ *
+ */
+LatencyHistogram *register_latency_histogram(const std::string &algo, AlgoStage stage, int32_t stream);
+
+/**
+ * @brief 直方图快照 (样本数/累计/分位数/非空桶) 写入 metric, 不修改 algo/stage/stream
+ *
+ */
+void fill_latency_metric(const LatencyHistogram &histogram, LatencyMetric &metric);
+
+/**
+ * @brief 每批输入数计数, 按输入数逐个计数 (超过 kMaxSize 的批计入 kMaxSize)
+ *
+ */
+struct BatchSizeCounter {
+    static constexpr uint32_t kMaxSize = 64;
+
+    std::array<std::atomic<uint64_t>, kMaxSize + 1> batches{};// 下标为每批输入数
+    std::atomic<uint64_t> inputs{0};
+    std::atomic<uint32_t> max{0};
+
+    void record(const size_t batch_size) {
+        batches[std::min<size_t>(batch_size, kMaxSize)].fetch_add(1, std::memory_order_relaxed);
+        inputs.fetch_add(batch_size, std::memory_order_relaxed);
+        auto size = static_cast<uint32_t>(batch_size);
+        auto current = max.load(std::memory_order_relaxed);
+        while (size > current && !max.compare_exchange_weak(current, size, std::memory_order_relaxed)) {}
+    }
+
+    void reset() {
+        for (auto &count : batches) { count.store(0, std::memory_order_relaxed); }
+        inputs.store(0, std::memory_order_relaxed);
+        max.store(0, std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @brief 跨视频流合批统计, 热路径只有原子操作
+ *
+ */
+struct BatchHistograms {
+    BatchSizeCounter batch_size; // 每批输入数
+    LatencyHistogram queue_delay;// 请求提交到所在批提交的等待时间(us)
+};
+
+/**
+ * @brief 合批统计注册表, 同一 (algo, model) 返回同一统计, 生命周期与进程相同
+ *
+ */
+BatchHistograms *register_batch_histograms(const std::string &algo, uint32_t model);
+
+/**
+ * @brief 跳帧计数 (运动门控等), 热路径只有原子自增
+ *
+ */
+struct SkipCounter {
+    std::atomic<uint64_t> frames{0}; // 经过门控的帧数
+    std::atomic<uint64_t> skipped{0};// 跳过推理的帧数
+
+    void record(const bool skip) {
+        frames.fetch_add(1, std::memory_order_relaxed);
+        if (skip) { skipped.fetch_add(1, std::memory_order_relaxed); }
+    }
+};
+
+/**
+ * @brief 跳帧计数注册表, 同一 (algo, gate, stream) 返回同一计数器, 生命周期与进程相同
+ *
+ * @param gate 跳帧原因 (motion/...)
+ */
+SkipCounter *register_skip_counter(const std::string &algo, const std::string &gate, int32_t stream);
+
+/**
+ * @brief 单个算法实例 (单路视频流) 的各阶段直方图, 构造时一次性注册, 热路径无锁
+ *
+ */
+class StageMetrics {
+public:
+    StageMetrics(const char *algo, int32_t stream = 0) : algo_(algo), stream_(stream) {
+        for (uint32_t i = 0; i < histograms_.size(); i++) {
+            histograms_[i] = register_latency_histogram(algo, static_cast<AlgoStage>(i), stream);
+        }
+    }
+
+    void record(AlgoStage stage, std::chrono::steady_clock::duration elapsed) const {
+        histograms_[static_cast<uint32_t>(stage)]->record(
+            std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+    }
+
+    const char *algo() const { return algo_; }
+    int32_t stream() const { return stream_; }
+
+private:
+    const char *algo_;
+    int32_t stream_;
+    std::array<LatencyHistogram *, static_cast<uint32_t>(AlgoStage::kCount)> histograms_;
+};
+
+/**
+ * @brief 分段计时, lap 记录距上一次打点的耗时, 析构时记录整帧耗时
+ *
+ * 异步推理时通过 handoff 把计时交给回调继续, 本对象析构时不再记录
+ * 开启 GDDI_ENABLE_TRACE 时同时记录每个阶段的 span
+ */
+class StageTimer {
+public:
+    using clock = std::chrono::steady_clock;
+
+    struct State {
+        const StageMetrics *metrics;
+        int64_t frame_id;
+        clock::time_point start;
+        clock::time_point last;
+    };
+
+    StageTimer(const StageMetrics &metrics, int64_t frame_id) : state_{&metrics, frame_id, clock::now(), {}} {
+        state_.last = state_.start;
+        bind_frame_context();
+    }
+    explicit StageTimer(const State &state) : state_(state) { bind_frame_context(); }
+    ~StageTimer() {
+        if (state_.metrics) {
+            auto now = clock::now();
+            state_.metrics->record(AlgoStage::kTotal, now - state_.start);
+            trace(AlgoStage::kTotal, state_.start, now);
+        }
+    }
+
+    StageTimer(const StageTimer &) = delete;
+    StageTimer &operator=(const StageTimer &) = delete;
+
+    void lap(AlgoStage stage) { lap(stage, clock::now()); }
+
+    /**
+     * @brief 以指定时间打点, 用于在其他线程完成的阶段 (如投机执行时门控模型的完成时间); 早于上一次打点时耗时记为 0
+     *
+     */
+    void lap(AlgoStage stage, clock::time_point at) {
+        at = std::max(at, state_.last);
+        state_.metrics->record(stage, at - state_.last);
+        trace(stage, state_.last, at);
+        state_.last = at;
+    }
+
+    State handoff() {
+        auto state = state_;
+        state_.metrics = nullptr;
+        return state;
+    }
+
+private:
+    void bind_frame_context() {
+        auto &context = current_frame_context();
+        context.algo = state_.metrics->algo();
+        context.frame_id = state_.frame_id;
+        context.stream = state_.metrics->stream();
+        context.flow = state_.metrics;
+        context.model_calls = 0;
+    }
+
+    void trace(AlgoStage stage, clock::time_point start, clock::time_point end) const {
+#ifdef GDDI_ENABLE_TRACE
+        if (trace_enabled()) {
+            record_trace_span(state_.metrics->algo(), algo_stage_name(stage), state_.frame_id,
+                              state_.metrics->stream(), start, end);
+        }
+#endif
+    }
+
+    State state_;
+};
+
+}// namespace gddi
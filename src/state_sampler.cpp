@@ -0,0 +1,21 @@
+#include "state_sampler.h"
+
+namespace gddi {
+
+StateSampler::StateSampler(const StateSamplerConfig &config, const std::string &algo, const int32_t stream)
+    : interval_(std::chrono::duration_cast<clock::duration>(std::chrono::duration<float>(config.interval))),
+      hysteresis_(std::max(config.hysteresis, 1)), counter_(register_skip_counter(algo, "state", stream)) {}
+
+bool StateSampler::due() {
+    auto now = clock::now();
+    bool due = !has_sample_ || switching_.load(std::memory_order_acquire) || now - last_sample_ >= interval_;
+    if (due) {
+        last_sample_ = now;
+        has_sample_ = true;
+    }
+
+    counter_->record(!due);
+    return due;
+}
+
+}// namespace gddi
@@ -0,0 +1,89 @@
+/**
+ * @file state_sampler.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 门控模型状态低频采样: 灯光开关、门开关等缓慢变化的状态按间隔推理, 其余帧沿用, 切换带迟滞
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 by GDDI
+ *
+ */
+
+#pragma once
+
+#include "stage_timer.h"
+#include "struct_def.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace gddi {
+
+/**
+ * @brief 单路视频流的门控状态
+ *
+ * due 只由提交帧的线程调用 (同一视频流串行); resolve 在视频流锁内调用, 二者只共享切换确认标志.
+ */
+class StateSampler {
+public:
+    using clock = std::chrono::steady_clock;
+
+    StateSampler(const StateSamplerConfig &config, const std::string &algo, const int32_t stream);
+
+    /**
+     * @brief 本帧是否推理门控模型, 同时记录跳帧计数
+     *
+     * 第一帧、距上一次采样超过间隔、或状态切换确认期间返回 true
+     */
+    bool due();
+
+    /**
+     * @brief 采样帧更新状态, 之后把 objects 替换为当前状态对应的门控模型结果 (最近一次与当前状态一致的采样)
+     *
+     * @param objects 门控模型结果, 未采样的帧为空
+     * @param sampled 本帧是否推理了门控模型
+     * @param active 目标是否表示状态开启 (例如灯亮), 默认有目标即开启
+     */
+    template <typename Objects, typename Predicate>
+    void resolve(Objects &objects, const bool sampled, Predicate active) {
+        if (sampled) { update(std::any_of(objects.begin(), objects.end(), active), objects); }
+        objects.assign(objects_.begin(), objects_.end());
+    }
+
+    template <typename Objects>
+    void resolve(Objects &objects, const bool sampled) {
+        resolve(objects, sampled, [](const AlgoObject &) { return true; });
+    }
+
+private:
+    template <typename Objects>
+    void update(const bool active, const Objects &objects) {
+        if (has_state_ && active != active_ && ++pending_ < hysteresis_) {
+            switching_.store(true, std::memory_order_release);
+            return;
+        }
+
+        active_ = active;
+        has_state_ = true;
+        pending_ = 0;
+        objects_.assign(objects.begin(), objects.end());
+        switching_.store(false, std::memory_order_release);
+    }
+
+    clock::duration interval_;
+    int hysteresis_;
+    SkipCounter *counter_;
+
+    clock::time_point last_sample_;
+    bool has_sample_{false};
+
+    bool active_{false};
+    bool has_state_{false};
+    int pending_{0};
+    std::vector<AlgoObject> objects_;
+    std::atomic<bool> switching_{false};// 状态切换确认中, 每帧采样
+};
+
+}// namespace gddi
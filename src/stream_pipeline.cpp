@@ -0,0 +1,222 @@
+#include "stream_pipeline.h"
+#include "latency_histogram.h"
+#include "spdlog/spdlog.h"
+#include "stage_timer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <moodycamel/blockingconcurrentqueue.h>
+#include <moodycamel/lightweightsemaphore.h>
+#include <mutex>
+#include <opencv2/videoio.hpp>
+#include <thread>
+#include <vector>
+
+namespace gddi {
+
+namespace {
+
+using clock = std::chrono::steady_clock;
+
+// 等待中的线程按该间隔 (us) 检查停止标志
+constexpr int64_t kPollIntervalUs = 10000;
+
+struct PipelineFrame {
+    int32_t stream_id{0};
+    int64_t image_id{0};
+    cv::Mat image;
+    clock::time_point decoded;
+};
+
+// 单个推理线程的帧队列; slots 为剩余容量, 入队前占用一个, 出队后归还
+struct FrameQueue {
+    explicit FrameQueue(const uint32_t capacity) : frames(capacity), slots(capacity) {}
+
+    moodycamel::BlockingConcurrentQueue<PipelineFrame> frames;
+    moodycamel::LightweightSemaphore slots;
+};
+
+struct PipelineSource {
+    int32_t stream_id;
+    std::unique_ptr<cv::VideoCapture> capture;
+    FrameQueue *queue;
+};
+
+uint64_t elapsed_us(const clock::time_point begin, const clock::time_point end) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+}
+
+}// namespace
+
+class StreamPipeline::StreamPipelinePrivate {
+public:
+    StreamPipelinePrivate(const StreamPipelineConfig &config, PipelineHandler handler)
+        : config(config), handler(std::move(handler)) {
+        this->config.num_workers = std::max(config.num_workers, 1u);
+        this->config.queue_capacity = std::max(config.queue_capacity, 1u);
+        for (uint32_t i = 0; i < this->config.num_workers; i++) {
+            queues.emplace_back(std::make_unique<FrameQueue>(this->config.queue_capacity));
+        }
+    }
+
+    void launch(std::unique_ptr<PipelineSource> source) {
+        decoders.emplace_back([this, source = std::move(source)]() { decode(*source); });
+    }
+
+    void decode(PipelineSource &source);
+    void work(FrameQueue &queue);
+
+    /**
+     * @brief 等待解码线程退出, 再等待推理线程取空队列后退出
+     *
+     */
+    void finish();
+
+    StreamPipelineConfig config;
+    PipelineHandler handler;
+    std::vector<std::unique_ptr<FrameQueue>> queues;
+
+    std::mutex mutex;// sources/decoders/workers/started/closed
+    std::vector<std::unique_ptr<PipelineSource>> sources;// 启动前添加的视频源
+    std::vector<std::thread> decoders;
+    std::vector<std::thread> workers;
+    size_t num_sources{0};
+    bool started{false};
+    bool closed{false};// 已停止, 不再接受视频源
+
+    std::mutex finish_mutex;
+    std::atomic<bool> stopping{false};     // 解码线程尽快退出
+    std::atomic<bool> decoding_done{false};// 解码线程全部退出, 之后不会再有帧入队
+
+    std::atomic<uint64_t> decoded{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> processed{0};
+    LatencyHistogram queue_wait;
+    LatencyHistogram latency;
+};
+
+void StreamPipeline::StreamPipelinePrivate::decode(PipelineSource &source) {
+    auto fps = config.realtime ? source.capture->get(cv::CAP_PROP_FPS) : 0;
+    auto interval = fps > 0 ? std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1 / fps))
+                            : clock::duration::zero();
+    auto next = clock::now();
+
+    auto &queue = *source.queue;
+    for (int64_t image_id = 0; !stopping.load(std::memory_order_relaxed); image_id++) {
+        if (interval > clock::duration::zero()) {
+            std::this_thread::sleep_until(next);
+            next += interval;
+        }
+
+        cv::Mat image;
+        if (!source.capture->read(image) || image.empty()) { break; }
+        decoded.fetch_add(1, std::memory_order_relaxed);
+
+        if (config.drop_when_full) {
+            if (!queue.slots.tryWait()) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+        } else {
+            while (!queue.slots.wait(kPollIntervalUs)) {
+                if (stopping.load(std::memory_order_relaxed)) { return; }
+            }
+        }
+        queue.frames.enqueue(PipelineFrame{source.stream_id, image_id, std::move(image), clock::now()});
+    }
+}
+
+void StreamPipeline::StreamPipelinePrivate::work(FrameQueue &queue) {
+    PipelineFrame frame;
+    while (true) {
+        if (!queue.frames.wait_dequeue_timed(frame, kPollIntervalUs)) {
+            // 解码线程全部退出后入队已完成, 此时队列为空即可退出
+            if (!decoding_done.load(std::memory_order_acquire)) { continue; }
+            if (!queue.frames.try_dequeue(frame)) { break; }
+        }
+        queue.slots.signal();
+
+        auto begin = clock::now();
+        queue_wait.record(elapsed_us(frame.decoded, begin));
+        handler(frame.stream_id, frame.image_id, frame.image);
+        latency.record(elapsed_us(frame.decoded, clock::now()));
+        processed.fetch_add(1, std::memory_order_relaxed);
+        frame.image.release();
+    }
+}
+
+void StreamPipeline::StreamPipelinePrivate::finish() {
+    std::lock_guard<std::mutex> finish_lock(finish_mutex);
+
+    std::vector<std::thread> decoder_threads, worker_threads;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        decoder_threads.swap(decoders);
+        worker_threads.swap(workers);
+    }
+
+    for (auto &thread : decoder_threads) { thread.join(); }
+    decoding_done.store(true, std::memory_order_release);
+    for (auto &thread : worker_threads) { thread.join(); }
+}
+
+StreamPipeline::StreamPipeline(const StreamPipelineConfig &config, PipelineHandler handler)
+    : private_(std::make_unique<StreamPipelinePrivate>(config, std::move(handler))) {}
+
+StreamPipeline::~StreamPipeline() { stop(); }
+
+bool StreamPipeline::add_source(const int32_t stream_id, const std::string &uri) {
+    auto capture = std::make_unique<cv::VideoCapture>(uri);
+    if (!capture->isOpened()) {
+        spdlog::error("Failed to open video: {}", uri);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(private_->mutex);
+    if (private_->closed) { return false; }
+
+    auto *queue = private_->queues[private_->num_sources++ % private_->queues.size()].get();
+    auto source = std::make_unique<PipelineSource>(PipelineSource{stream_id, std::move(capture), queue});
+    if (private_->started) {
+        private_->launch(std::move(source));
+    } else {
+        private_->sources.emplace_back(std::move(source));
+    }
+    return true;
+}
+
+void StreamPipeline::start() {
+    std::lock_guard<std::mutex> lock(private_->mutex);
+    if (private_->started || private_->closed) { return; }
+    private_->started = true;
+
+    for (auto &queue : private_->queues) {
+        private_->workers.emplace_back([this, queue = queue.get()]() { private_->work(*queue); });
+    }
+    for (auto &source : private_->sources) { private_->launch(std::move(source)); }
+    private_->sources.clear();
+}
+
+void StreamPipeline::stop() {
+    private_->stopping.store(true, std::memory_order_relaxed);
+    private_->finish();
+}
+
+void StreamPipeline::wait() { private_->finish(); }
+
+PipelineStats StreamPipeline::stats() const {
+    PipelineStats stats;
+    stats.decoded = private_->decoded.load(std::memory_order_relaxed);
+    stats.dropped = private_->dropped.load(std::memory_order_relaxed);
+    stats.processed = private_->processed.load(std::memory_order_relaxed);
+
+    stats.queue_wait.algo = stats.latency.algo = "StreamPipeline";
+    stats.queue_wait.stage = "queue_wait";
+    stats.latency.stage = "latency";
+    fill_latency_metric(private_->queue_wait, stats.queue_wait);
+    fill_latency_metric(private_->latency, stats.latency);
+    return stats;
+}
+
+}// namespace gddi
@@ -0,0 +1,151 @@
+/**
+ * @file stream_state.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 单路视频流状态 & 按 stream_id 分片的无锁状态表
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 by GDDI
+ *
+ * 并发模型:
+ *   - 模型 (model_impls/model_configs) 为实例共享只读状态, load_models 完成后不再修改
+ *   - 跟踪器/时序统计等随帧变化的状态按 stream_id 分片, 每路视频流一份
+ *   - 不同 stream_id 的 sync_infer 可在多个线程并发执行, 热路径只有分片自身的锁 (正常使用下无竞争)
+ *   - 同一 stream_id 的并发调用按分片锁串行, 帧顺序由调用方保证
+ */
+
+#pragma once
+
+#include "bytetrack/BYTETracker.h"
+#include "frame_arena.h"
+#include "frame_sequencer.h"
+#include "motion_gate.h"
+#include "region_mask.h"
+#include "scene_cache.h"
+#include "sequence_statistic.h"
+#include "speculative_infer.h"
+#include "stage_timer.h"
+#include "state_sampler.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace gddi {
+
+/**
+ * @brief 单路视频流状态, 不需要的成员保持为空
+ *
+ */
+struct StreamState {
+    StreamState(const char *algo, const int32_t stream_id) : metrics(algo, stream_id) {}
+
+    std::mutex mutex;
+    StageMetrics metrics;
+    FrameArena arena;
+    std::unique_ptr<BYTETracker> tracker;
+    std::unique_ptr<SequenceStatistic> sequence_statistic;
+    std::unique_ptr<RegionMask> region;            // 检测区域, 为空不过滤
+    std::unique_ptr<MotionGate> motion_gate;       // 运动门控, 为空每帧推理
+    std::unique_ptr<SceneCache> scene_cache;       // 场景分类缓存, 为空每帧分类
+    std::unique_ptr<StateSampler> state_sampler;   // 门控模型状态采样, 为空每帧推理
+    std::unique_ptr<SpeculationPolicy> speculation;// 二阶段投机执行, 为空顺序执行
+    std::unique_ptr<FrameSequencer> sequencer;     // 异步推理结果按帧顺序交付, 只有异步接口使用
+};
+
+/**
+ * @brief 按 stream_id 分片的状态表, 两级定长数组, 首次访问时创建 (CAS), 查找无锁
+ *
+ * 分片创建后直到实例析构才释放, 返回的指针在实例生命周期内有效
+ */
+template <typename State = StreamState>
+class StreamShards {
+public:
+    using Factory = std::function<std::unique_ptr<State>(const int32_t stream_id)>;
+
+    static constexpr int32_t kSegmentBits = 6;
+    static constexpr int32_t kSegmentSize = 1 << kSegmentBits;
+    static constexpr int32_t kMaxSegments = 256;
+    static constexpr int32_t kMaxStreams = kSegmentSize * kMaxSegments;
+
+    StreamShards() = default;
+    ~StreamShards() {
+        for (auto &segment : segments_) {
+            auto states = segment.load(std::memory_order_acquire);
+            if (!states) { continue; }
+            for (auto &state : states->states) { delete state.load(std::memory_order_acquire); }
+            delete states;
+        }
+    }
+
+    StreamShards(const StreamShards &) = delete;
+    StreamShards &operator=(const StreamShards &) = delete;
+
+    /**
+     * @brief 设置分片构造函数, 必须在第一次 get 之前调用
+     *
+     */
+    void init(Factory factory) { factory_ = std::move(factory); }
+
+    /**
+     * @brief 获取 stream_id 对应的分片, 不存在时创建
+     *
+     * @return State* stream_id 超出 [0, kMaxStreams) 时返回 nullptr
+     */
+    State *get(const int32_t stream_id) {
+        if (stream_id < 0 || stream_id >= kMaxStreams) { return nullptr; }
+
+        auto &segment = segments_[stream_id >> kSegmentBits];
+        auto states = segment.load(std::memory_order_acquire);
+        if (!states) {
+            auto created = new Segment();
+            if (segment.compare_exchange_strong(states, created, std::memory_order_acq_rel,
+                                                std::memory_order_acquire)) {
+                states = created;
+            } else {
+                delete created;
+            }
+        }
+
+        auto &slot = states->states[stream_id & (kSegmentSize - 1)];
+        auto state = slot.load(std::memory_order_acquire);
+        if (!state) {
+            // 多个线程同时创建时只保留一个, 其余丢弃
+            auto created = factory_(stream_id).release();
+            if (slot.compare_exchange_strong(state, created, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                state = created;
+            } else {
+                delete created;
+            }
+        }
+
+        return state;
+    }
+
+    /**
+     * @brief 遍历已创建的分片, 不能与 get 并发调用 (用于析构前收尾)
+     *
+     */
+    template <typename Visitor>
+    void for_each(Visitor visitor) {
+        for (auto &segment : segments_) {
+            auto states = segment.load(std::memory_order_acquire);
+            if (!states) { continue; }
+            for (auto &slot : states->states) {
+                if (auto state = slot.load(std::memory_order_acquire)) { visitor(*state); }
+            }
+        }
+    }
+
+private:
+    struct Segment {
+        std::array<std::atomic<State *>, kSegmentSize> states{};
+    };
+
+    Factory factory_;
+    std::array<std::atomic<Segment *>, kMaxSegments> segments_{};
+};
+
+}// namespace gddi
@@ -0,0 +1,102 @@
+#include "tiled_infer.h"
+#include "crop_planner.h"
+#include "region_mask.h"
+#include "utils.h"
+#include <core/alg_param.h>
+
+namespace gddi {
+
+std::shared_ptr<TileBatch> make_tile_batch(const ModelSession &session, const cv::Mat &image,
+                                           const ModelConfig &config, const RegionMask *region,
+                                           const cv::Rect &bounds) {
+    auto area = bounds.empty() ? cv::Rect(0, 0, image.cols, image.rows) : bounds;
+    if (!tiling_enabled(area.width, area.height, config.tile_size)) { return nullptr; }
+
+    auto batch = std::make_shared<TileBatch>();
+    for (auto tile : plan_tiles(area.width, area.height, config.tile_size, config.tile_overlap)) {
+        tile += area.tl();
+        if (region && !region->intersects(tile)) { continue; }
+        batch->tiles.emplace_back(tile);
+    }
+    batch->package = gddeploy::Package::Create(batch->tiles.size());
+
+    for (size_t i = 0; i < batch->tiles.size(); i++) {
+        batch->images.emplace_back(image(batch->tiles[i]).clone());
+
+        gddeploy::BufSurfWrapperPtr surface;
+        convert_mat_to_surface(session, batch->images.back(), surface);
+        batch->package->data[i]->Set(surface);
+        batch->package->data[i]->SetAlgParam(gddeploy::AlgDetectParam{config.threshold, config.nms_threshold});
+    }
+
+    return batch;
+}
+
+FrameObjects merge_tile_results(const TileBatch &batch, const gddeploy::PackagePtr &out_package,
+                                const TileParser &parse, const float merge_threshold,
+                                std::pmr::memory_resource *resource) {
+    FrameObjects objects(resource);
+    std::pmr::vector<uint32_t> tile_indices(resource);// 各目标所在的分块
+    auto count = std::min(batch.tiles.size(), out_package->data.size());
+    for (size_t i = 0; i < count; i++) {
+        if (!out_package->data[i]->HasMetaValue()) { continue; }
+
+        auto tile_objects = parse(out_package->data[i]->GetMetaData<gddeploy::InferResult>());
+        translate_objects(tile_objects, batch.tiles[i].tl());
+        objects.insert(objects.end(), tile_objects.begin(), tile_objects.end());
+        tile_indices.resize(objects.size(), static_cast<uint32_t>(i));
+    }
+    if (merge_threshold <= 0 || objects.size() < 2) { return objects; }
+
+    // 分数降序, 同一分块内的目标已由模型 NMS 处理, 只合并不同分块的目标
+    thread_local std::vector<uint32_t> order;
+    thread_local std::vector<uint8_t> merged;
+    thread_local std::vector<float> cover_rates;
+    thread_local BoxArray boxes;
+
+    auto num_objects = objects.size();
+    order.resize(num_objects);
+    for (uint32_t i = 0; i < num_objects; i++) { order[i] = i; }
+    std::stable_sort(order.begin(), order.end(),
+                     [&objects](const uint32_t a, const uint32_t b) { return objects[a].score > objects[b].score; });
+
+    boxes.clear();
+    for (auto index : order) { boxes.push_back(objects[index].rect); }
+    overlap_matrix(boxes, boxes, cover_rates, OverlapMetric::kCoverMin);
+
+    merged.assign(num_objects, 0);
+    for (size_t i = 0; i < num_objects; i++) {
+        auto &target = objects[order[i]];
+        if (merged[order[i]]) { continue; }
+        for (size_t j = i + 1; j < num_objects; j++) {
+            auto index = order[j];
+            if (merged[index] || tile_indices[index] == tile_indices[order[i]] || objects[index].label != target.label
+                || cover_rates[i * num_objects + j] <= merge_threshold) {
+                continue;
+            }
+            target.rect |= objects[index].rect;
+            merged[index] = 1;
+        }
+    }
+
+    size_t num_kept = 0;
+    for (size_t i = 0; i < num_objects; i++) {
+        if (merged[i]) { continue; }
+        if (num_kept != i) { objects[num_kept] = std::move(objects[i]); }
+        num_kept++;
+    }
+    objects.erase(objects.begin() + num_kept, objects.end());
+    return objects;
+}
+
+int infer_tiles(ModelSession &session, const TileBatch &batch, const TileParser &parse, const float merge_threshold,
+                FrameObjects &objects) {
+    auto out_package = gddeploy::Package::Create(batch.tiles.size());
+    auto ret = session.InferSync(batch.package, out_package);
+    if (ret != 0) { return ret; }
+
+    objects = merge_tile_results(batch, out_package, parse, merge_threshold, objects.get_allocator().resource());
+    return 0;
+}
+
+}// namespace gddi
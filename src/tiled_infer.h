@@ -0,0 +1,69 @@
+/**
+ * @file tiled_infer.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 全图检测分块推理: 重叠分块一个批次提交, 结果换算回原图后合并跨分块的重复目标
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 by GDDI
+ *
+ */
+
+#pragma once
+
+#include "frame_arena.h"
+#include "model_session.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace gddi {
+
+class RegionMask;
+
+/**
+ * @brief 一帧的分块推理输入, 全部分块放入同一个 Package (每个分块一个数据)
+ *
+ */
+struct TileBatch {
+    std::vector<cv::Rect> tiles;
+    std::vector<cv::Mat> images;// surface 不复制图像数据, 需保持到推理结束
+    gddeploy::PackagePtr package;
+};
+
+using TileParser = std::function<FrameObjects(const gddeploy::InferResult &)>;
+
+/**
+ * @brief 按模型配置 (tile_size/tile_overlap) 生成分块推理输入
+ *
+ * @param session 一阶段模型会话, 不读取输入时 (回放或替身后端) 不转换分块图像
+ * @param region 不为空时跳过不含检测区域的分块
+ * @param bounds 不为空时只在该区域内分块 (RegionMask::infer_rect), 分块座标仍为原图座标
+ * @return std::shared_ptr<TileBatch> 未开启分块时为空; 分块全部在检测区域外时 tiles 为空, ModelSession 不调用模型
+ */
+std::shared_ptr<TileBatch> make_tile_batch(const ModelSession &session, const cv::Mat &image,
+                                           const ModelConfig &config, const RegionMask *region,
+                                           const cv::Rect &bounds = cv::Rect());
+
+/**
+ * @brief 各分块的推理结果换算回原图座标, 合并分块重叠处重复检出的目标
+ *
+ * 跨越分块边界的目标在一个分块内被截断, 与相邻分块检出的完整目标 IoU 较低, 因此按覆盖率 (交集 / 较小框面积) 判断:
+ * 不同分块检出的同标签目标覆盖率大于阈值时, 保留分数高的目标, 目标框取两者的并集
+ *
+ * @param parse 解析单个分块的推理结果 (分块座标)
+ * @param merge_threshold 覆盖率阈值 (ModelConfig::tile_merge_threshold), 0 不合并
+ */
+FrameObjects merge_tile_results(const TileBatch &batch, const gddeploy::PackagePtr &out_package,
+                                const TileParser &parse, const float merge_threshold,
+                                std::pmr::memory_resource *resource);
+
+/**
+ * @brief 同步分块推理, 合并后的结果写入 objects
+ *
+ * @return int 模型返回值, 没有分块需要推理时为 0
+ */
+int infer_tiles(ModelSession &session, const TileBatch &batch, const TileParser &parse, const float merge_threshold,
+                FrameObjects &objects);
+
+}// namespace gddi
@@ -9,9 +9,17 @@
  * 
  */
 
+#include "box_iou.h"
 #include <boost/geometry.hpp>
 #include <boost/geometry/geometries/point_xy.hpp>
 #include <boost/geometry/geometries/polygon.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <memory_resource>
+#include <set>
+#include <vector>
 
 namespace bg = boost::geometry;
 using point_type = bg::model::d2::point_xy<float>;
@@ -86,6 +94,20 @@ inline cv::Rect2i scale_crop_rect(const int img_w, const int img_h, const cv::Re
     return sacled_rect;
 }
 
+/**
+ * @brief 裁剪图像上的检测结果换算回原图座标
+ *
+ * @param offset 裁剪区域左上角
+ */
+template <typename Objects>
+inline void translate_objects(Objects &objects, const cv::Point &offset) {
+    if (offset.x == 0 && offset.y == 0) { return; }
+    for (auto &obj : objects) {
+        obj.rect.x += offset.x;
+        obj.rect.y += offset.y;
+    }
+}
+
 inline polygon_type convert_polygon(const cv::Rect &rect) {
     polygon_type poly;
     bg::append(poly, bg::make<bg::model::d2::point_xy<float>>(rect.x, rect.y));
@@ -96,6 +118,13 @@ inline polygon_type convert_polygon(const cv::Rect &rect) {
     return poly;
 }
 
+inline polygon_type convert_polygon(const std::vector<cv::Point> &points) {
+    polygon_type poly;
+    for (const auto &point : points) { bg::append(poly, bg::make<point_type>(point.x, point.y)); }
+    bg::correct(poly);
+    return poly;
+}
+
 inline float intersection(const polygon_type &poly1, const polygon_type &poly2) {
     std::vector<polygon_type> inter_output;
     bg::intersection(poly1, poly2, inter_output);
@@ -105,38 +134,45 @@ inline float intersection(const polygon_type &poly1, const polygon_type &poly2)
 }
 
 inline float area_cover_rate(const cv::Rect &rect1, const cv::Rect &rect2) {
-    polygon_type poly1 = convert_polygon(rect1);
-    polygon_type poly2 = convert_polygon(rect2);
+    // 轴对齐矩形的交集仍是矩形, 结果与多边形求交一致, 不需要构造多边形 (每次调用多次堆分配)
+    float inter_area = (rect1 & rect2).area();
 
-    auto inter_area = intersection(poly1, poly2);
-
-    return inter_area / std::min(bg::area(poly1), bg::area(poly2));
+    return inter_area / std::min(rect1.area(), rect2.area());
 }
 
-inline std::vector<AlgoObject> find_cover_objects(const std::vector<AlgoObject> &objects,
-                                                  const std::set<std::string> &include_labels,
-                                                  const std::set<std::string> &exclude_labels,
-                                                  const std::string &map_label, const float cover_threshold = 0.5) {
-    std::vector<AlgoObject> cover_targets;
+inline FrameObjects find_cover_objects(const FrameObjects &objects, const std::set<std::string> &include_labels,
+                                       const std::set<std::string> &exclude_labels, const std::string &map_label,
+                                       const float cover_threshold = 0.5,
+                                       std::pmr::memory_resource *resource = std::pmr::get_default_resource()) {
+    FrameObjects cover_targets(resource);
+
+    // 两两覆盖率一次算出
+    thread_local BoxArray boxes;
+    boxes.clear();
+    for (auto &item : objects) { boxes.push_back(item.rect); }
+    std::pmr::vector<float> cover_rates(objects.size() * objects.size(), resource);
+    overlap_matrix(boxes, boxes, cover_rates.data(), OverlapMetric::kCoverMin);
 
-    std::set<int> include_ids;
-    for (auto &target_1 : objects) {
+    std::pmr::set<int> include_ids(resource);
+    for (size_t i = 0; i < objects.size(); i++) {
+        auto &target_1 = objects[i];
         // 不在目标类别，在排除类别，或者在已记录的列表，直接跳过
         if (include_labels.count(target_1.label) == 0 || exclude_labels.count(target_1.label) > 0
             || include_ids.count(target_1.target_id) > 0) {
             continue;
         }
 
-        std::map<int, AlgoObject> current_objects{{target_1.target_id, target_1}};
-        std::set<std::string> target_labels{target_1.label};
-        for (auto &target_2 : objects) {
+        std::pmr::map<int, AlgoObject> current_objects({{target_1.target_id, target_1}}, resource);
+        std::pmr::set<std::string> target_labels({target_1.label}, resource);
+        for (size_t j = 0; j < objects.size(); j++) {
+            auto &target_2 = objects[j];
             if (target_labels.count(target_2.label) > 0 || include_labels.count(target_2.label) == 0
                 || include_ids.count(target_2.target_id) > 0) {
                 continue;
             }
 
             // 计算两个目标的IOU
-            auto cover_rate = area_cover_rate(target_1.rect, target_2.rect);
+            auto cover_rate = cover_rates[i * objects.size() + j];
             if (cover_rate > 0 && exclude_labels.count(target_2.label) > 0) {
                 break;
             } else if (cover_rate >= cover_threshold) {
@@ -173,4 +209,106 @@ inline std::vector<AlgoObject> find_cover_objects(const std::vector<AlgoObject>
     return cover_targets;
 }
 
+namespace detail {
+
+// order 为保留优先级从高到低的目标下标, 同标签且 IoU 大于阈值时删除优先级低的目标
+template <typename Objects>
+inline void suppress_in_order(Objects &objects, const std::vector<uint32_t> &order, const float iou_threshold) {
+    thread_local std::vector<uint8_t> suppressed;
+    thread_local std::vector<float> ious;
+    thread_local BoxArray boxes;
+
+    auto num_objects = objects.size();
+    boxes.clear();
+    for (auto index : order) { boxes.push_back(objects[index].rect); }
+    overlap_matrix(boxes, boxes, ious, OverlapMetric::kIoU);
+
+    suppressed.assign(num_objects, 0);
+    for (size_t i = 0; i < num_objects; i++) {
+        if (suppressed[order[i]]) { continue; }
+        auto &label = objects[order[i]].label;
+        for (size_t j = i + 1; j < num_objects; j++) {
+            if (ious[i * num_objects + j] > iou_threshold && objects[order[j]].label == label) {
+                suppressed[order[j]] = 1;
+            }
+        }
+    }
+
+    size_t num_kept = 0;
+    for (size_t i = 0; i < num_objects; i++) {
+        if (suppressed[i]) { continue; }
+        if (num_kept != i) { objects[num_kept] = std::move(objects[i]); }
+        num_kept++;
+    }
+    objects.erase(objects.begin() + num_kept, objects.end());
+}
+
+}// namespace detail
+
+/**
+ * @brief 同标签目标按分数降序做 NMS, 就地删除重复目标, 其余目标保持原顺序
+ *
+ * @param iou_threshold IoU 大于阈值视为重复, <= 0 不处理
+ */
+template <typename Objects>
+inline void suppress_duplicate_objects(Objects &objects, const float iou_threshold) {
+    if (iou_threshold <= 0 || objects.size() < 2) { return; }
+
+    thread_local std::vector<uint32_t> order;
+    order.resize(objects.size());
+    for (uint32_t i = 0; i < order.size(); i++) { order[i] = i; }
+    std::stable_sort(order.begin(), order.end(),
+                     [&objects](const uint32_t a, const uint32_t b) { return objects[a].score > objects[b].score; });
+
+    detail::suppress_in_order(objects, order, iou_threshold);
+}
+
+/**
+ * @brief 合并多个裁剪区域 (各属于一个跟踪目标) 的检测结果: 裁剪区域重叠时同一目标会被多次检出, 就地删除重复目标
+ *
+ * 重复目标保留给"自己的"跟踪目标, 不按分数选择, 避免保留的 track_id 在帧间来回切换 (影响 SequenceStatistic 的比例):
+ * 依次比较检测框落在所属跟踪目标框内的比例 (高者优先)、检测框中心到跟踪目标框中心的距离 (近者优先)、分数、track_id
+ *
+ * @param owners 裁剪对应的跟踪目标 (按 track_id 匹配 objects[i].track_id 取 rect), 找不到时视为不在框内
+ * @param iou_threshold IoU 大于阈值视为重复, <= 0 不处理
+ */
+template <typename Objects, typename Owners>
+inline void suppress_duplicate_objects(Objects &objects, const Owners &owners, const float iou_threshold) {
+    if (iou_threshold <= 0 || objects.size() < 2) { return; }
+
+    struct Rank {
+        float inside;
+        float distance;
+    };
+    thread_local std::vector<Rank> ranks;
+    thread_local std::vector<uint32_t> order;
+
+    auto num_objects = objects.size();
+    ranks.assign(num_objects, Rank{0, std::numeric_limits<float>::max()});
+    for (size_t i = 0; i < num_objects; i++) {
+        auto &rect = objects[i].rect;
+        for (const auto &owner : owners) {
+            if (owner.track_id != objects[i].track_id) { continue; }
+            auto area = rect.area();
+            ranks[i].inside = area > 0 ? static_cast<float>((rect & owner.rect).area()) / area : 0;
+            auto dx = (rect.x * 2 + rect.width) - (owner.rect.x * 2 + owner.rect.width);
+            auto dy = (rect.y * 2 + rect.height) - (owner.rect.y * 2 + owner.rect.height);
+            ranks[i].distance = std::sqrt(static_cast<float>(dx) * dx + static_cast<float>(dy) * dy);
+            break;
+        }
+    }
+
+    order.resize(num_objects);
+    for (uint32_t i = 0; i < num_objects; i++) { order[i] = i; }
+    std::sort(order.begin(), order.end(), [&objects](const uint32_t a, const uint32_t b) {
+        if (ranks[a].inside != ranks[b].inside) { return ranks[a].inside > ranks[b].inside; }
+        if (ranks[a].distance != ranks[b].distance) { return ranks[a].distance < ranks[b].distance; }
+        if (objects[a].score != objects[b].score) { return objects[a].score > objects[b].score; }
+        if (objects[a].track_id != objects[b].track_id) { return objects[a].track_id < objects[b].track_id; }
+        return a < b;
+    });
+
+    detail::suppress_in_order(objects, order, iou_threshold);
+}
+
 }// namespace gddi
\ No newline at end of file
@@ -1,7 +1,11 @@
 #include "weld_glove_algo.h"
 #include "bytetrack/BYTETracker.h"
+#include "model_session.h"
 #include "sequence_statistic.h"
 //#include "spdlog/spdlog.h"
+#include "speculative_infer.h"
+#include "stage_timer.h"
+#include "stream_state.h"
 #include "utils.h"
 #include <api/global_config.h>
 #include <bmcv_api_ext.h>
@@ -12,21 +16,33 @@ namespace gddi {
 
 class WeldGloveAlgo::WeldGloveAlgoPrivate {
 public:
-    std::unique_ptr<BYTETracker> tracker;
-    std::unique_ptr<SequenceStatistic> sequence_statistic;
+    StreamShards<> streams;
 
     std::mutex model_mutex;
     std::vector<ModelConfig> model_configs;
-    std::vector<std::unique_ptr<gddeploy::InferAPI>> model_impls;
+    std::vector<std::unique_ptr<ModelSession>> model_impls;
 };
 
 WeldGloveAlgo::WeldGloveAlgo(const WeldGloveAlgoConfig &config) : config_(config) {
     gddeploy::gddeploy_init("");
     private_ = std::make_unique<WeldGloveAlgoPrivate>();
 
-    private_->tracker = std::make_unique<BYTETracker>(0.3, 0.6, 0.8, 30);
-    private_->sequence_statistic =
-        std::make_unique<SequenceStatistic>(config_.statistics_interval, config_.statistics_threshold);
+    private_->streams.init([this](const int32_t stream_id) {
+        auto state = std::make_unique<StreamState>("WeldGloveAlgo", stream_id);
+        state->tracker = std::make_unique<BYTETracker>(0.3, 0.6, 0.8, 30);
+        if (auto region = config_.stream_regions.find(stream_id); region != config_.stream_regions.end()) {
+            state->region = std::make_unique<RegionMask>(region->second);
+        }
+        state->sequence_statistic =
+            std::make_unique<SequenceStatistic>(config_.statistics_interval, config_.statistics_threshold);
+        if (auto gate = config_.stream_motion_gates.find(stream_id); gate != config_.stream_motion_gates.end()) {
+            state->motion_gate = std::make_unique<MotionGate>(gate->second, "WeldGloveAlgo", stream_id);
+        }
+        if (config_.speculation.mode != SpeculationMode::kSequential) {
+            state->speculation = std::make_unique<SpeculationPolicy>(config_.speculation);
+        }
+        return state;
+    });
 }
 
 WeldGloveAlgo::~WeldGloveAlgo() {
@@ -39,11 +55,12 @@ bool WeldGloveAlgo::load_models(const std::vector<ModelConfig> &models) {
 
     private_->model_configs = models;
     for (const auto &model : models) {
-        auto algo_impl = std::make_unique<gddeploy::InferAPI>();
+        auto algo_impl = std::make_unique<ModelSession>("WeldGloveAlgo", private_->model_impls.size());
         if (algo_impl->Init("", model.path, model.license, gddeploy::ENUM_API_TYPE::ENUM_API_SESSION_API) != 0) {
             //spdlog::error("Failed to load model: {} - {}", model.name, model.path);
             return false;
         }
+        algo_impl->SetBatching(model.max_batch_size, model.batch_wait_us);
         private_->model_impls.emplace_back(std::move(algo_impl));
     }
 
@@ -51,33 +68,76 @@ bool WeldGloveAlgo::load_models(const std::vector<ModelConfig> &models) {
 }
 
 bool WeldGloveAlgo::sync_infer(const int64_t image_id, const cv::Mat &image,
-                                 std::vector<AlgoObject> &statistic_objects) {
+                               std::vector<AlgoObject> &statistic_objects) {
+    return sync_infer(0, image_id, image, statistic_objects);
+}
+
+bool WeldGloveAlgo::sync_infer(const int32_t stream_id, const int64_t image_id, const cv::Mat &image,
+                               std::vector<AlgoObject> &statistic_objects) {
+    auto stream = private_->streams.get(stream_id);
+    if (!stream) {
+        printf("Invalid stream id: %d", stream_id);
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(stream->mutex);
+    if (stream->motion_gate) {
+        if (stream->motion_gate->still(image)) {
+            // 画面静止, 不推理, 上一次推理的时序统计输入再统计一次
+            if (auto last = stream->motion_gate->last()) {
+                statistic_objects = stream->sequence_statistic->update(*last);
+            }
+            return true;
+        }
+        stream->motion_gate->drop();
+    }
+    auto arena = stream->arena.begin_frame();
+
+    StageTimer timer(stream->metrics, image_id);
     gddeploy::BufSurfWrapperPtr surface;
-    convertMat2BufSurface(const_cast<cv::Mat &>(image), surface);
+    convert_mat_to_surface(*private_->model_impls[0], const_cast<cv::Mat &>(image), surface);
+    timer.lap(AlgoStage::kPreprocess);
 
     auto in_package = gddeploy::Package::Create(1);
     in_package->data[0]->Set(surface);
 
+    // 门控通过率高时一、二阶段同时提交, 一阶段没有目标时丢弃二阶段结果
+    auto speculative = stream->speculation && stream->speculation->speculate();
     auto out_package = gddeploy::Package::Create(1);
-    if (private_->model_impls[0]->InferSync(in_package, out_package) != 0) { return false; }
+    auto out_package2 = gddeploy::Package::Create(1);
+    if (speculative) {
+        auto in_package2 = gddeploy::Package::Create(1);
+        in_package2->data[0]->Set(surface);
+        if (infer_concurrent(*private_->model_impls[0], in_package, out_package, *private_->model_impls[1], in_package2,
+                             out_package2, timer)
+            != 0) {
+            return false;
+        }
+    } else {
+        if (private_->model_impls[0]->InferSync(in_package, out_package) != 0) { return false; }
+        timer.lap(AlgoStage::kInferStage1);
+    }
 
-    std::vector<AlgoObject> infer_objects;
+    FrameObjects infer_objects(arena);
     if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
         infer_objects = filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                            private_->model_configs[0].labels, private_->model_configs[0].threshold);
+                                            private_->model_configs[0].labels, private_->model_configs[0].threshold,
+                                            arena);
     }
+    if (stream->speculation) { stream->speculation->record(!infer_objects.empty()); }
 
     // 二阶段检测
     if (!infer_objects.empty()) {
-        auto in_package = gddeploy::Package::Create(1);
-        in_package->data[0]->Set(surface);
-
-        auto out_package = gddeploy::Package::Create(1);
-        private_->model_impls[1]->InferSync(in_package, out_package);
+        auto out_package = out_package2;
+        if (!speculative) {
+            auto in_package = gddeploy::Package::Create(1);
+            in_package->data[0]->Set(surface);
+            private_->model_impls[1]->InferSync(in_package, out_package);
+            timer.lap(AlgoStage::kInferStage2);
+        }
         if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
             infer_objects =
                 filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                    private_->model_configs[1].labels, private_->model_configs[1].threshold);
+                                    private_->model_configs[1].labels, private_->model_configs[1].threshold, arena);
         }
 
         // 生成目标跟踪ID
@@ -91,13 +151,18 @@ bool WeldGloveAlgo::sync_infer(const int64_t image_id, const cv::Mat &image,
             objects.push_back(temp);
         }
 
-        std::vector<AlgoObject> tracked_objects;
-        for (auto &item : private_->tracker->update(objects)) {
+        FrameObjects tracked_objects(arena);
+        for (auto &item : stream->tracker->update(objects)) {
             tracked_objects.emplace_back(AlgoObject{
                 item.target_id, item.class_id, item.label_name, item.score,
                 cv::Rect{(int)item.tlwh[0], (int)item.tlwh[1], (int)item.tlwh[2], (int)item.tlwh[3]}, item.track_id});
         }
 
+        // 检测区域外的目标不再裁剪推理和告警
+        if (stream->region) { stream->region->filter(tracked_objects); }
+
+        timer.lap(AlgoStage::kTrack);
+
         if (!tracked_objects.empty()) {
             // 裁剪目标 & 排序
             std::sort(tracked_objects.begin(), tracked_objects.end(),
@@ -111,38 +176,43 @@ bool WeldGloveAlgo::sync_infer(const int64_t image_id, const cv::Mat &image,
                 tracked_objects.resize(private_->model_configs[2].max_crop_number);
             }
 
-            std::vector<AlgoObject> match_objects;
+            FrameObjects match_objects(arena);
             for (const auto &tracked_object : tracked_objects) {
                 auto crop_rect = scale_crop_rect(image.cols, image.rows, tracked_object.rect,
                                                  private_->model_configs[2].crop_scale_factor);
                 auto crop_image = image(crop_rect).clone();
 
                 gddeploy::BufSurfWrapperPtr crop_surface;
-                convertMat2BufSurface(crop_image, crop_surface);
+                convert_mat_to_surface(*private_->model_impls[2], crop_image, crop_surface);
+                timer.lap(AlgoStage::kCrop);
                 in_package = gddeploy::Package::Create(1);
                 out_package = gddeploy::Package::Create(1);
                 in_package->data[0]->Set(crop_surface);
                 private_->model_impls[2]->InferSync(in_package, out_package);
+                timer.lap(AlgoStage::kInferStage3);
 
-                std::vector<AlgoObject> mask_objects;
+                FrameObjects mask_objects(arena);
                 if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
                     mask_objects =
-                        parse_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),private_->model_configs[2].threshold);
+                        parse_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
+                                           private_->model_configs[2].threshold, arena);
                 }
 
                 if (mask_objects.empty()) { match_objects.emplace_back(tracked_object); }
             }
 
-            statistic_objects = private_->sequence_statistic->update(match_objects);
+            if (stream->motion_gate) { stream->motion_gate->keep(match_objects); }
+            statistic_objects = stream->sequence_statistic->update(match_objects);
+            timer.lap(AlgoStage::kStatistic);
         }
     }
 
     return true;
 }
 
-std::vector<AlgoObject> WeldGloveAlgo::parse_infer_result(const gddeploy::InferResult &infer_result,
-                                                      const float threshold) {
-    std::vector<AlgoObject> objects;
+FrameObjects WeldGloveAlgo::parse_infer_result(const gddeploy::InferResult &infer_result, const float threshold,
+                                               std::pmr::memory_resource *resource) {
+    FrameObjects objects(resource);
 
     for (auto result_type : infer_result.result_type) {
         if (result_type == gddeploy::GDD_RESULT_TYPE_DETECT) {
@@ -162,10 +232,10 @@ std::vector<AlgoObject> WeldGloveAlgo::parse_infer_result(const gddeploy::InferR
     return objects;
 }
 
-std::vector<AlgoObject> WeldGloveAlgo::filter_infer_result(const gddeploy::InferResult &infer_result,
-                                                             const std::set<std::string> &labels,
-                                                             const float threshold) {
-    std::vector<AlgoObject> objects;
+FrameObjects WeldGloveAlgo::filter_infer_result(const gddeploy::InferResult &infer_result,
+                                                const std::set<std::string> &labels, const float threshold,
+                                                std::pmr::memory_resource *resource) {
+    FrameObjects objects(resource);
 
     for (auto result_type : infer_result.result_type) {
         if (result_type == gddeploy::GDD_RESULT_TYPE_DETECT) {
@@ -0,0 +1,142 @@
+#include "worker_pool.h"
+#include "postprocess_pool.h"
+#include "spdlog/spdlog.h"
+#include <atomic>
+#include <deque>
+#include <pthread.h>
+#include <string>
+#include <thread>
+
+namespace gddi {
+
+namespace {
+
+uint32_t default_threads() {
+    auto cores = std::thread::hardware_concurrency();
+    return std::min(4U, std::max(1U, cores / 2));
+}
+
+std::atomic<uint64_t> g_next_affinity{0};
+
+}// namespace
+
+class WorkerPool::Worker {
+public:
+    explicit Worker(const uint32_t index) : thread_([this, index]() { run(index); }) {}
+
+    ~Worker() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cond_.notify_one();
+        thread_.join();
+    }
+
+    void push(Task task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.emplace_back(std::move(task));
+        }
+        cond_.notify_one();
+    }
+
+private:
+    void run(const uint32_t index) {
+        auto name = "gddi-post-" + std::to_string(index);
+        pthread_setname_np(pthread_self(), name.c_str());
+
+        while (true) {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cond_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+                // 退出前先执行完剩余任务
+                if (tasks_.empty()) { return; }
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::deque<Task> tasks_;
+    bool stop_{false};
+    std::thread thread_;
+};
+
+WorkerPool &WorkerPool::instance() {
+    static WorkerPool pool(default_threads());
+    return pool;
+}
+
+WorkerPool::WorkerPool(const uint32_t num_threads) {
+    for (uint32_t i = 0; i < num_threads; i++) { workers_.emplace_back(std::make_unique<Worker>(i)); }
+}
+
+WorkerPool::~WorkerPool() {
+    // 进程退出时 spdlog 可能已析构, 这里不打日志
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    workers_.clear();
+}
+
+void WorkerPool::resize(const uint32_t num_threads) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (workers_.size() == num_threads) { return; }
+
+    // Worker 析构时执行完队列中的任务再退出, 保证同一 affinity 的任务顺序
+    workers_.clear();
+    for (uint32_t i = 0; i < num_threads; i++) { workers_.emplace_back(std::make_unique<Worker>(i)); }
+    spdlog::info("Postprocess threads: {}", num_threads);
+}
+
+uint32_t WorkerPool::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return workers_.size();
+}
+
+bool WorkerPool::post(const uint64_t affinity, Task task) {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (workers_.empty()) { return false; }
+
+    workers_[affinity % workers_.size()]->push(std::move(task));
+    return true;
+}
+
+PostprocessQueue::PostprocessQueue() : affinity_(g_next_affinity.fetch_add(1, std::memory_order_relaxed)) {}
+
+PostprocessQueue::~PostprocessQueue() { wait_idle(); }
+
+void PostprocessQueue::post(WorkerPool::Task task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_++;
+    }
+
+    auto run = [this, task = std::move(task)]() {
+        try {
+            task();
+        } catch (const std::exception &e) { spdlog::error("Postprocess task failed: {}", e.what()); }
+        finish();
+    };
+
+    if (!WorkerPool::instance().post(affinity_, run)) { run(); }
+}
+
+void PostprocessQueue::wait_idle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this]() { return pending_ == 0; });
+}
+
+void PostprocessQueue::finish() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--pending_ == 0) { idle_.notify_all(); }
+}
+
+void set_postprocess_threads(const uint32_t num_threads) { WorkerPool::instance().resize(num_threads); }
+
+uint32_t get_postprocess_threads() { return WorkerPool::instance().size(); }
+
+}// namespace gddi
@@ -0,0 +1,104 @@
+/**
+ * @file worker_pool.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 后处理线程池 (按流亲和派发)
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 by GDDI
+ *
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+namespace gddi {
+
+/**
+ * @brief 进程内共享的后处理线程池, 每个线程独立任务队列
+ *
+ * 相同 affinity 的任务总是落在同一线程按提交顺序执行
+ */
+class WorkerPool {
+public:
+    using Task = std::function<void()>;
+
+    static WorkerPool &instance();
+
+    ~WorkerPool();
+
+    /**
+     * @brief 调整线程数, 先等待所有已派发任务执行完
+     *
+     * 不能在线程池内的任务中调用
+     */
+    void resize(const uint32_t num_threads);
+
+    uint32_t size() const;
+
+    /**
+     * @brief 派发任务
+     *
+     * @return false 线程数为 0, 任务未派发, 由调用方自行执行
+     */
+    bool post(const uint64_t affinity, Task task);
+
+private:
+    class Worker;
+
+    explicit WorkerPool(const uint32_t num_threads);
+
+    mutable std::shared_mutex mutex_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+};
+
+/**
+ * @brief 单个算法实例 (单路视频流) 的后处理队列
+ *
+ * 同一队列的任务串行执行, 跟踪器/时序统计无需加锁; 析构前必须 wait_idle
+ */
+class PostprocessQueue {
+public:
+    PostprocessQueue();
+    ~PostprocessQueue();
+
+    PostprocessQueue(const PostprocessQueue &) = delete;
+    PostprocessQueue &operator=(const PostprocessQueue &) = delete;
+
+    void post(WorkerPool::Task task);
+
+    /**
+     * @brief 等待本队列已派发的任务全部执行完
+     *
+     */
+    void wait_idle();
+
+    /**
+     * @brief 包装推理回调, 回调线程只负责派发, 回调体在后处理线程执行
+     *
+     */
+    template <typename Callback>
+    auto wrap(Callback callback) {
+        return [this, callback = std::move(callback)](auto... args) {
+            post([callback, args...]() mutable { callback(args...); });
+        };
+    }
+
+private:
+    void finish();
+
+    uint64_t affinity_;
+
+    std::mutex mutex_;
+    std::condition_variable idle_;
+    uint32_t pending_{0};
+};
+
+}// namespace gddi